@@ -20,6 +20,11 @@
 # include <roboptim/core/sys.hh>
 # include <roboptim/core/portability.hh>
 
+# include <algorithm>
+# include <string>
+# include <utility>
+# include <vector>
+
 # include <boost/mpl/vector.hpp>
 # include <boost/optional.hpp>
 
@@ -44,6 +49,92 @@ namespace roboptim
   /// \addtogroup roboptim_problem
   /// @{
 
+  /// \brief Statistics of the per-iterate evaluation cache.
+  ///
+  /// Ipopt may request the same quantity several times for a given
+  /// iterate. These counters record how many requests were served
+  /// from the cache (hits) and how many required an evaluation of the
+  /// RobOptim functions (misses).
+  struct IpoptCacheStatistics
+  {
+    /// \brief Quantities stored in the cache.
+    enum Quantity
+      {
+	/// \brief Cost function value.
+	COST = 0,
+	/// \brief Cost function gradient.
+	COST_GRADIENT,
+	/// \brief Constraints values.
+	CONSTRAINTS,
+	/// \brief Constraints Jacobian.
+	CONSTRAINTS_JACOBIAN,
+	/// \brief Objective and constraint Hessians (twice
+	/// differentiable problems only).
+	HESSIANS,
+	/// \brief Number of cached quantities.
+	NB_QUANTITIES
+      };
+
+    IpoptCacheStatistics ()
+    {
+      reset ();
+    }
+
+    /// \brief Reset all the counters to zero.
+    void reset ()
+    {
+      std::fill (hits, hits + NB_QUANTITIES, 0ul);
+      std::fill (misses, misses + NB_QUANTITIES, 0ul);
+    }
+
+    /// \brief Total number of cache hits.
+    unsigned long totalHits () const
+    {
+      unsigned long total = 0;
+      for (int i = 0; i < NB_QUANTITIES; ++i)
+	total += hits[i];
+      return total;
+    }
+
+    /// \brief Total number of cache misses.
+    unsigned long totalMisses () const
+    {
+      unsigned long total = 0;
+      for (int i = 0; i < NB_QUANTITIES; ++i)
+	total += misses[i];
+      return total;
+    }
+
+    /// \brief Number of requests served from the cache.
+    unsigned long hits[NB_QUANTITIES];
+
+    /// \brief Number of requests which required an evaluation.
+    unsigned long misses[NB_QUANTITIES];
+  };
+
+  /// \brief Primal-dual iterate of Ipopt.
+  ///
+  /// Multipliers follow the Ipopt conventions: constraints multipliers
+  /// are the ones of Result::lambda, bound multipliers are
+  /// non-negative.
+  struct IpoptIterate
+  {
+    /// \brief Vector type.
+    typedef Function::vector_t vector_t;
+
+    /// \brief Optimization parameters.
+    vector_t x;
+
+    /// \brief Constraints multipliers.
+    vector_t lambda;
+
+    /// \brief Lower bound multipliers (may be empty).
+    vector_t zL;
+
+    /// \brief Upper bound multipliers (may be empty).
+    vector_t zU;
+  };
+
   template <typename T>
   class IpoptSolverCommon;
 
@@ -73,8 +164,20 @@ namespace roboptim
     /// \brief Parent type.
     typedef T parent_t;
 
+    /// \brief Sparsity pattern type.
+    ///
+    /// Structural nonzeros are the entries stored in the matrix,
+    /// whatever their value.
+    typedef Eigen::SparseMatrix<double, Eigen::ColMajor> sparsityPattern_t;
+
     typedef typename T::callback_t callback_t;
     typedef typename T::problem_t problem_t;
+    typedef typename problem_t::vector_t vector_t;
+    typedef typename problem_t::intervals_t intervals_t;
+    typedef typename problem_t::intervalsVect_t intervalsVect_t;
+    typedef typename problem_t::scales_t scales_t;
+    typedef typename problem_t::scalesVect_t scalesVect_t;
+    typedef typename problem_t::startingPoint_t startingPoint_t;
 
     /// \brief Instantiate the solver from a problem.
     ///
@@ -88,6 +191,20 @@ namespace roboptim
     /// \brief Solve the problem.
     void solve ();
 
+    /// \brief Solve the problem again, reusing the previous solve.
+    ///
+    /// The Ipopt application is re-optimized without being initialized
+    /// again, with Ipopt warm_start_same_structure option, so the
+    /// problem analysis (sparsity structures, evaluation buffers,
+    /// threads) is kept, and Ipopt options are only forwarded again if
+    /// a parameter changed. Only bounds, scaling, starting point, warm
+    /// start and functions values may change between solves. Falls
+    /// back to solve () if there is no previous solve to reuse, or if
+    /// a bounds update changed the kind of a bound (equality or fixed
+    /// variable, finite or infinite sides), which changes the problem
+    /// structure seen by Ipopt.
+    void resolve ();
+
     /// \brief Get Ipopt Application object for Ipopt specific tuning.
     ///
     /// Consult Ipopt documentation for information regarding
@@ -104,6 +221,263 @@ namespace roboptim
     {
       return callback_;
     }
+
+    /// \brief Statistics of the evaluation cache for the last solve.
+    const IpoptCacheStatistics& cacheStatistics () const
+    {
+      return cacheStatistics_;
+    }
+
+    /// \brief Declare the sparsity pattern of the Lagrangian Hessian.
+    ///
+    /// The Hessian being symmetric, entries of the upper triangle are
+    /// mirrored in the lower triangle. If no pattern is declared, it is
+    /// detected from the functions Hessians at sample points when the
+    /// problem is given to Ipopt. The pattern is then frozen for the
+    /// solve: a nonzero value outside of it makes the solve fail with
+    /// a SolverError (except with finite differences Hessians, which
+    /// are only computed on the pattern).
+    ///
+    /// \param pattern n x n matrix whose stored entries are the
+    /// Hessian structural nonzeros. A pattern of another size makes
+    /// the solve fail with a SolverError.
+    void setHessianSparsityPattern (const sparsityPattern_t& pattern)
+    {
+      hessianSparsityPattern_ = pattern;
+    }
+
+    /// \brief Forget the declared Hessian sparsity pattern.
+    void resetHessianSparsityPattern ()
+    {
+      hessianSparsityPattern_.reset ();
+    }
+
+    /// \brief Declared Hessian sparsity pattern, if any.
+    const boost::optional<sparsityPattern_t>&
+    hessianSparsityPattern () const
+    {
+      return hessianSparsityPattern_;
+    }
+
+    /// \brief Declare the sparsity pattern of the constraints Jacobian.
+    ///
+    /// Only used by sparse solvers. If no pattern is declared, it is
+    /// detected from the constraints Jacobians at sample points when
+    /// the problem is given to Ipopt. The pattern is then frozen for
+    /// the solve: a nonzero value outside of it makes the solve fail
+    /// with a SolverError.
+    ///
+    /// \param pattern m x n matrix (m being the total output size of
+    /// the constraints) whose stored entries are the Jacobian
+    /// structural nonzeros. A pattern of another size makes the solve
+    /// fail with a SolverError.
+    void setJacobianSparsityPattern (const sparsityPattern_t& pattern)
+    {
+      jacobianSparsityPattern_ = pattern;
+    }
+
+    /// \brief Forget the declared Jacobian sparsity pattern.
+    void resetJacobianSparsityPattern ()
+    {
+      jacobianSparsityPattern_.reset ();
+    }
+
+    /// \brief Declared Jacobian sparsity pattern, if any.
+    const boost::optional<sparsityPattern_t>&
+    jacobianSparsityPattern () const
+    {
+      return jacobianSparsityPattern_;
+    }
+
+    /// \brief Warm start the next solves from a primal-dual iterate.
+    ///
+    /// The iterate replaces the problem starting point, and Ipopt
+    /// warm_start_init_point option is enabled, with small bound
+    /// pushes, unless these options are set explicitly. The iterate
+    /// sizes are checked when solving: x and lambda must match the
+    /// problem, empty bound multipliers are replaced by ones.
+    ///
+    /// \param iterate primal-dual iterate, e.g. finalIterate () of a
+    /// previous solve.
+    void setWarmStart (const IpoptIterate& iterate)
+    {
+      warmStart_ = iterate;
+    }
+
+    /// \brief Warm start the next solves from a previous result.
+    ///
+    /// The bound multipliers, which are not part of results, are taken
+    /// from the final iterate of the last solve when their size
+    /// matches.
+    ///
+    /// \param result result of a previous solve.
+    void setWarmStart (const Result& result)
+    {
+      IpoptIterate iterate;
+      iterate.x = result.x;
+      iterate.lambda = result.lambda;
+      if (finalIterate_.zL.size () == result.x.size ())
+	{
+	  iterate.zL = finalIterate_.zL;
+	  iterate.zU = finalIterate_.zU;
+	}
+      warmStart_ = iterate;
+    }
+
+    /// \brief Go back to cold starts from the problem starting point.
+    void resetWarmStart ()
+    {
+      warmStart_.reset ();
+    }
+
+    /// \brief Warm start iterate, if any.
+    const boost::optional<IpoptIterate>& warmStart () const
+    {
+      return warmStart_;
+    }
+
+    /// \brief Iterate the next solve starts from, if any.
+    ///
+    /// This is the warm start iterate, or during a solve, the
+    /// checkpoint to resume from or the closest iterate of the warm
+    /// start store (see the ipopt.plugin.checkpoint_resume and
+    /// ipopt.plugin.warm_start_store parameters).
+    const boost::optional<IpoptIterate>& startingIterate () const
+    {
+      return warmStart_ ? warmStart_ : storedIterate_;
+    }
+
+    /// \brief Final primal-dual iterate of the last solve.
+    ///
+    /// Empty if no solve reached its end.
+    const IpoptIterate& finalIterate () const
+    {
+      return finalIterate_;
+    }
+
+    /// \brief Update the arguments bounds.
+    ///
+    /// Bounds, scaling and starting point are copied from the problem
+    /// when the solver is built. They may then be updated between
+    /// solves without rebuilding the solver: the problem analysis is
+    /// kept, in particular by resolve (), unless the kind of a bound
+    /// changes. Sizes must not change, otherwise a std::runtime_error
+    /// is thrown.
+    ///
+    /// \param bounds one interval per argument.
+    void setArgumentBounds (const intervals_t& bounds);
+
+    /// \brief Update the bounds of a constraint.
+    ///
+    /// \param constraint constraint index in the problem.
+    /// \param bounds one interval per constraint output.
+    void setConstraintBounds (std::size_t constraint,
+			      const intervals_t& bounds);
+
+    /// \brief Update the arguments scaling.
+    ///
+    /// \param scaling one factor per argument.
+    void setArgumentScaling (const scales_t& scaling);
+
+    /// \brief Update the scaling of a constraint.
+    ///
+    /// \param constraint constraint index in the problem.
+    /// \param scaling one factor per constraint output.
+    void setConstraintScaling (std::size_t constraint,
+			       const scales_t& scaling);
+
+    /// \brief Update the starting point.
+    ///
+    /// \param x starting point.
+    void setStartingPoint (const vector_t& x);
+
+    /// \brief Go back to the problem bounds, scaling and starting
+    /// point.
+    void resetProblemUpdates ();
+
+    /// \brief Arguments bounds used by the solver.
+    const intervals_t& argumentBounds () const
+    {
+      return argumentBounds_;
+    }
+
+    /// \brief Constraints bounds used by the solver.
+    const intervalsVect_t& boundsVector () const
+    {
+      return boundsVector_;
+    }
+
+    /// \brief Arguments scaling used by the solver.
+    const scales_t& argumentScaling () const
+    {
+      return argumentScaling_;
+    }
+
+    /// \brief Constraints scaling used by the solver.
+    const scalesVect_t& scalingVector () const
+    {
+      return scalingVector_;
+    }
+
+    /// \brief Starting point used by the solver.
+    const startingPoint_t& startingPoint () const
+    {
+      return startingPoint_;
+    }
+
+  protected:
+    /// \brief Fingerprint of the problem structure.
+    ///
+    /// Computed from the solver type, the functions names and sizes,
+    /// and the constraints types. Also identifies the structure cache
+    /// files.
+    std::size_t problemFingerprint () const;
+
+    /// \brief Evaluation cache statistics (filled by the Tnlp).
+    IpoptCacheStatistics cacheStatistics_;
+
+    /// \brief User-declared Lagrangian Hessian sparsity pattern.
+    boost::optional<sparsityPattern_t> hessianSparsityPattern_;
+
+    /// \brief User-declared constraints Jacobian sparsity pattern.
+    boost::optional<sparsityPattern_t> jacobianSparsityPattern_;
+
+    /// \brief Warm start iterate.
+    boost::optional<IpoptIterate> warmStart_;
+
+    /// \brief Iterate found in the checkpoint or the warm start store.
+    boost::optional<IpoptIterate> storedIterate_;
+
+    /// \brief Barrier parameter of the checkpoint to resume from.
+    boost::optional<double> storedMu_;
+
+    /// \brief Final iterate of the last solve (filled by the Tnlp).
+    IpoptIterate finalIterate_;
+
+    /// \brief Number of optimizations started (read by the Tnlp, which
+    /// resets its per-solve state once per optimization).
+    std::size_t optimizations_;
+
+    /// \brief Whether the last optimization found nonzeros outside of
+    /// the detected sparsity structures (set by the Tnlp, which
+    /// extends them).
+    bool structureExtended_;
+
+    /// \brief Arguments bounds.
+    intervals_t argumentBounds_;
+
+    /// \brief Constraints bounds.
+    intervalsVect_t boundsVector_;
+
+    /// \brief Arguments scaling.
+    scales_t argumentScaling_;
+
+    /// \brief Constraints scaling.
+    scalesVect_t scalingVector_;
+
+    /// \brief Starting point.
+    startingPoint_t startingPoint_;
+
   private:
     /// \brief Initialize parameters.
     ///
@@ -115,6 +489,93 @@ namespace roboptim
     /// Called before solving problem.
     void updateParameters ();
 
+    /// \brief Whether parameters changed since they were last
+    /// forwarded to Ipopt.
+    bool parametersChanged () const;
+
+    /// \brief Whether plug-in parameters read while analyzing the
+    /// problem changed since the last solve.
+    ///
+    /// Re-optimizations do not analyze the problem again.
+    bool structureParametersChanged () const;
+
+    /// \brief Run Ipopt and translate its return status.
+    ///
+    /// \param status status of the application initialization.
+    /// \param reoptimize whether to re-optimize the previous problem.
+    void optimize (int status, bool reoptimize);
+
+    /// \brief Optimize or re-optimize the problem.
+    ///
+    /// Records whether the application can re-optimize afterwards.
+    /// Optimizations which found nonzeros outside of the detected
+    /// sparsity structures are started again with the extended
+    /// structures.
+    int optimizeTNLP (bool reoptimize);
+
+    /// \brief Tell Ipopt which derivatives are constant.
+    ///
+    /// Equality (resp. inequality) constraints Jacobians are constant
+    /// if they only involve linear constraints. The Lagrangian Hessian
+    /// is constant if, in addition, the cost is quadratic. Only
+    /// constant derivatives are flagged, for the current solve: options
+    /// set explicitly by the user are left untouched, and the others
+    /// are restored by restoreOptions after the solve.
+    void updateLinearityOptions ();
+
+    /// \brief Hash of the parameters forwarded to Ipopt.
+    std::size_t parametersHash () const;
+
+    /// \brief Signature of the problem data: bounds and starting
+    /// point.
+    void problemSignature (vector_t& signature) const;
+
+    /// \brief Directory of the warm start store (empty if disabled).
+    std::string warmStartStore () const;
+
+    /// \brief Total output size of the constraints.
+    std::size_t constraintsOutputSize () const;
+
+    /// \brief Look up the checkpoint to resume from, or the warm start
+    /// store for the closest iterate.
+    ///
+    /// Only used when no warm start iterate is set.
+    void loadStoredIterate ();
+
+    /// \brief Read the checkpoint file, if resuming is enabled.
+    ///
+    /// \return whether a valid checkpoint was found.
+    bool loadCheckpoint ();
+
+    /// \brief Save the final iterate of a successful solve in the warm
+    /// start store.
+    void saveStoredIterate ();
+
+    /// \brief Enable Ipopt warm start options when the solve starts
+    /// from an iterate.
+    ///
+    /// Options set explicitly by the user are left untouched, and the
+    /// others are restored by restoreOptions after the solve.
+    void updateWarmStartOptions ();
+
+    /// \brief Set an Ipopt option for the current solve only.
+    ///
+    /// Nothing is done if the option is set explicitly by the user.
+    /// Otherwise, its current value is saved for restoreOptions.
+    ///
+    /// \param name Ipopt option name
+    /// \param value value for the current solve
+    void overrideOption (const std::string& name, const std::string& value);
+
+    /// \brief Set a numeric Ipopt option for the current solve only.
+    ///
+    /// \param name Ipopt option name
+    /// \param value value for the current solve
+    void overrideOption (const std::string& name, double value);
+
+    /// \brief Restore the options overridden for the last solve.
+    void restoreOptions ();
+
     /// \brief Smart pointer to the Ipopt non linear problem description.
     Ipopt::SmartPtr<Ipopt::TNLP> nlp_;
     /// \brief Smart pointer to the Ipopt application instance.
@@ -123,6 +584,25 @@ namespace roboptim
     /// \brief Intermediate callback (called at each end
     /// of iteration).
     callback_t callback_;
+
+    /// \brief Parameters last forwarded to Ipopt.
+    typename parent_t::parameters_t appliedParameters_;
+
+    /// \brief Ipopt string options overridden for the current solve,
+    /// with their previous values.
+    std::vector<std::pair<std::string, std::string> >
+    overriddenStringOptions_;
+
+    /// \brief Ipopt numeric options overridden for the current solve,
+    /// with their previous values.
+    std::vector<std::pair<std::string, double> > overriddenNumericOptions_;
+
+    /// \brief Whether the application can re-optimize the problem.
+    bool optimized_;
+
+    /// \brief Whether bounds updates changed the kind of a bound since
+    /// the last optimization.
+    bool boundKindsChanged_;
   };
 
   /// @}
@@ -0,0 +1,99 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_SPARSE_TD_HH
+# define ROBOPTIM_CORE_IPOPT_SPARSE_TD_HH
+# include <roboptim/core/sys.hh>
+# include <roboptim/core/portability.hh>
+
+# include <boost/mpl/vector.hpp>
+
+# include <coin/IpSmartPtr.hpp>
+# include <coin/IpReturnCodes.hpp> // for AlgorithmMode
+
+# include <roboptim/core/fwd.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/linear-function.hh>
+# include <roboptim/core/twice-differentiable-function.hh>
+# include <roboptim/core/plugin/ipopt/ipopt-common.hh>
+
+/// \brief Ipopt classes.
+namespace Ipopt
+{
+  class IpoptApplication;
+  class IpoptData;
+  class IpoptCalculatedQuantities;
+} // end of namespace Ipopt
+
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    template <typename T>
+    class Tnlp;
+  }
+
+  /// \addtogroup roboptim_problem
+  /// @{
+
+  /// \brief Ipopt based solver using exact sparse Hessians.
+  ///
+  /// Instantiate this solver to solve sparse problems with Ipopt,
+  /// using the Hessians of the functions instead of a limited-memory
+  /// approximation.
+  ///
+  /// The Lagrangian Hessian sparsity pattern is detected from the
+  /// functions Hessians, unless declared with
+  /// setHessianSparsityPattern.
+  class ROBOPTIM_DLLEXPORT IpoptSolverSparseTd
+    : public IpoptSolverCommon<
+    Solver<TwiceDifferentiableSparseFunction,
+	   boost::mpl::vector<LinearSparseFunction,
+			      TwiceDifferentiableSparseFunction> > >
+  {
+  public:
+    /// \brief RobOptim solver type.
+    typedef Solver<
+      TwiceDifferentiableSparseFunction,
+      boost::mpl::vector<LinearSparseFunction,
+			 TwiceDifferentiableSparseFunction> > solver_t;
+
+    /// \brief Parent type.
+    typedef IpoptSolverCommon<solver_t> parent_t;
+
+    /// \brief Common function type.
+    ///
+    /// Fuction type which can contain any kind of constraint.
+    typedef TwiceDifferentiableSparseFunction commonConstraintFunction_t;
+
+    /// \brief Instantiate the solver from a problem.
+    ///
+    /// \param problem problem that will be solved
+    explicit IpoptSolverSparseTd (const problem_t& problem);
+
+    virtual ~IpoptSolverSparseTd () {}
+
+    template <typename T>
+      friend class ::roboptim::detail::Tnlp;
+  };
+
+  /// @}
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_IPOPT_SPARSE_TD_HH
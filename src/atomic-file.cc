@@ -0,0 +1,103 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <vector>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "atomic-file.hh"
+
+namespace roboptim
+{
+  namespace detail
+  {
+    namespace
+    {
+      /// \brief Create a new temporary file next to the final one.
+      ///
+      /// The file is created by mkstemp, so that its name is unique
+      /// among all the threads and processes writing the same final
+      /// file.
+      ///
+      /// \return temporary file name, empty if it could not be created.
+      std::string
+      temporaryPath (const std::string& path)
+      {
+	std::string pattern = path + ".XXXXXX";
+	std::vector<char> name (pattern.begin (), pattern.end ());
+	name.push_back ('\0');
+
+	int fd = mkstemp (&name[0]);
+	if (fd < 0)
+	  return std::string ();
+
+	// mkstemp creates the file for its owner only, give the final
+	// file the usual permissions.
+	fchmod (fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	close (fd);
+	return std::string (&name[0]);
+      }
+    } // end of anonymous namespace.
+
+    AtomicFile::AtomicFile (const std::string& path)
+      : path_ (path),
+	temporary_ (temporaryPath (path)),
+	out_ (),
+	committed_ (false)
+    {
+      if (!temporary_.empty ())
+	out_.open (temporary_.c_str (),
+		   std::ios::out | std::ios::binary | std::ios::trunc);
+      else
+	out_.setstate (std::ios::failbit);
+    }
+
+    AtomicFile::~AtomicFile ()
+    {
+      if (committed_)
+	return;
+
+      if (out_.is_open ())
+	out_.close ();
+      if (!temporary_.empty ())
+	std::remove (temporary_.c_str ());
+    }
+
+    std::ostream&
+    AtomicFile::stream ()
+    {
+      return out_;
+    }
+
+    bool
+    AtomicFile::commit ()
+    {
+      if (temporary_.empty ())
+	return false;
+
+      out_.close ();
+      if (!out_ || std::rename (temporary_.c_str (), path_.c_str ()) != 0)
+	return false;
+
+      committed_ = true;
+      return true;
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
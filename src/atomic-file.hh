@@ -0,0 +1,75 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_ATOMIC_FILE_HH
+# define ROBOPTIM_CORE_IPOPT_ATOMIC_FILE_HH
+
+# include <fstream>
+# include <string>
+
+# include <boost/noncopyable.hpp>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    /// \brief File written under a temporary name, then renamed.
+    ///
+    /// Concurrent processes reading or mapping the file never see a
+    /// partial file. The temporary file is removed if the file is not
+    /// committed.
+    class AtomicFile : private boost::noncopyable
+    {
+    public:
+      /// \brief Open a temporary file next to the final one.
+      ///
+      /// \param path final file.
+      explicit AtomicFile (const std::string& path);
+
+      /// \brief Remove the temporary file, unless committed.
+      ~AtomicFile ();
+
+      /// \brief Binary stream of the temporary file.
+      ///
+      /// It evaluates to false if the file could not be opened.
+      std::ostream& stream ();
+
+      /// \brief Close the temporary file and rename it to the final
+      /// one.
+      ///
+      /// \return whether the file could be written.
+      bool commit ();
+
+    private:
+      /// \brief Final file.
+      std::string path_;
+
+      /// \brief Temporary file, unique to this writer (empty if it
+      /// could not be created).
+      std::string temporary_;
+
+      /// \brief Stream of the temporary file.
+      std::ofstream out_;
+
+      /// \brief Whether the temporary file has been renamed.
+      bool committed_;
+    };
+  } // end of namespace detail.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_ATOMIC_FILE_HH
@@ -0,0 +1,149 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "atomic-file.hh"
+#include "checkpoint.hh"
+
+namespace roboptim
+{
+  namespace detail
+  {
+    namespace
+    {
+      /// \brief Checkpoint file header.
+      ///
+      /// Followed by x, lambda, zL and zU.
+      struct Header
+      {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t reserved;
+	boost::uint64_t fingerprint;
+	boost::uint64_t inputSize;
+	boost::uint64_t constraintsSize;
+	boost::int64_t iteration;
+	double mu;
+      };
+
+      const char magic[8] = {'R', 'O', 'B', 'O', 'I', 'P', 'C', 'K'};
+
+      const boost::uint32_t version = 1;
+
+      typedef Checkpoint::vector_t vector_t;
+
+      void
+      write (std::ostream& out, const vector_t& data)
+      {
+	out.write (reinterpret_cast<const char*> (data.data ()),
+		   static_cast<std::streamsize>
+		   (static_cast<std::size_t> (data.size ()) * sizeof (double)));
+      }
+
+      void
+      read (std::istream& in, vector_t& data)
+      {
+	in.read (reinterpret_cast<char*> (data.data ()),
+		 static_cast<std::streamsize>
+		 (static_cast<std::size_t> (data.size ()) * sizeof (double)));
+      }
+    } // end of anonymous namespace.
+
+    Checkpoint::Checkpoint ()
+      : iteration (0),
+	mu (0.),
+	x (),
+	lambda (),
+	zL (),
+	zU ()
+    {
+    }
+
+    bool
+    Checkpoint::load (const std::string& path, fingerprint_t fingerprint,
+		      Checkpoint& checkpoint)
+    {
+      std::ifstream in (path.c_str (), std::ios::in | std::ios::binary);
+      if (!in)
+	return false;
+
+      Header header;
+      in.read (reinterpret_cast<char*> (&header), sizeof (Header));
+      if (!in
+	  || std::memcmp (header.magic, magic, sizeof (magic)) != 0
+	  || header.version != version
+	  || header.fingerprint != fingerprint
+	  || header.inputSize
+	  != static_cast<boost::uint64_t> (checkpoint.x.size ())
+	  || header.constraintsSize
+	  != static_cast<boost::uint64_t> (checkpoint.lambda.size ()))
+	return false;
+
+      Checkpoint result;
+      result.iteration = header.iteration;
+      result.mu = header.mu;
+      result.x.resize (checkpoint.x.size ());
+      result.lambda.resize (checkpoint.lambda.size ());
+      result.zL.resize (checkpoint.x.size ());
+      result.zU.resize (checkpoint.x.size ());
+      read (in, result.x);
+      read (in, result.lambda);
+      read (in, result.zL);
+      read (in, result.zU);
+      if (!in)
+	return false;
+
+      checkpoint = result;
+      return true;
+    }
+
+    bool
+    Checkpoint::save (const std::string& path, fingerprint_t fingerprint,
+		      const Checkpoint& checkpoint)
+    {
+      assert (checkpoint.zL.size () == checkpoint.x.size ());
+      assert (checkpoint.zU.size () == checkpoint.x.size ());
+
+      AtomicFile file (path);
+      std::ostream& out = file.stream ();
+      if (!out)
+	return false;
+
+      Header header;
+      std::memset (&header, 0, sizeof (Header));
+      std::memcpy (header.magic, magic, sizeof (magic));
+      header.version = version;
+      header.fingerprint = fingerprint;
+      header.inputSize = static_cast<boost::uint64_t> (checkpoint.x.size ());
+      header.constraintsSize =
+	static_cast<boost::uint64_t> (checkpoint.lambda.size ());
+      header.iteration = checkpoint.iteration;
+      header.mu = checkpoint.mu;
+      out.write (reinterpret_cast<const char*> (&header), sizeof (Header));
+
+      write (out, checkpoint.x);
+      write (out, checkpoint.lambda);
+      write (out, checkpoint.zL);
+      write (out, checkpoint.zU);
+
+      return file.commit ();
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
@@ -0,0 +1,91 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_CHECKPOINT_HH
+# define ROBOPTIM_CORE_IPOPT_CHECKPOINT_HH
+
+# include <string>
+
+# include <boost/cstdint.hpp>
+
+# include <Eigen/Core>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    /// \brief Checkpoint of a running solve.
+    ///
+    /// A checkpoint file stores the unscaled primal-dual iterate and
+    /// the barrier parameter of an iteration, in a binary format. Files
+    /// are identified by a fingerprint of the problem, which is stored
+    /// in the file and checked at load time.
+    struct Checkpoint
+    {
+      /// \brief Fingerprint type.
+      typedef boost::uint64_t fingerprint_t;
+
+      /// \brief Vector type.
+      typedef Eigen::VectorXd vector_t;
+
+      Checkpoint ();
+
+      /// \brief Read a checkpoint file.
+      ///
+      /// \param path checkpoint file.
+      /// \param fingerprint expected problem fingerprint.
+      /// \param checkpoint expected sizes of x and lambda (input) and
+      /// checkpoint (output).
+      /// \return whether the file exists and is valid.
+      static bool load (const std::string& path, fingerprint_t fingerprint,
+			Checkpoint& checkpoint);
+
+      /// \brief Write a checkpoint file.
+      ///
+      /// The file is written under a temporary name, then renamed, so
+      /// that an interrupted write leaves the previous checkpoint.
+      ///
+      /// \param path checkpoint file.
+      /// \param fingerprint problem fingerprint.
+      /// \param checkpoint checkpoint.
+      /// \return whether the file could be written.
+      static bool save (const std::string& path, fingerprint_t fingerprint,
+			const Checkpoint& checkpoint);
+
+      /// \brief Iteration number.
+      boost::int64_t iteration;
+
+      /// \brief Barrier parameter.
+      double mu;
+
+      /// \brief Optimization parameters.
+      vector_t x;
+
+      /// \brief Constraints multipliers.
+      vector_t lambda;
+
+      /// \brief Lower bound multipliers.
+      vector_t zL;
+
+      /// \brief Upper bound multipliers.
+      vector_t zU;
+    };
+  } // end of namespace detail.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_CHECKPOINT_HH
@@ -0,0 +1,166 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "coloring.hh"
+
+namespace roboptim
+{
+  namespace detail
+  {
+    namespace
+    {
+      /// \brief Order indices by decreasing degree (ties by index).
+      struct DegreeGreater
+      {
+	explicit DegreeGreater (const std::vector<int>& degrees)
+	  : degrees_ (degrees)
+	{}
+
+	bool operator () (int i, int j) const
+	{
+	  if (degrees_[i] != degrees_[j])
+	    return degrees_[i] > degrees_[j];
+	  return i < j;
+	}
+
+      private:
+	const std::vector<int>& degrees_;
+      };
+    } // end of anonymous namespace.
+
+    int
+    columnColoring (int cols,
+		    const std::vector<int>& rowOffsets,
+		    const std::vector<int>& rowColumns,
+		    std::vector<int>& colors)
+    {
+      assert (!rowOffsets.empty ());
+      std::size_t rows = rowOffsets.size () - 1;
+
+      // Transpose: rows of each column.
+      std::vector<int> columnOffsets (static_cast<std::size_t> (cols) + 1, 0);
+      for (std::size_t k = 0; k < rowColumns.size (); ++k)
+	++columnOffsets[static_cast<std::size_t> (rowColumns[k]) + 1];
+      for (int j = 0; j < cols; ++j)
+	columnOffsets[j + 1] += columnOffsets[j];
+
+      std::vector<int> columnRows (rowColumns.size ());
+      std::vector<int> next (columnOffsets.begin (), columnOffsets.end () - 1);
+      for (std::size_t i = 0; i < rows; ++i)
+	for (int k = rowOffsets[i]; k < rowOffsets[i + 1]; ++k)
+	  columnRows[static_cast<std::size_t> (next[rowColumns[k]]++)] =
+	    static_cast<int> (i);
+
+      std::vector<int> degrees (static_cast<std::size_t> (cols));
+      std::vector<int> order (static_cast<std::size_t> (cols));
+      for (int j = 0; j < cols; ++j)
+	{
+	  degrees[j] = columnOffsets[j + 1] - columnOffsets[j];
+	  order[j] = j;
+	}
+      std::sort (order.begin (), order.end (), DegreeGreater (degrees));
+
+      colors.assign (static_cast<std::size_t> (cols), -1);
+
+      // Column which last forbade each color.
+      std::vector<int> forbidden (static_cast<std::size_t> (cols) + 1, -1);
+      int count = 0;
+
+      for (std::size_t o = 0; o < order.size (); ++o)
+	{
+	  int j = order[o];
+	  if (degrees[j] == 0)
+	    continue;
+
+	  for (int p = columnOffsets[j]; p < columnOffsets[j + 1]; ++p)
+	    {
+	      int i = columnRows[p];
+	      for (int k = rowOffsets[i]; k < rowOffsets[i + 1]; ++k)
+		if (colors[rowColumns[k]] >= 0)
+		  forbidden[colors[rowColumns[k]]] = j;
+	    }
+
+	  int color = 0;
+	  while (forbidden[color] == j)
+	    ++color;
+	  colors[j] = color;
+	  count = std::max (count, color + 1);
+	}
+
+      return count;
+    }
+
+    int
+    starColoring (int n,
+		  const std::vector<int>& offsets,
+		  const std::vector<int>& neighbors,
+		  std::vector<int>& colors)
+    {
+      assert (offsets.size () == static_cast<std::size_t> (n) + 1);
+
+      colors.assign (static_cast<std::size_t> (n), -1);
+
+      // Vertex which last forbade each color.
+      std::vector<int> forbidden (static_cast<std::size_t> (n) + 1, -1);
+      int count = 0;
+
+      for (int v = 0; v < n; ++v)
+	{
+	  for (int p = offsets[v]; p < offsets[v + 1]; ++p)
+	    {
+	      int w = neighbors[p];
+	      if (colors[w] >= 0)
+		forbidden[colors[w]] = v;
+
+	      for (int q = offsets[w]; q < offsets[w + 1]; ++q)
+		{
+		  int x = neighbors[q];
+		  if (x == v || colors[x] < 0)
+		    continue;
+
+		  if (colors[w] < 0)
+		    // The color of x could make v-w-x two-colored.
+		    forbidden[colors[x]] = v;
+		  else
+		    // v-w-x-y would be two-colored.
+		    for (int r = offsets[x]; r < offsets[x + 1]; ++r)
+		      {
+			int y = neighbors[r];
+			if (y != w && colors[y] == colors[w])
+			  {
+			    forbidden[colors[x]] = v;
+			    break;
+			  }
+		      }
+		}
+	    }
+
+	  int color = 0;
+	  while (forbidden[color] == v)
+	    ++color;
+	  colors[v] = color;
+	  count = std::max (count, color + 1);
+	}
+
+      return count;
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
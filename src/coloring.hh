@@ -0,0 +1,71 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_COLORING_HH
+# define ROBOPTIM_CORE_IPOPT_COLORING_HH
+
+# include <vector>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    /// \brief Color the columns of a sparse matrix for compressed
+    /// finite differences (Curtis, Powell and Reid).
+    ///
+    /// Columns sharing a row get different colors, so the columns of a
+    /// color can be perturbed together. Columns are colored greedily,
+    /// by decreasing number of nonzeros.
+    ///
+    /// \param cols number of columns.
+    /// \param rowOffsets start of each row in rowColumns (compressed
+    /// row storage, rows + 1 elements).
+    /// \param rowColumns column of each nonzero.
+    /// \param colors color of each column (output), -1 for empty
+    /// columns.
+    /// \return number of colors.
+    int columnColoring (int cols,
+			const std::vector<int>& rowOffsets,
+			const std::vector<int>& rowColumns,
+			std::vector<int>& colors);
+
+    /// \internal
+    /// \brief Star coloring of the adjacency graph of a symmetric
+    /// sparse matrix.
+    ///
+    /// Adjacent vertices get different colors and every path on four
+    /// vertices uses at least three colors, so each off-diagonal entry
+    /// can be recovered directly from the products of the matrix with
+    /// the sums of the columns of each color (Coleman and Moré). Uses
+    /// the greedy algorithm of Gebremedhin, Manne and Pothen, in the
+    /// natural order.
+    ///
+    /// \param n number of vertices.
+    /// \param offsets start of the neighbors of each vertex in neighbors
+    /// (n + 1 elements).
+    /// \param neighbors neighbors of each vertex (no self loop).
+    /// \param colors color of each vertex (output).
+    /// \return number of colors.
+    int starColoring (int n,
+		      const std::vector<int>& offsets,
+		      const std::vector<int>& neighbors,
+		      std::vector<int>& colors);
+  } // end of namespace detail.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_COLORING_HH
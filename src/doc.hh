@@ -23,6 +23,181 @@
 
    FIXME
 
+   \section parameters Plug-in parameters
+
+   Parameters prefixed by \c ipopt. are forwarded to Ipopt, except the
+   ones prefixed by \c ipopt.plugin. which control the plug-in itself:
+
+   - \c ipopt.plugin.eval_threads (int, default: 1): number of threads
+     used to evaluate the constraints and their Jacobians. Constraints
+     are dispatched to a persistent work-stealing pool, balanced using
+     their measured evaluation times. The constraint functions must be
+     safe to evaluate concurrently when this is greater than 1. Since
+     Eigen's allocation check is not thread-safe, the plug-in does not
+     enforce it while the workers run.
+
+   - \c ipopt.plugin.cache_hessians (bool, default: true): with
+     \c ipopt-td and \c ipopt-sparse-td, keep the objective and
+     constraint Hessians of the current iterate so that a Lagrangian
+     Hessian request at the same point with new multipliers only
+     re-weights them. This keeps, for every constraint row, the values
+     of the Lagrangian Hessian structural nonzeros with \c ipopt-td,
+     or a sparse Hessian with \c ipopt-sparse-td. Disable it when
+     memory matters more than Hessian evaluations.
+
+   - \c ipopt.plugin.cache_dense_jacobian (bool, default: false): with
+     \c ipopt and \c ipopt-td, keep a copy of the constraints Jacobian of the current
+     iterate, so that a request at the same point is served without
+     evaluating the Jacobians again. Ipopt already keeps the Jacobian
+     of each iterate, so such requests are rare: the copy costs m × n
+     doubles, and one m × n copy per Jacobian evaluation.
+
+   - \c ipopt.plugin.structure_samples (int, default: 3): number of
+     points at which the functions are evaluated to detect sparsity
+     patterns, when no pattern is declared. The first one is the
+     starting point, the others are random perturbations of it inside
+     the argument bounds. The union of the patterns is used for the
+     solve. A detected pattern misses the entries which are zero at
+     every sample point: when a Hessian or Jacobian nonzero is found
+     later outside of the pattern, it is added to the pattern and the
+     solve starts again from the beginning (this extended pattern is
+     kept by later solves, and replaces the cached one). With a
+     declared pattern, such a nonzero makes the solve fail with a
+     SolverError naming the function and the entry. Declare the
+     pattern when restarts are too expensive. Derivatives computed by
+     finite differences are only evaluated on the pattern, so missing
+     entries cannot be detected.
+
+   - \c ipopt.plugin.check_hessian_structure (bool, default: false):
+     with \c ipopt-td, check every Hessian evaluation for nonzeros
+     outside of the Hessian pattern. This scans the lower triangle of
+     every row Hessian, which costs O(n²) per row. Otherwise, only the
+     first evaluation after the detection of a pattern is checked, and
+     declared patterns are never checked: later nonzeros outside of the
+     pattern are ignored.
+
+   - \c ipopt.plugin.finite_difference_jacobians (bool, default: false):
+     with \c ipopt-sparse and \c ipopt-sparse-td, compute the Jacobians
+     of the nonlinear constraints by forward finite differences instead
+     of calling their jacobian method. The columns of each constraint
+     Jacobian structure are colored so that columns sharing no row are
+     perturbed together (Curtis, Powell and Reid): a Jacobian then
+     costs one evaluation of the constraint per color. The structure is
+     still detected with the jacobian method unless a pattern is
+     declared or cached (see \c ipopt.plugin.structure_cache).
+
+   - \c ipopt.plugin.finite_difference_hessian (bool, default: false):
+     with \c ipopt-td, compute the Lagrangian Hessian from forward
+     differences of the Lagrangian gradient instead of calling the
+     hessian methods. The variables are star colored on the Hessian
+     structure so that each nonzero can be recovered from the gradient
+     differences, using symmetry (Gebremedhin, Manne and Pothen): a
+     Hessian then costs one Lagrangian gradient per color, plus one at
+     the current point. Without a declared or cached pattern, the
+     structure is detected from gradients differences at the sample
+     points: each variable is perturbed in turn, which costs n + 1
+     Jacobian evaluations of the cost and of each nonlinear constraint
+     per sample point, n being the number of variables. Declare the
+     pattern (or enable \c ipopt.plugin.structure_cache) for large
+     problems. Hessians are not cached in this mode.
+
+     This mode is only available with \c ipopt-td: the cost and
+     constraints must still be twice differentiable functions, and
+     other plug-ins ignore the parameter. Their \c impl_hessian is
+     never called in this mode, so a stub (e.g. throwing
+     \c std::runtime_error) is enough; only the gradients and
+     Jacobians have to be implemented. Problems made of differentiable
+     functions should use \c ipopt or \c ipopt-sparse with the
+     limited-memory Hessian approximation instead.
+
+   - \c ipopt.plugin.finite_difference_step (double, default: 1e-8):
+     relative step of the finite differences, the step of a variable x
+     being this value times max(1, |x|).
+
+   - \c ipopt.plugin.linear_variables (bool, default: true): detect the
+     variables which only appear linearly, and restrict the
+     limited-memory quasi-Newton approximation to the other ones. They
+     are the variables outside of the Lagrangian Hessian structure
+     (declared or detected) with twice differentiable problems and
+     with a declared Hessian pattern. Otherwise, with \c ipopt-sparse,
+     they are the variables outside of the cost gradient structure
+     and of the nonlinear constraints Jacobians structure, while with
+     \c ipopt all the variables are considered nonlinear, unless
+     \c ipopt.plugin.sample_linear_variables is set.
+
+   - \c ipopt.plugin.sample_linear_variables (bool, default: false):
+     with first order problems and no declared Hessian pattern, detect
+     the linear variables from the derivative values of the cost and
+     nonlinear constraints at the structure sample points: a variable
+     is nonlinear when these derivatives differ between the samples.
+     This costs one Jacobian of each function per sample, and
+     misclassifies variables whose derivatives only change away from
+     the samples (kinks, piecewise definitions): only enable it for
+     smooth functions. At least two samples are needed for any
+     variable to be detected as linear.
+
+   - \c ipopt.plugin.structure_cache (string, default: empty): directory
+     in which the detected sparsity structures are stored, so that
+     later solves of the same problem in other processes skip the
+     detection. Files are memory-mapped and named after a fingerprint
+     of the solver type, of the functions names and sizes and of the
+     constraints layout: functions should have distinctive names when
+     this is used. The cache is not used when a sparsity pattern is
+     declared. An empty value disables the cache.
+
+   - \c ipopt.plugin.warm_start_store (string, default: empty):
+     directory in which the final iterates of successful solves are
+     stored, so that later solves of the same problem, in this process
+     or others, are warm started from the closest one (see \ref
+     warm_start). Files are memory-mapped, named after a fingerprint of
+     the solver type and of the functions names and sizes, and keep the
+     last 16 iterates. Accesses are serialized by a lock on a
+     \c .lock file next to each store. Iterates are only reused with
+     the same Ipopt options, the closest one being the one whose
+     bounds and starting point are nearest. An explicit warm start
+     takes precedence. An empty value disables the store.
+
+   - \c ipopt.plugin.checkpoint_file (string, default: empty): file in
+     which the current unscaled primal-dual iterate and barrier
+     parameter are saved during the solve, every
+     \c ipopt.plugin.checkpoint_iterations (int, default: 10)
+     iterations or \c ipopt.plugin.checkpoint_seconds (double,
+     default: 60) seconds, whichever comes first (0 disables a
+     criterion). The file is written under a temporary name then
+     renamed, and is removed when the solve succeeds. An empty value
+     disables checkpoints.
+
+   - \c ipopt.plugin.checkpoint_resume (bool, default: false): start
+     from the checkpoint file, if it exists and matches the problem,
+     through the warm start options, with \c mu_init set to the saved
+     barrier parameter for that solve only, unless \c ipopt.mu_init is
+     set. Iterations are counted again from zero.
+
+   \section warm_start Warm start
+
+   A solve can start from the primal-dual iterate of a previous one,
+   which is kept by the solver (\c finalIterate) and given back with
+   \c setWarmStart, either directly or through the previous Result.
+   The iterate replaces the problem starting point, and Ipopt
+   \c warm_start_init_point option is enabled with bound pushes of
+   1e-9, unless these options are set explicitly. These options are
+   restored after the solve, and solves without a starting iterate
+   leave them untouched. Lowering
+   \c ipopt.mu_init is usually needed for the warm start to pay off.
+
+   When the same problem is solved repeatedly, \c resolve re-optimizes
+   it with the Ipopt application of the previous solve: the problem
+   analysis and evaluation buffers are kept, and options are only
+   forwarded to Ipopt again if a parameter changed. The problem
+   structure must be unchanged. Changing a bound kind, or a plug-in
+   parameter read while analyzing the problem (evaluation threads,
+   caches, structure detection, finite differences, structure cache),
+   makes \c resolve fall back to \c solve. The solver keeps its own copy of the
+   bounds, scaling and starting point of the problem, which can be
+   updated in place between solves (\c setArgumentBounds,
+   \c setConstraintBounds, \c setArgumentScaling,
+   \c setConstraintScaling, \c setStartingPoint).
+
    \section reporting Reporting bugs
 
    As this package is still in its early development steps, bugs report
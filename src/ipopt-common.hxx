@@ -20,10 +20,21 @@
 
 # include <roboptim/core/sys.hh>
 # include <roboptim/core/portability.hh>
+# include <roboptim/core/quadratic-function.hh>
 
+# include <algorithm>
 # include <stdexcept>
+# include <string>
+# include <typeinfo>
+# include <utility>
 
+# include <boost/functional/hash.hpp>
+# include <boost/mpl/at.hpp>
+# include <boost/mpl/int.hpp>
 # include <boost/mpl/vector.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/variant/apply_visitor.hpp>
+# include <boost/variant/static_visitor.hpp>
 
 # include <coin/IpSmartPtr.hpp>
 # include <coin/IpIpoptApplication.hpp>
@@ -32,6 +43,9 @@
 # include "roboptim/core/plugin/ipopt/ipopt-parameters-updater.hh"
 # include "roboptim/core/plugin/ipopt/ipopt-common.hh"
 
+# include "checkpoint.hh"
+# include "warm-start-store.hh"
+
 # ifndef IPOPT_DEFAULT_LINEAR_SOLVER
    // Enable by default MUMPS which is the only open-source
    // solver provided by Ipopt.
@@ -40,14 +54,108 @@
 
 namespace roboptim
 {
+  namespace detail
+  {
+    /// \internal
+    /// \brief Compare two parameter values.
+    struct ParameterEqual : public boost::static_visitor<bool>
+    {
+      template <typename U, typename V>
+      bool operator () (const U&, const V&) const
+      {
+	return false;
+      }
+
+      template <typename U>
+      bool operator () (const U& lhs, const U& rhs) const
+      {
+	return lhs == rhs;
+      }
+
+      // Eigen requires vectors of the same size.
+      bool operator () (const Function::vector_t& lhs,
+			const Function::vector_t& rhs) const
+      {
+	return lhs.size () == rhs.size () && lhs == rhs;
+      }
+    };
+
+    /// \internal
+    /// \brief Kind of a bound interval, as classified by Ipopt.
+    ///
+    /// Equalities (fixed variables for arguments) and the finite sides
+    /// of inequalities decide the problem spaces built by Ipopt. Bounds
+    /// beyond Ipopt infinity (1e19) are infinite.
+    template <typename I>
+    int boundKind (const I& interval)
+    {
+      const double infinity = 1e19;
+      if (interval.first == interval.second)
+	return 4;
+      return (interval.first > -infinity ? 1 : 0)
+	| (interval.second < infinity ? 2 : 0);
+    }
+
+    /// \internal
+    /// \brief Whether two lists of bounds have the same kinds.
+    template <typename I>
+    bool sameBoundKinds (const I& lhs, const I& rhs)
+    {
+      if (lhs.size () != rhs.size ())
+	return false;
+      for (std::size_t i = 0; i < lhs.size (); ++i)
+	if (boundKind (lhs[i]) != boundKind (rhs[i]))
+	  return false;
+      return true;
+    }
+
+    /// \internal
+    /// \brief Hash a parameter value.
+    struct ParameterHash : public boost::static_visitor<std::size_t>
+    {
+      template <typename U>
+      std::size_t operator () (const U& value) const
+      {
+	return boost::hash<U> () (value);
+      }
+
+      std::size_t operator () (const Function::vector_t& value) const
+      {
+	std::size_t seed = 0;
+	for (Function::size_type i = 0; i < value.size (); ++i)
+	  boost::hash_combine (seed, value[i]);
+	return seed;
+      }
+    };
+  } // end of namespace detail.
+
   template<typename T>
   IpoptSolverCommon<T>::
   IpoptSolverCommon (const problem_t& pb,
 		     Ipopt::SmartPtr<Ipopt::TNLP> tnlp)
     : parent_t (pb),
+      cacheStatistics_ (),
+      hessianSparsityPattern_ (),
+      jacobianSparsityPattern_ (),
+      warmStart_ (),
+      storedIterate_ (),
+      storedMu_ (),
+      finalIterate_ (),
+      optimizations_ (0),
+      structureExtended_ (false),
+      argumentBounds_ (pb.argumentBounds ()),
+      boundsVector_ (pb.boundsVector ()),
+      argumentScaling_ (pb.argumentScaling ()),
+      scalingVector_ (pb.scalingVector ()),
+      startingPoint_ (pb.startingPoint ()),
       nlp_ (tnlp),
       app_ (IpoptApplicationFactory ()),
-      callback_ ()
+      callback_ (),
+      appliedParameters_ (),
+      overriddenStringOptions_ (),
+      overriddenNumericOptions_ (),
+      optimized_ (false),
+      boundKindsChanged_ (false)
   {
     app_->Jnlst()->DeleteAllJournals();
 
@@ -80,7 +188,7 @@ namespace roboptim
 #define SWITCH_OK(NAME, CASES)			\
   case NAME:					\
   {						\
-    int status = app_->OptimizeTNLP (nlp_);	\
+    int status = optimizeTNLP (reoptimize);	\
     switch (status)				\
       {						\
 	CASES;					\
@@ -128,7 +236,63 @@ namespace roboptim
   {
     // Read parameters and forward them to Ipopt.
     updateParameters ();
-    Ipopt::ApplicationReturnStatus status = app_->Initialize ("");
+    loadStoredIterate ();
+    updateLinearityOptions ();
+    updateWarmStartOptions ();
+    try
+      {
+	optimize (app_->Initialize (""), false);
+      }
+    catch (...)
+      {
+	restoreOptions ();
+	throw;
+      }
+    restoreOptions ();
+    saveStoredIterate ();
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  resolve ()
+  {
+    // Bounds kinds define the problem spaces kept by Ipopt, and
+    // re-optimizations skip the problem analysis.
+    if (!optimized_ || boundKindsChanged_ || structureParametersChanged ())
+      {
+	solve ();
+	return;
+      }
+
+    // Only forward parameters again if they changed.
+    int status = Ipopt::Solve_Succeeded;
+    if (parametersChanged ())
+      {
+	updateParameters ();
+	status = app_->Initialize ("");
+      }
+    loadStoredIterate ();
+    updateLinearityOptions ();
+    updateWarmStartOptions ();
+    overrideOption ("warm_start_same_structure", "yes");
+    try
+      {
+	optimize (status, true);
+      }
+    catch (...)
+      {
+	restoreOptions ();
+	throw;
+      }
+    restoreOptions ();
+    saveStoredIterate ();
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  optimize (int status, bool reoptimize)
+  {
+    cacheStatistics_.reset ();
 
     switch (status)
       {
@@ -146,6 +310,78 @@ namespace roboptim
 #undef MAP_IPOPT_FATALS
 #undef MAP_IPOPT_OKS
 
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  setArgumentBounds (const intervals_t& bounds)
+  {
+    if (bounds.size () != argumentBounds_.size ())
+      throw std::runtime_error ("invalid number of argument bounds");
+    if (!detail::sameBoundKinds (argumentBounds_, bounds))
+      boundKindsChanged_ = true;
+    argumentBounds_ = bounds;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  setConstraintBounds (std::size_t constraint, const intervals_t& bounds)
+  {
+    if (constraint >= boundsVector_.size ())
+      throw std::runtime_error ("invalid constraint index");
+    if (bounds.size () != boundsVector_[constraint].size ())
+      throw std::runtime_error ("invalid number of constraint bounds");
+    if (!detail::sameBoundKinds (boundsVector_[constraint], bounds))
+      boundKindsChanged_ = true;
+    boundsVector_[constraint] = bounds;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  setArgumentScaling (const scales_t& scaling)
+  {
+    if (scaling.size () != argumentScaling_.size ())
+      throw std::runtime_error ("invalid number of argument scales");
+    argumentScaling_ = scaling;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  setConstraintScaling (std::size_t constraint, const scales_t& scaling)
+  {
+    if (constraint >= scalingVector_.size ())
+      throw std::runtime_error ("invalid constraint index");
+    if (scaling.size () != scalingVector_[constraint].size ())
+      throw std::runtime_error ("invalid number of constraint scales");
+    scalingVector_[constraint] = scaling;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  setStartingPoint (const vector_t& x)
+  {
+    if (x.size () != this->problem ().function ().inputSize ())
+      throw std::runtime_error ("invalid starting point size");
+    startingPoint_ = x;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  resetProblemUpdates ()
+  {
+    if (!detail::sameBoundKinds (argumentBounds_,
+				 this->problem ().argumentBounds ()))
+      boundKindsChanged_ = true;
+    for (std::size_t i = 0; i < boundsVector_.size (); ++i)
+      if (!detail::sameBoundKinds (boundsVector_[i],
+				   this->problem ().boundsVector ()[i]))
+	boundKindsChanged_ = true;
+
+    argumentBounds_ = this->problem ().argumentBounds ();
+    boundsVector_ = this->problem ().boundsVector ();
+    argumentScaling_ = this->problem ().argumentScaling ();
+    scalingVector_ = this->problem ().scalingVector ();
+    startingPoint_ = this->problem ().startingPoint ();
+  }
+
   template<typename T>
   Ipopt::SmartPtr<Ipopt::IpoptApplication> IpoptSolverCommon<T>::
   getIpoptApplication ()
@@ -243,6 +479,71 @@ namespace roboptim
     // Derivative test.
     DEFINE_PARAMETER ("ipopt.derivative_test", "enable derivative checker",
                       std::string ("none"));
+
+    // Plug-in specific parameters (not forwarded to Ipopt).
+    DEFINE_PARAMETER ("ipopt.plugin.eval_threads",
+                      "number of threads used to evaluate the constraints",
+                      1);
+    DEFINE_PARAMETER ("ipopt.plugin.cache_hessians",
+                      "keep constraint Hessians to re-weight them when"
+                      " only the multipliers change",
+                      true);
+    DEFINE_PARAMETER ("ipopt.plugin.check_hessian_structure",
+                      "check every Hessian evaluation for nonzeros"
+                      " outside of the structure (ipopt-td only)",
+                      false);
+    DEFINE_PARAMETER ("ipopt.plugin.cache_dense_jacobian",
+                      "keep a copy of the dense constraints Jacobian to"
+                      " serve requests at the same point (dense only)",
+                      false);
+    DEFINE_PARAMETER ("ipopt.plugin.structure_samples",
+                      "number of sample points used to detect sparsity"
+                      " patterns",
+                      3);
+    DEFINE_PARAMETER ("ipopt.plugin.linear_variables",
+                      "detect the variables appearing linearly to"
+                      " restrict the quasi-Newton approximation",
+                      true);
+    DEFINE_PARAMETER ("ipopt.plugin.sample_linear_variables",
+                      "detect the variables appearing linearly from"
+                      " derivatives at sample points (first order"
+                      " solvers without Hessian pattern)",
+                      false);
+    DEFINE_PARAMETER ("ipopt.plugin.finite_difference_jacobians",
+                      "compute the nonlinear constraints Jacobians by"
+                      " compressed finite differences (sparse only)",
+                      false);
+    DEFINE_PARAMETER ("ipopt.plugin.finite_difference_hessian",
+                      "compute the Lagrangian Hessian from gradients"
+                      " differences (ipopt-td only)",
+                      false);
+    DEFINE_PARAMETER ("ipopt.plugin.finite_difference_step",
+                      "relative step of the finite differences",
+                      1e-8);
+    DEFINE_PARAMETER ("ipopt.plugin.structure_cache",
+                      "directory of the sparsity structures cache"
+                      " (disabled if empty)",
+                      std::string ());
+    DEFINE_PARAMETER ("ipopt.plugin.warm_start_store",
+                      "directory of the final iterates store used to"
+                      " warm start solves (disabled if empty)",
+                      std::string ());
+    DEFINE_PARAMETER ("ipopt.plugin.checkpoint_file",
+                      "file in which the current iterate is periodically"
+                      " saved (disabled if empty)",
+                      std::string ());
+    DEFINE_PARAMETER ("ipopt.plugin.checkpoint_iterations",
+                      "number of iterations between checkpoints"
+                      " (0 to disable)",
+                      10);
+    DEFINE_PARAMETER ("ipopt.plugin.checkpoint_seconds",
+                      "number of seconds between checkpoints"
+                      " (0 to disable)",
+                      60.);
+    DEFINE_PARAMETER ("ipopt.plugin.checkpoint_resume",
+                      "resume from the checkpoint file if it matches"
+                      " the problem",
+                      false);
   }
 
 #undef DEFINE_PARAMETER
@@ -252,10 +553,12 @@ namespace roboptim
   updateParameters ()
   {
     const std::string prefix = "ipopt.";
+    const std::string pluginPrefix = "ipopt.plugin.";
     typedef const std::pair<const std::string, Parameter> const_iterator_t;
     BOOST_FOREACH (const_iterator_t& it, this->parameters_)
       {
-	if (it.first.substr (0, prefix.size ()) == prefix)
+	if (it.first.substr (0, prefix.size ()) == prefix
+	    && it.first.substr (0, pluginPrefix.size ()) != pluginPrefix)
 	  {
 	    boost::apply_visitor
 	      (IpoptParametersUpdater
@@ -267,6 +570,431 @@ namespace roboptim
     boost::apply_visitor
       (IpoptParametersUpdater
        (app_, "max_iter"), this->parameters_["max-iterations"].value);
+
+    appliedParameters_ = this->parameters_;
+  }
+
+  template<typename T>
+  bool IpoptSolverCommon<T>::
+  parametersChanged () const
+  {
+    typedef typename parent_t::parameters_t::const_iterator citer_t;
+
+    if (this->parameters_.size () != appliedParameters_.size ())
+      return true;
+
+    for (citer_t it = this->parameters_.begin (),
+	   jt = appliedParameters_.begin ();
+	 it != this->parameters_.end (); ++it, ++jt)
+      if (it->first != jt->first
+	  || !boost::apply_visitor (detail::ParameterEqual (),
+				    it->second.value, jt->second.value))
+	return true;
+    return false;
+  }
+
+  template<typename T>
+  bool IpoptSolverCommon<T>::
+  structureParametersChanged () const
+  {
+    typedef typename parent_t::parameters_t::const_iterator citer_t;
+
+    // Parameters read by the Tnlp in get_nlp_info.
+    static const char* keys[] =
+      {
+	"ipopt.plugin.eval_threads",
+	"ipopt.plugin.cache_hessians",
+	"ipopt.plugin.check_hessian_structure",
+	"ipopt.plugin.cache_dense_jacobian",
+	"ipopt.plugin.structure_samples",
+	"ipopt.plugin.linear_variables",
+	"ipopt.plugin.sample_linear_variables",
+	"ipopt.plugin.finite_difference_jacobians",
+	"ipopt.plugin.finite_difference_hessian",
+	"ipopt.plugin.finite_difference_step",
+	"ipopt.plugin.structure_cache"
+      };
+
+    for (std::size_t i = 0; i < sizeof (keys) / sizeof (keys[0]); ++i)
+      {
+	citer_t it = this->parameters_.find (keys[i]);
+	citer_t jt = appliedParameters_.find (keys[i]);
+	if ((it == this->parameters_.end ())
+	    != (jt == appliedParameters_.end ()))
+	  return true;
+	if (it != this->parameters_.end ()
+	    && !boost::apply_visitor (detail::ParameterEqual (),
+				      it->second.value, jt->second.value))
+	  return true;
+      }
+    return false;
+  }
+
+  template<typename T>
+  int IpoptSolverCommon<T>::
+  optimizeTNLP (bool reoptimize)
+  {
+    // Nothing can be re-optimized if this throws.
+    optimized_ = false;
+    boundKindsChanged_ = false;
+    ++optimizations_;
+
+    structureExtended_ = false;
+    int status = reoptimize
+      ? app_->ReOptimizeTNLP (nlp_) : app_->OptimizeTNLP (nlp_);
+
+    // Sampled structures missed some nonzeros: the Tnlp added them,
+    // query the problem structure again. Each restart adds nonzeros,
+    // so this ends.
+    while (structureExtended_)
+      {
+	structureExtended_ = false;
+	++optimizations_;
+	overrideOption ("warm_start_same_structure", "no");
+	status = app_->OptimizeTNLP (nlp_);
+      }
+
+    // Lower statuses are problem setup failures.
+    optimized_ = status > Ipopt::Not_Enough_Degrees_Of_Freedom;
+    return status;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  updateLinearityOptions ()
+  {
+    typedef typename problem_t::intervals_t::const_iterator citer_t;
+    typedef typename problem_t::function_t function_t;
+    typedef GenericQuadraticFunction<typename function_t::traits_t>
+      quadraticFunction_t;
+
+    const problem_t& pb = this->problem ();
+
+    bool linearEqualities = true;
+    bool linearInequalities = true;
+    for (std::size_t i = 0; i < pb.constraints ().size (); ++i)
+      {
+	if (pb.constraints ()[i].which () == LINEAR)
+	  continue;
+
+	// Ipopt classifies the constraints rows the same way.
+	for (citer_t it = boundsVector_[i].begin ();
+	     it != boundsVector_[i].end (); ++it)
+	  if (it->first == it->second)
+	    linearEqualities = false;
+	  else
+	    linearInequalities = false;
+      }
+
+    const std::string* approximation = boost::get<std::string>
+      (&this->parameters_["ipopt.hessian_approximation"].value);
+    bool constantHessian = linearEqualities && linearInequalities
+      && approximation && *approximation == "exact"
+      && dynamic_cast<const quadraticFunction_t*> (&pb.function ());
+
+    const std::pair<const char*, bool> options[] =
+      {
+	std::make_pair ("jac_c_constant", linearEqualities),
+	std::make_pair ("jac_d_constant", linearInequalities),
+	std::make_pair ("hessian_constant", constantHessian)
+      };
+
+    // Only flag the constant derivatives, for this solve: bounds
+    // updates may turn constraints into equalities before the next one.
+    for (std::size_t i = 0; i < sizeof (options) / sizeof (options[0]); ++i)
+      if (options[i].second)
+	overrideOption (options[i].first, "yes");
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  updateWarmStartOptions ()
+  {
+    // Keep the iterate close to the bounds: it is expected to be
+    // close to the solution.
+    const char* pushes[] =
+      {
+	"warm_start_bound_push",
+	"warm_start_bound_frac",
+	"warm_start_slack_bound_push",
+	"warm_start_slack_bound_frac",
+	"warm_start_mult_bound_push"
+      };
+
+    // Cold solves leave Ipopt options untouched.
+    if (startingIterate ())
+      {
+	overrideOption ("warm_start_init_point", "yes");
+	for (std::size_t i = 0; i < sizeof (pushes) / sizeof (pushes[0]); ++i)
+	  overrideOption (pushes[i], 1e-9);
+      }
+
+    // Resume with the barrier parameter of the checkpoint.
+    if (storedMu_)
+      overrideOption ("mu_init", *storedMu_);
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  overrideOption (const std::string& name, const std::string& value)
+  {
+    if (this->parameters_.find ("ipopt." + name) != this->parameters_.end ())
+      return;
+
+    std::string previous;
+    app_->Options ()->GetStringValue (name, previous, "");
+    overriddenStringOptions_.push_back (std::make_pair (name, previous));
+    app_->Options ()->SetStringValue (name, value);
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  overrideOption (const std::string& name, double value)
+  {
+    if (this->parameters_.find ("ipopt." + name) != this->parameters_.end ())
+      return;
+
+    Ipopt::Number previous;
+    app_->Options ()->GetNumericValue (name, previous, "");
+    overriddenNumericOptions_.push_back (std::make_pair (name, previous));
+    app_->Options ()->SetNumericValue (name, value);
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  restoreOptions ()
+  {
+    // Latest first: an option may have been overridden several times.
+    for (std::size_t i = overriddenStringOptions_.size (); i > 0; --i)
+      app_->Options ()->SetStringValue
+	(overriddenStringOptions_[i - 1].first,
+	 overriddenStringOptions_[i - 1].second);
+    for (std::size_t i = overriddenNumericOptions_.size (); i > 0; --i)
+      app_->Options ()->SetNumericValue
+	(overriddenNumericOptions_[i - 1].first,
+	 overriddenNumericOptions_[i - 1].second);
+
+    overriddenStringOptions_.clear ();
+    overriddenNumericOptions_.clear ();
+  }
+
+  template<typename T>
+  std::size_t IpoptSolverCommon<T>::
+  problemFingerprint () const
+  {
+    typedef typename problem_t::constraints_t::const_iterator citer_t;
+    typedef typename problem_t::constraintsList_t constraintsList_t;
+    typedef typename boost::mpl::at<constraintsList_t,
+				    boost::mpl::int_<LINEAR> >::type
+      linearFunction_t;
+    typedef typename boost::mpl::at<constraintsList_t,
+				    boost::mpl::int_<NONLINEAR> >::type
+      nonLinearFunction_t;
+    typedef GenericFunction<typename problem_t::function_t::traits_t>
+      function_t;
+
+    const problem_t& pb = this->problem ();
+
+    std::size_t seed = 0;
+    boost::hash_combine (seed, std::string (typeid (T).name ()));
+    boost::hash_combine (seed, pb.function ().getName ());
+    boost::hash_combine (seed, pb.function ().inputSize ());
+    boost::hash_combine (seed, pb.function ().outputSize ());
+
+    for (citer_t it = pb.constraints ().begin ();
+	 it != pb.constraints ().end (); ++it)
+      {
+	const function_t* function = (it->which () == LINEAR)
+	  ? static_cast<const function_t*>
+	  (boost::get<boost::shared_ptr<linearFunction_t> > (*it).get ())
+	  : static_cast<const function_t*>
+	  (boost::get<boost::shared_ptr<nonLinearFunction_t> > (*it).get ());
+	boost::hash_combine (seed, function->getName ());
+	boost::hash_combine (seed, function->outputSize ());
+	boost::hash_combine (seed, it->which ());
+      }
+    return seed;
+  }
+
+  template<typename T>
+  std::size_t IpoptSolverCommon<T>::
+  parametersHash () const
+  {
+    typedef typename parent_t::parameters_t::const_iterator citer_t;
+
+    // Same parameters as the ones forwarded by updateParameters.
+    const std::string prefix = "ipopt.";
+    const std::string pluginPrefix = "ipopt.plugin.";
+
+    std::size_t seed = 0;
+    for (citer_t it = this->parameters_.begin ();
+	 it != this->parameters_.end (); ++it)
+      if ((it->first.substr (0, prefix.size ()) == prefix
+	   && it->first.substr (0, pluginPrefix.size ()) != pluginPrefix)
+	  || it->first == "max-iterations")
+	{
+	  boost::hash_combine (seed, it->first);
+	  boost::hash_combine
+	    (seed, boost::apply_visitor (detail::ParameterHash (),
+					 it->second.value));
+	}
+    return seed;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  problemSignature (vector_t& signature) const
+  {
+    typedef typename intervals_t::const_iterator citer_t;
+    typedef typename intervalsVect_t::const_iterator citerVect_t;
+    typedef typename vector_t::Index index_t;
+
+    // Infinite bounds are mapped to Ipopt ones to keep distances
+    // finite.
+    const double infinity = 1e19;
+
+    std::size_t size = 2 * argumentBounds_.size ();
+    for (citerVect_t it = boundsVector_.begin ();
+	 it != boundsVector_.end (); ++it)
+      size += 2 * it->size ();
+    size += argumentBounds_.size ();
+    signature.resize (static_cast<index_t> (size));
+
+    index_t i = 0;
+    for (citer_t it = argumentBounds_.begin ();
+	 it != argumentBounds_.end (); ++it)
+      {
+	signature[i++] = std::max (it->first, -infinity);
+	signature[i++] = std::min (it->second, infinity);
+      }
+    for (citerVect_t it = boundsVector_.begin ();
+	 it != boundsVector_.end (); ++it)
+      for (citer_t it2 = it->begin (); it2 != it->end (); ++it2)
+	{
+	  signature[i++] = std::max (it2->first, -infinity);
+	  signature[i++] = std::min (it2->second, infinity);
+	}
+
+    index_t n = static_cast<index_t> (argumentBounds_.size ());
+    if (startingPoint_)
+      signature.segment (i, n) = *startingPoint_;
+    else
+      signature.segment (i, n).setZero ();
+  }
+
+  template<typename T>
+  std::string IpoptSolverCommon<T>::
+  warmStartStore () const
+  {
+    typename parent_t::parameters_t::const_iterator
+      it = this->parameters_.find ("ipopt.plugin.warm_start_store");
+    if (it == this->parameters_.end ())
+      return std::string ();
+
+    const std::string* directory =
+      boost::get<std::string> (&it->second.value);
+    return directory ? *directory : std::string ();
+  }
+
+  template<typename T>
+  std::size_t IpoptSolverCommon<T>::
+  constraintsOutputSize () const
+  {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < boundsVector_.size (); ++i)
+      size += boundsVector_[i].size ();
+    return size;
+  }
+
+  template<typename T>
+  bool IpoptSolverCommon<T>::
+  loadCheckpoint ()
+  {
+    const std::string* path = boost::get<std::string>
+      (&this->parameters_["ipopt.plugin.checkpoint_file"].value);
+    const bool* resume = boost::get<bool>
+      (&this->parameters_["ipopt.plugin.checkpoint_resume"].value);
+    if (!path || path->empty () || !resume || !*resume)
+      return false;
+
+    detail::Checkpoint checkpoint;
+    checkpoint.x.resize (this->problem ().function ().inputSize ());
+    checkpoint.lambda.resize
+      (static_cast<typename vector_t::Index> (constraintsOutputSize ()));
+    if (!detail::Checkpoint::load (*path, problemFingerprint (), checkpoint))
+      return false;
+
+    IpoptIterate iterate;
+    iterate.x = checkpoint.x;
+    iterate.lambda = checkpoint.lambda;
+    iterate.zL = checkpoint.zL;
+    iterate.zU = checkpoint.zU;
+    storedIterate_ = iterate;
+    storedMu_ = checkpoint.mu;
+    return true;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  loadStoredIterate ()
+  {
+    storedIterate_.reset ();
+    storedMu_.reset ();
+
+    // An explicit warm start takes precedence, then a checkpoint.
+    if (warmStart_ || loadCheckpoint ())
+      return;
+
+    std::string directory = warmStartStore ();
+    if (directory.empty ())
+      return;
+
+    std::size_t fingerprint = problemFingerprint ();
+    detail::WarmStartStore::Entry entry;
+    problemSignature (entry.signature);
+    entry.x.resize (this->problem ().function ().inputSize ());
+    entry.lambda.resize
+      (static_cast<typename vector_t::Index> (constraintsOutputSize ()));
+
+    if (!detail::WarmStartStore::lookup
+	(detail::WarmStartStore::path (directory, fingerprint),
+	 fingerprint, parametersHash (), entry))
+      return;
+
+    IpoptIterate iterate;
+    iterate.x = entry.x;
+    iterate.lambda = entry.lambda;
+    iterate.zL = entry.zL;
+    iterate.zU = entry.zU;
+    storedIterate_ = iterate;
+  }
+
+  template<typename T>
+  void IpoptSolverCommon<T>::
+  saveStoredIterate ()
+  {
+    storedIterate_.reset ();
+    storedMu_.reset ();
+
+    std::string directory = warmStartStore ();
+    if (directory.empty ()
+	|| this->result_.which () != T::SOLVER_VALUE
+	|| finalIterate_.zL.size () != finalIterate_.x.size ()
+	|| finalIterate_.zU.size () != finalIterate_.x.size ())
+      return;
+
+    std::size_t fingerprint = problemFingerprint ();
+    detail::WarmStartStore::Entry entry;
+    problemSignature (entry.signature);
+    entry.x = finalIterate_.x;
+    entry.lambda = finalIterate_.lambda;
+    entry.zL = finalIterate_.zL;
+    entry.zU = finalIterate_.zU;
+
+    // The store is an optimization: failures are not fatal.
+    detail::WarmStartStore::save
+      (detail::WarmStartStore::path (directory, fingerprint),
+       fingerprint, parametersHash (), entry);
   }
 } // end of namespace roboptim
 
@@ -0,0 +1,289 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "atomic-file.hh"
+#include "structure-cache.hh"
+
+namespace roboptim
+{
+  namespace detail
+  {
+    namespace
+    {
+      /// \brief Cache file header.
+      ///
+      /// Followed by one record of four indices (rows, columns, outer
+      /// size, nonzeros) per layout, then by the outer and inner arrays
+      /// of each layout, then by the Hessian rows and columns.
+      struct Header
+      {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t indexSize;
+	boost::uint64_t fingerprint;
+	boost::uint64_t layouts;
+	boost::uint64_t hessianNonZeros;
+      };
+
+      const char magic[8] = {'R', 'O', 'B', 'O', 'I', 'P', 'S', 'C'};
+
+      const boost::uint32_t version = 1;
+
+      /// \brief Number of indices of a layout record.
+      const std::size_t recordSize = 4;
+
+      typedef StructureCache::index_t index_t;
+
+      void
+      write (std::ostream& out, const index_t* data, std::size_t size)
+      {
+	out.write (reinterpret_cast<const char*> (data),
+		   static_cast<std::streamsize> (size * sizeof (index_t)));
+      }
+    } // end of anonymous namespace.
+
+    StructureCache::StructureCache ()
+      : region_ (),
+	layouts_ (),
+	hessianNonZeros_ (0),
+	hessianRows_ (0),
+	hessianCols_ (0)
+    {
+    }
+
+    StructureCache::~StructureCache ()
+    {
+    }
+
+    std::string
+    StructureCache::path (const std::string& directory,
+			  fingerprint_t fingerprint)
+    {
+      std::ostringstream ss;
+      ss << directory;
+      if (!directory.empty () && directory[directory.size () - 1] != '/')
+	ss << '/';
+      ss << "roboptim-ipopt-" << std::hex << fingerprint << ".structure";
+      return ss.str ();
+    }
+
+    bool
+    StructureCache::load (const std::string& path, fingerprint_t fingerprint)
+    {
+      using namespace boost::interprocess;
+
+      close ();
+
+      {
+	// Do not let file_mapping throw on missing files.
+	std::ifstream file (path.c_str ());
+	if (!file)
+	  return false;
+      }
+
+      try
+	{
+	  file_mapping file (path.c_str (), read_only);
+	  region_.reset (new mapped_region (file, read_only));
+	}
+      catch (const interprocess_exception&)
+	{
+	  region_.reset ();
+	  return false;
+	}
+
+      const char* data = static_cast<const char*> (region_->get_address ());
+      std::size_t size = region_->get_size ();
+
+      Header header;
+      if (size < sizeof (Header))
+	{
+	  close ();
+	  return false;
+	}
+      std::memcpy (&header, data, sizeof (Header));
+
+      if (std::memcmp (header.magic, magic, sizeof (magic)) != 0
+	  || header.version != version
+	  || header.indexSize != sizeof (index_t)
+	  || header.fingerprint != fingerprint)
+	{
+	  close ();
+	  return false;
+	}
+
+      // Number of indices following the header, checked against the
+      // file size as the arrays are walked through.
+      std::size_t available = (size - sizeof (Header)) / sizeof (index_t);
+      const index_t* indices =
+	reinterpret_cast<const index_t*> (data + sizeof (Header));
+
+      if (header.layouts > available / recordSize)
+	{
+	  close ();
+	  return false;
+	}
+
+      const index_t* records = indices;
+      std::size_t offset = header.layouts * recordSize;
+
+      layouts_.resize (header.layouts);
+      for (std::size_t i = 0; i < layouts_.size (); ++i)
+	{
+	  Layout& layout = layouts_[i];
+	  layout.rows = records[recordSize * i];
+	  layout.cols = records[recordSize * i + 1];
+	  layout.outerSize = records[recordSize * i + 2];
+	  layout.nonZeros = records[recordSize * i + 3];
+
+	  if (layout.rows < 0 || layout.cols < 0
+	      || layout.outerSize < 0 || layout.nonZeros < 0
+	      || available - offset
+	      < static_cast<std::size_t> (layout.outerSize) + 1
+	      + static_cast<std::size_t> (layout.nonZeros))
+	    {
+	      close ();
+	      return false;
+	    }
+
+	  layout.outer = indices + offset;
+	  offset += static_cast<std::size_t> (layout.outerSize) + 1;
+	  layout.inner = indices + offset;
+	  offset += static_cast<std::size_t> (layout.nonZeros);
+	}
+
+      if (header.hessianNonZeros > (available - offset) / 2)
+	{
+	  close ();
+	  return false;
+	}
+
+      hessianNonZeros_ = static_cast<std::size_t> (header.hessianNonZeros);
+      hessianRows_ = indices + offset;
+      hessianCols_ = hessianRows_ + hessianNonZeros_;
+      return true;
+    }
+
+    void
+    StructureCache::close ()
+    {
+      region_.reset ();
+      layouts_.clear ();
+      hessianNonZeros_ = 0;
+      hessianRows_ = 0;
+      hessianCols_ = 0;
+    }
+
+    bool
+    StructureCache::isLoaded () const
+    {
+      return !!region_;
+    }
+
+    std::size_t
+    StructureCache::numberOfLayouts () const
+    {
+      return layouts_.size ();
+    }
+
+    const StructureCache::Layout&
+    StructureCache::layout (std::size_t i) const
+    {
+      assert (i < layouts_.size ());
+      return layouts_[i];
+    }
+
+    std::size_t
+    StructureCache::hessianNonZeros () const
+    {
+      return hessianNonZeros_;
+    }
+
+    const StructureCache::index_t*
+    StructureCache::hessianRows () const
+    {
+      return hessianRows_;
+    }
+
+    const StructureCache::index_t*
+    StructureCache::hessianCols () const
+    {
+      return hessianCols_;
+    }
+
+    bool
+    StructureCache::save (const std::string& path,
+			  fingerprint_t fingerprint,
+			  const std::vector<Layout>& layouts,
+			  const std::vector<index_t>& hessianRows,
+			  const std::vector<index_t>& hessianCols)
+    {
+      assert (hessianRows.size () == hessianCols.size ());
+
+      AtomicFile file (path);
+      std::ostream& out = file.stream ();
+      if (!out)
+	return false;
+
+      Header header;
+      std::memset (&header, 0, sizeof (Header));
+      std::memcpy (header.magic, magic, sizeof (magic));
+      header.version = version;
+      header.indexSize = sizeof (index_t);
+      header.fingerprint = fingerprint;
+      header.layouts = layouts.size ();
+      header.hessianNonZeros = hessianRows.size ();
+      out.write (reinterpret_cast<const char*> (&header), sizeof (Header));
+
+      for (std::size_t i = 0; i < layouts.size (); ++i)
+	{
+	  index_t record[recordSize] =
+	    {
+	      layouts[i].rows,
+	      layouts[i].cols,
+	      layouts[i].outerSize,
+	      layouts[i].nonZeros
+	    };
+	  write (out, record, recordSize);
+	}
+
+      for (std::size_t i = 0; i < layouts.size (); ++i)
+	{
+	  write (out, layouts[i].outer,
+		 static_cast<std::size_t> (layouts[i].outerSize) + 1);
+	  write (out, layouts[i].inner,
+		 static_cast<std::size_t> (layouts[i].nonZeros));
+	}
+
+      if (!hessianRows.empty ())
+	{
+	  write (out, &hessianRows[0], hessianRows.size ());
+	  write (out, &hessianCols[0], hessianCols.size ());
+	}
+
+      return file.commit ();
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
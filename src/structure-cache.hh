@@ -0,0 +1,150 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_STRUCTURE_CACHE_HH
+# define ROBOPTIM_CORE_IPOPT_STRUCTURE_CACHE_HH
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+# include <boost/noncopyable.hpp>
+# include <boost/scoped_ptr.hpp>
+
+namespace boost
+{
+  namespace interprocess
+  {
+    class mapped_region;
+  } // end of namespace interprocess.
+} // end of namespace boost.
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    /// \brief On-disk cache of sparsity structures.
+    ///
+    /// A cache file stores the compressed layouts of the constraint
+    /// Jacobians and the Lagrangian Hessian structure of a problem, in
+    /// a binary format which is memory-mapped when loaded. Files are
+    /// identified by a fingerprint of the problem, which is also
+    /// stored in the file and checked at load time.
+    class StructureCache : private boost::noncopyable
+    {
+    public:
+      /// \brief Index type (Eigen sparse and Ipopt indices).
+      typedef int index_t;
+
+      /// \brief Fingerprint type.
+      typedef boost::uint64_t fingerprint_t;
+
+      /// \brief Compressed sparse matrix layout.
+      ///
+      /// Arrays are not owned by the layout.
+      struct Layout
+      {
+	index_t rows;
+	index_t cols;
+	index_t outerSize;
+	index_t nonZeros;
+	/// \brief Outer index array (outerSize + 1 elements).
+	const index_t* outer;
+	/// \brief Inner index array (nonZeros elements).
+	const index_t* inner;
+      };
+
+      StructureCache ();
+
+      ~StructureCache ();
+
+      /// \brief Cache file of a problem.
+      ///
+      /// \param directory cache directory.
+      /// \param fingerprint problem fingerprint.
+      static std::string path (const std::string& directory,
+			       fingerprint_t fingerprint);
+
+      /// \brief Map a cache file.
+      ///
+      /// \param path cache file.
+      /// \param fingerprint expected problem fingerprint.
+      /// \return whether the file exists and is valid.
+      bool load (const std::string& path, fingerprint_t fingerprint);
+
+      /// \brief Unmap the loaded file, if any.
+      void close ();
+
+      /// \brief Whether a file is loaded.
+      bool isLoaded () const;
+
+      /// \brief Number of Jacobian layouts of the loaded file.
+      std::size_t numberOfLayouts () const;
+
+      /// \brief Jacobian layout of the loaded file.
+      ///
+      /// Arrays point into the mapped file.
+      const Layout& layout (std::size_t i) const;
+
+      /// \brief Number of structural nonzeros of the Hessian.
+      std::size_t hessianNonZeros () const;
+
+      /// \brief Row indices of the Hessian structural nonzeros.
+      const index_t* hessianRows () const;
+
+      /// \brief Column indices of the Hessian structural nonzeros.
+      const index_t* hessianCols () const;
+
+      /// \brief Write a cache file.
+      ///
+      /// The file is written under a temporary name, then renamed, so
+      /// that concurrent processes never map a partial file.
+      ///
+      /// \param path cache file.
+      /// \param fingerprint problem fingerprint.
+      /// \param layouts Jacobian layouts.
+      /// \param hessianRows row indices of the Hessian nonzeros.
+      /// \param hessianCols column indices of the Hessian nonzeros.
+      /// \return whether the file could be written.
+      static bool save (const std::string& path,
+			fingerprint_t fingerprint,
+			const std::vector<Layout>& layouts,
+			const std::vector<index_t>& hessianRows,
+			const std::vector<index_t>& hessianCols);
+
+    private:
+      /// \brief Mapped file.
+      boost::scoped_ptr<boost::interprocess::mapped_region> region_;
+
+      /// \brief Jacobian layouts of the mapped file.
+      std::vector<Layout> layouts_;
+
+      /// \brief Number of structural nonzeros of the Hessian.
+      std::size_t hessianNonZeros_;
+
+      /// \brief Hessian row indices (in the mapped file).
+      const index_t* hessianRows_;
+
+      /// \brief Hessian column indices (in the mapped file).
+      const index_t* hessianCols_;
+    };
+  } // end of namespace detail.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_STRUCTURE_CACHE_HH
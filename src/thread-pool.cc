@@ -0,0 +1,175 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+
+#include <boost/bind.hpp>
+
+#include "thread-pool.hh"
+
+namespace roboptim
+{
+  namespace detail
+  {
+    ThreadPool::ThreadPool (std::size_t size)
+      : queues_ (),
+	threads_ (),
+	mutex_ (),
+	wakeUp_ (),
+	finished_ (),
+	task_ (0),
+	generation_ (0),
+	running_ (0),
+	stop_ (false),
+	error_ ()
+    {
+      if (size < 1)
+	size = 1;
+
+      for (std::size_t i = 0; i < size; ++i)
+	queues_.push_back (boost::shared_ptr<Queue> (new Queue ()));
+
+      // Worker 0 is the calling thread.
+      for (std::size_t i = 1; i < size; ++i)
+	threads_.create_thread (boost::bind (&ThreadPool::workerLoop, this, i));
+    }
+
+    ThreadPool::~ThreadPool ()
+    {
+      {
+	boost::lock_guard<boost::mutex> lock (mutex_);
+	stop_ = true;
+      }
+      wakeUp_.notify_all ();
+      threads_.join_all ();
+    }
+
+    std::size_t
+    ThreadPool::size () const
+    {
+      return queues_.size ();
+    }
+
+    void
+    ThreadPool::run (const task_t& task, const schedule_t& schedule)
+    {
+      assert (schedule.size () == queues_.size ());
+
+      for (std::size_t i = 0; i < queues_.size (); ++i)
+	{
+	  Queue& queue = *queues_[i];
+	  boost::lock_guard<boost::mutex> lock (queue.mutex);
+	  queue.tasks.assign (schedule[i].begin (), schedule[i].end ());
+	  queue.begin = 0;
+	  queue.end = queue.tasks.size ();
+	}
+
+      {
+	boost::lock_guard<boost::mutex> lock (mutex_);
+	task_ = &task;
+	error_ = boost::exception_ptr ();
+	running_ = queues_.size () - 1;
+	++generation_;
+      }
+      wakeUp_.notify_all ();
+
+      work (0);
+
+      {
+	boost::unique_lock<boost::mutex> lock (mutex_);
+	while (running_ > 0)
+	  finished_.wait (lock);
+	task_ = 0;
+      }
+
+      if (error_)
+	boost::rethrow_exception (error_);
+    }
+
+    void
+    ThreadPool::workerLoop (std::size_t worker)
+    {
+      std::size_t generation = 0;
+      for (;;)
+	{
+	  {
+	    boost::unique_lock<boost::mutex> lock (mutex_);
+	    while (!stop_ && generation == generation_)
+	      wakeUp_.wait (lock);
+	    if (stop_)
+	      return;
+	    generation = generation_;
+	  }
+
+	  work (worker);
+
+	  {
+	    boost::lock_guard<boost::mutex> lock (mutex_);
+	    --running_;
+	  }
+	  finished_.notify_one ();
+	}
+    }
+
+    void
+    ThreadPool::work (std::size_t worker)
+    {
+      std::size_t task;
+      while (pop (worker, task))
+	{
+	  try
+	    {
+	      (*task_) (task, worker);
+	    }
+	  catch (...)
+	    {
+	      boost::lock_guard<boost::mutex> lock (mutex_);
+	      if (!error_)
+		error_ = boost::current_exception ();
+	    }
+	}
+    }
+
+    bool
+    ThreadPool::pop (std::size_t worker, std::size_t& task)
+    {
+      // Own tasks first, in the scheduled order.
+      {
+	Queue& queue = *queues_[worker];
+	boost::lock_guard<boost::mutex> lock (queue.mutex);
+	if (queue.begin < queue.end)
+	  {
+	    task = queue.tasks[queue.begin++];
+	    return true;
+	  }
+      }
+
+      // Then steal the last (cheapest) tasks of the other workers.
+      for (std::size_t k = 1; k < queues_.size (); ++k)
+	{
+	  Queue& queue = *queues_[(worker + k) % queues_.size ()];
+	  boost::lock_guard<boost::mutex> lock (queue.mutex);
+	  if (queue.begin < queue.end)
+	    {
+	      task = queue.tasks[--queue.end];
+	      return true;
+	    }
+	}
+      return false;
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
@@ -0,0 +1,126 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_THREAD_POOL_HH
+# define ROBOPTIM_CORE_IPOPT_THREAD_POOL_HH
+
+# include <cstddef>
+# include <vector>
+
+# include <boost/exception_ptr.hpp>
+# include <boost/function.hpp>
+# include <boost/noncopyable.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/thread.hpp>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    /// \brief Persistent work-stealing thread pool.
+    ///
+    /// Tasks are identified by their index. Each worker owns a queue
+    /// filled from the schedule given by the caller, processes it from
+    /// the front, and steals tasks from the back of the other queues
+    /// once its own queue is empty. The calling thread takes part in
+    /// the work as worker 0, so a pool of size 1 does not spawn any
+    /// thread.
+    class ThreadPool : private boost::noncopyable
+    {
+    public:
+      /// \brief Task type, called with the task and worker indices.
+      typedef boost::function<void (std::size_t, std::size_t)> task_t;
+
+      /// \brief Tasks initially assigned to each worker.
+      typedef std::vector<std::vector<std::size_t> > schedule_t;
+
+      /// \brief Create a pool.
+      ///
+      /// \param size number of workers (calling thread included).
+      explicit ThreadPool (std::size_t size);
+
+      ~ThreadPool ();
+
+      /// \brief Number of workers (calling thread included).
+      std::size_t size () const;
+
+      /// \brief Run the tasks of a schedule and wait for them.
+      ///
+      /// The first exception thrown by a task is rethrown in the
+      /// calling thread once all the workers are done.
+      ///
+      /// \param task task to run.
+      /// \param schedule tasks assigned to each worker (one entry per
+      /// worker).
+      void run (const task_t& task, const schedule_t& schedule);
+
+    private:
+      /// \brief Tasks queue of a worker.
+      struct Queue
+      {
+	Queue ()
+	  : mutex (),
+	    tasks (),
+	    begin (0),
+	    end (0)
+	{}
+
+	boost::mutex mutex;
+	std::vector<std::size_t> tasks;
+	/// \brief Next task of the owner.
+	std::size_t begin;
+	/// \brief One past the last task (stolen first).
+	std::size_t end;
+      };
+
+      /// \brief Main loop of the spawned threads.
+      void workerLoop (std::size_t worker);
+
+      /// \brief Process tasks until all the queues are empty.
+      void work (std::size_t worker);
+
+      /// \brief Get the next task of a worker, stealing if needed.
+      bool pop (std::size_t worker, std::size_t& task);
+
+      /// \brief One queue per worker.
+      std::vector<boost::shared_ptr<Queue> > queues_;
+
+      /// \brief Spawned threads (workers 1 to size - 1).
+      boost::thread_group threads_;
+
+      boost::mutex mutex_;
+      boost::condition_variable wakeUp_;
+      boost::condition_variable finished_;
+
+      /// \brief Task being run.
+      const task_t* task_;
+      /// \brief Incremented at each run to wake the workers up.
+      std::size_t generation_;
+      /// \brief Number of spawned workers still busy.
+      std::size_t running_;
+      /// \brief Whether the threads should exit.
+      bool stop_;
+      /// \brief First exception thrown by a task.
+      boost::exception_ptr error_;
+    };
+  } // end of namespace detail.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_THREAD_POOL_HH
@@ -0,0 +1,1037 @@
+// Copyright (C) 2009 by Thomas Moulard, AIST, CNRS, INRIA.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PLUGIN_IPOPT_TNLP_SPARSE_HXX
+# define ROBOPTIM_CORE_PLUGIN_IPOPT_TNLP_SPARSE_HXX
+
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+# include <sstream>
+# include <stdexcept>
+# include <utility>
+# include <vector>
+
+# include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+# include <roboptim/core/plugin/ipopt/ipopt-sparse-td.hh>
+# include <roboptim/core/debug.hh>
+
+# include "coloring.hh"
+
+namespace roboptim
+{
+  using namespace Ipopt;
+
+  namespace detail
+  {
+    /// \internal
+    /// \brief Append the lower triangle entries of a sparse matrix.
+    template <typename M>
+    void appendLowerEntries (std::vector<Eigen::Triplet<double> >& entries,
+			     const M& h)
+    {
+      for (int k = 0; k < h.outerSize (); ++k)
+	for (typename M::InnerIterator it (h, k); it; ++it)
+	  if (it.row () >= it.col ())
+	    entries.push_back
+	      (Eigen::Triplet<double>
+	       (static_cast<int> (it.row ()), static_cast<int> (it.col ()), 1.));
+    }
+
+    /// \internal
+    /// \brief Check whether two compressed sparse matrices share the
+    /// same layout (same nonzeros, stored in the same order).
+    template <typename A, typename B>
+    bool sameLayout (const A& a, const B& b)
+    {
+      if (!a.isCompressed () || !b.isCompressed ()
+	  || a.outerSize () != b.outerSize ()
+	  || a.nonZeros () != b.nonZeros ())
+	return false;
+
+      return std::equal (a.outerIndexPtr (),
+			 a.outerIndexPtr () + a.outerSize () + 1,
+			 b.outerIndexPtr ())
+	&& std::equal (a.innerIndexPtr (),
+		       a.innerIndexPtr () + a.nonZeros (),
+		       b.innerIndexPtr ());
+    }
+
+    /// \internal
+    /// \brief Build the scatter map of a compressed sparse Hessian.
+    ///
+    /// \param scatter position map, given the layout of h: position
+    /// (plus one) of each nonzero in the Lagrangian Hessian values, 0
+    /// outside of the structure and -1 in the upper triangle.
+    /// \param h Hessian.
+    /// \param index position (plus one) of each structural nonzero.
+    template <typename S, typename M>
+    void updateHessianScatter
+    (S& scatter, const M& h,
+     const Eigen::SparseMatrix<Index, Eigen::ColMajor>& index)
+    {
+      scatter = h.template cast<Index> ();
+      Index* position = scatter.valuePtr ();
+      for (int k = 0; k < h.outerSize (); ++k)
+	for (typename M::InnerIterator it (h, k); it; ++it, ++position)
+	  *position = it.row () < it.col ()
+	    ? -1 : index.coeff (it.row (), it.col ());
+    }
+
+    /// \internal
+    /// \brief Add a weighted sparse Hessian to Lagrangian Hessian values.
+    ///
+    /// Only the lower triangle entries are considered. The values of h
+    /// are scattered with a map sharing its layout, only rebuilt when
+    /// this layout changes.
+    ///
+    /// \param values values of the Lagrangian Hessian structural nonzeros.
+    /// \param weight weight of the Hessian.
+    /// \param h Hessian (compressed by this function).
+    /// \param scatter scatter map of the last layout of h.
+    /// \param index position (plus one) of each structural nonzero.
+    /// \param outside nonzeros outside of the structure (appended).
+    /// \return false if h has a nonzero outside of the structure.
+    template <typename V, typename M, typename S>
+    bool accumulateSparseLowerTriangle
+    (V& values, double weight, M& h, S& scatter,
+     const Eigen::SparseMatrix<Index, Eigen::ColMajor>& index,
+     std::vector<std::pair<Index, Index> >& outside)
+    {
+      h.makeCompressed ();
+      if (!sameLayout (h, scatter))
+	{
+	  MallocAllowedScope allocation (true);
+	  updateHessianScatter (scatter, h, index);
+	}
+
+      const Index* position = scatter.valuePtr ();
+      const double* value = h.valuePtr ();
+      bool missing = false;
+      for (Index p = 0; p < h.nonZeros (); ++p)
+	if (position[p] > 0)
+	  values[position[p] - 1] += weight * value[p];
+	else
+	  missing = missing || (position[p] == 0 && value[p] != 0.);
+
+      if (!missing)
+	return true;
+
+      for (int k = 0, p = 0; k < h.outerSize (); ++k)
+	for (typename M::InnerIterator it (h, k); it; ++it, ++p)
+	  if (position[p] == 0 && it.value () != 0.)
+	    outside.push_back
+	      (std::make_pair (static_cast<Index> (it.row ()),
+			       static_cast<Index> (it.col ())));
+      return false;
+    }
+
+    /// \internal
+    /// \brief Check a cached compressed layout against the expected
+    /// dimensions.
+    inline bool validLayout (const StructureCache::Layout& layout,
+			     int rows, int cols, int outerSize, int innerSize)
+    {
+      if (layout.rows != rows || layout.cols != cols
+	  || layout.outerSize != outerSize
+	  || layout.outer[0] != 0 || layout.outer[outerSize] != layout.nonZeros)
+	return false;
+
+      for (int k = 0; k < outerSize; ++k)
+	{
+	  if (layout.outer[k] > layout.outer[k + 1])
+	    return false;
+
+	  // Inner indices must be sorted, as in any compressed matrix.
+	  for (int p = layout.outer[k]; p < layout.outer[k + 1]; ++p)
+	    if (layout.inner[p] < 0 || layout.inner[p] >= innerSize
+		|| (p > layout.outer[k]
+		    && layout.inner[p] <= layout.inner[p - 1]))
+	      return false;
+	}
+      return true;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupJacobianStructure (EigenMatrixSparse)
+    {
+      typedef typename solver_t::sparsityPattern_t pattern_t;
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+
+      // The structure of each constraint is directly accumulated in
+      // its Jacobian buffer.
+      constraintJacobians_.resize (constraintsTable_.size ());
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  constraintJacobians_[i].resize (constraintsTable_[i].outputSize, n);
+	  constraintJacobians_[i].setZero ();
+	}
+
+      if (solver_.jacobianSparsityPattern ())
+	{
+	  const pattern_t& pattern = *solver_.jacobianSparsityPattern ();
+	  if (pattern.rows () != constraintsOutputSize_
+	      || pattern.cols () != n)
+	    throw std::runtime_error ("invalid Jacobian sparsity pattern size");
+
+	  // Constraint owning each row.
+	  std::vector<std::size_t> rowConstraint
+	    (static_cast<std::size_t> (constraintsOutputSize_));
+	  for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	    std::fill
+	      (rowConstraint.begin () + constraintsTable_[i].offset,
+	       rowConstraint.begin () + constraintsTable_[i].offset
+	       + constraintsTable_[i].outputSize, i);
+
+	  std::vector<std::vector<Eigen::Triplet<double> > >
+	    entries (constraintsTable_.size ());
+	  for (int k = 0; k < pattern.outerSize (); ++k)
+	    for (typename pattern_t::InnerIterator it (pattern, k); it; ++it)
+	      {
+		std::size_t i =
+		  rowConstraint[static_cast<std::size_t> (it.row ())];
+		entries[i].push_back
+		  (Eigen::Triplet<double>
+		   (static_cast<int> (it.row () - constraintsTable_[i].offset),
+		    static_cast<int> (it.col ()), 1.));
+	      }
+
+	  for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	    constraintJacobians_[i].setFromTriplets
+	      (entries[i].begin (), entries[i].end ());
+	}
+      else if (!loadCachedJacobianStructure ())
+	{
+	  // A single point may miss entries which happen to be zero
+	  // there: use the union of the patterns at several points.
+	  std::vector<typename solver_t::vector_t> points;
+	  structureSamplePoints (points);
+
+	  for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	    for (std::size_t k = 0; k < points.size (); ++k)
+	      {
+		// Sparse sums keep the union of the operands structures.
+		jacobian_t& structure = constraintJacobians_[i];
+		structure =
+		  structure + constraintsTable_[i].function->jacobian (points[k]);
+	      }
+
+	  // Nonzeros missed by the sample points.
+	  for (std::size_t i = 0;
+	       !jacobianExtraEntries_.empty () && i < constraintsTable_.size ();
+	       ++i)
+	    {
+	      const ConstraintInfo& info = constraintsTable_[i];
+	      std::vector<Eigen::Triplet<double> > entries;
+	      for (std::size_t k = 0; k < jacobianExtraEntries_.size (); ++k)
+		{
+		  typename function_t::size_type row =
+		    jacobianExtraEntries_[k].first - info.offset;
+		  if (row >= 0 && row < info.outputSize)
+		    entries.push_back
+		      (Eigen::Triplet<double>
+		       (static_cast<int> (row), jacobianExtraEntries_[k].second,
+			1.));
+		}
+
+	      jacobian_t extra (info.outputSize, n);
+	      extra.setFromTriplets (entries.begin (), entries.end ());
+	      jacobian_t& structure = constraintJacobians_[i];
+	      structure = structure + extra;
+	    }
+	}
+
+      // Number the nonzeros, constraint by constraint.
+      jacobianRows_.clear ();
+      jacobianCols_.clear ();
+      jacobianIndex_.resize (constraintsTable_.size ());
+      jacobianContiguous_.resize (constraintsTable_.size ());
+      lockedJacobians_.resize (constraintsTable_.size ());
+
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  jacobian_t& jac = constraintJacobians_[i];
+	  jac.makeCompressed ();
+	  std::fill (jac.valuePtr (), jac.valuePtr () + jac.nonZeros (), 0.);
+
+	  std::vector<Eigen::Triplet<Index> > index;
+	  index.reserve (static_cast<std::size_t> (jac.nonZeros ()));
+	  for (int k = 0; k < jac.outerSize (); ++k)
+	    for (typename jacobian_t::InnerIterator it (jac, k); it; ++it)
+	      {
+		jacobianRows_.push_back
+		  (static_cast<Index> (constraintsTable_[i].offset + it.row ()));
+		jacobianCols_.push_back (static_cast<Index> (it.col ()));
+		index.push_back
+		  (Eigen::Triplet<Index>
+		   (static_cast<int> (it.row ()), static_cast<int> (it.col ()),
+		    static_cast<Index> (jacobianRows_.size ())));
+	      }
+
+	  jacobianIndex_t& positions = jacobianIndex_[i];
+	  positions.resize (jac.rows (), jac.cols ());
+	  positions.setFromTriplets (index.begin (), index.end ());
+	  positions.makeCompressed ();
+	  assert (sameLayout (jac, positions));
+	  lockedJacobians_[i] = jac;
+
+	  // Whether a plain copy of the values is enough.
+	  bool contiguous = true;
+	  for (Index k = 1; k < positions.nonZeros (); ++k)
+	    contiguous = contiguous
+	      && positions.valuePtr ()[k] == positions.valuePtr ()[k - 1] + 1;
+	  jacobianContiguous_[i] = contiguous;
+	}
+
+      setupFiniteDifferenceJacobians ();
+    }
+
+    template <typename T>
+    bool
+    Tnlp<T>::loadCachedJacobianStructure ()
+    {
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      if (!structureCache_.isLoaded ())
+	return false;
+
+      // Check everything before touching the buffers, which are
+      // expected to be empty if the structure has to be detected.
+      bool valid =
+	structureCache_.numberOfLayouts () == constraintJacobians_.size ();
+      for (std::size_t i = 0; valid && i < constraintJacobians_.size (); ++i)
+	{
+	  const jacobian_t& jac = constraintJacobians_[i];
+	  valid = validLayout
+	    (structureCache_.layout (i),
+	     static_cast<int> (jac.rows ()), static_cast<int> (jac.cols ()),
+	     static_cast<int> (jac.outerSize ()),
+	     static_cast<int> (jac.innerSize ()));
+	}
+
+      if (!valid)
+	{
+	  structureCache_.close ();
+	  return false;
+	}
+
+      for (std::size_t i = 0; i < constraintJacobians_.size (); ++i)
+	{
+	  const StructureCache::Layout& layout = structureCache_.layout (i);
+	  jacobian_t& jac = constraintJacobians_[i];
+
+	  jac.resizeNonZeros (layout.nonZeros);
+	  std::memcpy (jac.outerIndexPtr (), layout.outer,
+		       (static_cast<std::size_t> (layout.outerSize) + 1)
+		       * sizeof (StructureCache::index_t));
+	  std::memcpy (jac.innerIndexPtr (), layout.inner,
+		       static_cast<std::size_t> (layout.nonZeros)
+		       * sizeof (StructureCache::index_t));
+	}
+      return true;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::markStructureVariables (std::vector<bool>& nonlinear,
+				     EigenMatrixSparse) const
+    {
+      typedef typename function_t::gradient_t gradient_t;
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      // The Lagrangian Hessian only involves the variables of the cost
+      // and nonlinear constraints structures.
+      std::vector<typename solver_t::vector_t> points;
+      structureSamplePoints (points);
+      for (std::size_t k = 0; k < points.size (); ++k)
+	{
+	  const gradient_t gradient =
+	    solver_.problem ().function ().gradient (points[k], 0);
+	  for (typename gradient_t::InnerIterator it (gradient); it; ++it)
+	    nonlinear[static_cast<std::size_t> (it.index ())] = true;
+	}
+
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  if (constraintsTable_[i].linear)
+	    continue;
+
+	  const jacobian_t& jac = lockedJacobians_[i];
+	  for (int k = 0; k < jac.outerSize (); ++k)
+	    for (typename jacobian_t::InnerIterator it (jac, k); it; ++it)
+	      nonlinear[static_cast<std::size_t> (it.col ())] = true;
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::jacobianLayouts (std::vector<StructureCache::Layout>& layouts,
+			      EigenMatrixSparse) const
+    {
+      layouts.resize (constraintJacobians_.size ());
+      for (std::size_t i = 0; i < constraintJacobians_.size (); ++i)
+	{
+	  const typename function_t::jacobian_t& jac = constraintJacobians_[i];
+	  assert (jac.isCompressed ());
+
+	  StructureCache::Layout& layout = layouts[i];
+	  layout.rows = static_cast<StructureCache::index_t> (jac.rows ());
+	  layout.cols = static_cast<StructureCache::index_t> (jac.cols ());
+	  layout.outerSize =
+	    static_cast<StructureCache::index_t> (jac.outerSize ());
+	  layout.nonZeros =
+	    static_cast<StructureCache::index_t> (jac.nonZeros ());
+	  layout.outer = jac.outerIndexPtr ();
+	  layout.inner = jac.innerIndexPtr ();
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupLinearJacobians (EigenMatrixSparse)
+    {
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      typename function_t::vector_t
+	x = function_t::vector_t::Zero
+	(solver_.problem ().function ().inputSize ());
+
+      // Any point will do. The values are checked against the locked
+      // layout like any other evaluation.
+      taskX_ = x.data ();
+      std::vector<Eigen::Triplet<double> > entries;
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  const ConstraintInfo& info = constraintsTable_[i];
+	  if (!info.linear)
+	    continue;
+
+	  evalConstraintJacobian (i, 0, EigenMatrixSparse ());
+
+	  const jacobian_t& jac = constraintJacobians_[i];
+	  for (int k = 0; k < jac.outerSize (); ++k)
+	    for (typename jacobian_t::InnerIterator it (jac, k); it; ++it)
+	      entries.push_back
+		(Eigen::Triplet<double>
+		 (static_cast<int> (info.offset + it.row ()),
+		  static_cast<int> (it.col ()), it.value ()));
+	}
+      taskX_ = 0;
+
+      setupLinearConstraints (entries);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::restoreLinearJacobian (std::size_t, EigenMatrixSparse)
+    {
+      // Linear constraints values stay in their Jacobian buffer.
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupFiniteDifferenceJacobians ()
+    {
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      finiteDifferenceColorings_.clear ();
+      if (!pluginParameter (solver_, "ipopt.plugin.finite_difference_jacobians",
+			    false))
+	return;
+
+      finiteDifferenceStep_ =
+	pluginParameter (solver_, "ipopt.plugin.finite_difference_step", 1e-8);
+
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+      int cols = static_cast<int> (n);
+      typename function_t::size_type outputSize = 0;
+
+      finiteDifferenceColorings_.resize (constraintsTable_.size ());
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  const ConstraintInfo& info = constraintsTable_[i];
+	  if (info.linear)
+	    continue;
+	  outputSize = std::max (outputSize, info.outputSize);
+
+	  // Structural nonzeros in compressed row storage, with their
+	  // position in the compressed values of the Jacobian buffer.
+	  const jacobian_t& jac = constraintJacobians_[i];
+	  std::size_t nnz = static_cast<std::size_t> (jac.nonZeros ());
+	  std::vector<int> rowOffsets
+	    (static_cast<std::size_t> (info.outputSize) + 1, 0);
+	  std::vector<int> rowColumns (nnz);
+	  std::vector<int> rowPositions (nnz);
+
+	  for (int k = 0; k < jac.outerSize (); ++k)
+	    for (typename jacobian_t::InnerIterator it (jac, k); it; ++it)
+	      ++rowOffsets[static_cast<std::size_t> (it.row ()) + 1];
+	  for (std::size_t r = 0; r + 1 < rowOffsets.size (); ++r)
+	    rowOffsets[r + 1] += rowOffsets[r];
+
+	  std::vector<int> next (rowOffsets.begin (), rowOffsets.end () - 1);
+	  int position = 0;
+	  for (int k = 0; k < jac.outerSize (); ++k)
+	    for (typename jacobian_t::InnerIterator it (jac, k); it;
+		 ++it, ++position)
+	      {
+		int p = next[static_cast<std::size_t> (it.row ())]++;
+		rowColumns[p] = static_cast<int> (it.col ());
+		rowPositions[p] = position;
+	      }
+
+	  std::vector<int> colors;
+	  int count = columnColoring (cols, rowOffsets, rowColumns, colors);
+
+	  // Group the columns by color, and the nonzeros by column.
+	  FiniteDifferenceColoring& coloring = finiteDifferenceColorings_[i];
+	  coloring.colorOffsets.assign (static_cast<std::size_t> (count) + 1, 0);
+	  for (int j = 0; j < cols; ++j)
+	    if (colors[j] >= 0)
+	      ++coloring.colorOffsets[static_cast<std::size_t> (colors[j]) + 1];
+	  for (int c = 0; c < count; ++c)
+	    coloring.colorOffsets[c + 1] += coloring.colorOffsets[c];
+	  coloring.colorColumns.resize
+	    (static_cast<std::size_t> (coloring.colorOffsets.back ()));
+	  next.assign (coloring.colorOffsets.begin (),
+		       coloring.colorOffsets.end () - 1);
+	  for (int j = 0; j < cols; ++j)
+	    if (colors[j] >= 0)
+	      coloring.colorColumns[next[colors[j]]++] = j;
+
+	  coloring.columnOffsets.assign (static_cast<std::size_t> (cols) + 1, 0);
+	  for (std::size_t p = 0; p < nnz; ++p)
+	    ++coloring.columnOffsets[static_cast<std::size_t> (rowColumns[p]) + 1];
+	  for (int j = 0; j < cols; ++j)
+	    coloring.columnOffsets[j + 1] += coloring.columnOffsets[j];
+	  coloring.columnRows.resize (nnz);
+	  coloring.columnPositions.resize (nnz);
+	  next.assign (coloring.columnOffsets.begin (),
+		       coloring.columnOffsets.end () - 1);
+	  for (std::size_t r = 0; r + 1 < rowOffsets.size (); ++r)
+	    for (int p = rowOffsets[r]; p < rowOffsets[r + 1]; ++p)
+	      {
+		int q = next[rowColumns[p]]++;
+		coloring.columnRows[q] = static_cast<int> (r);
+		coloring.columnPositions[q] = rowPositions[p];
+	      }
+	}
+
+      std::size_t workers = threadPool_ ? threadPool_->size () : 1;
+      finiteDifferenceArguments_.resize (workers);
+      finiteDifferenceReferences_.resize (workers);
+      finiteDifferenceValues_.resize (workers);
+      for (std::size_t w = 0; w < workers; ++w)
+	{
+	  finiteDifferenceArguments_[w].resize (n);
+	  finiteDifferenceReferences_[w].resize (outputSize);
+	  finiteDifferenceValues_[w].resize (outputSize);
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalFiniteDifferenceJacobian (std::size_t constraint,
+					   std::size_t worker)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+      const FiniteDifferenceColoring&
+	coloring = finiteDifferenceColorings_[constraint];
+
+      Eigen::Map<const typename function_t::vector_t>
+	x_ (taskX_, solver_.problem ().function ().inputSize ());
+      typename function_t::vector_t&
+	argument = finiteDifferenceArguments_[worker];
+      typename function_t::vector_t&
+	reference = finiteDifferenceReferences_[worker];
+      typename function_t::vector_t& value = finiteDifferenceValues_[worker];
+      double* jacobian = constraintJacobians_[constraint].valuePtr ();
+
+      argument = x_;
+      if (finiteDifferenceReference_)
+	reference.head (info.outputSize) =
+	  Eigen::Map<const typename function_t::vector_t>
+	  (finiteDifferenceReference_ + info.offset, info.outputSize);
+      else
+	(*info.function) (reference.head (info.outputSize), argument);
+
+      // Forward differences, one evaluation per color.
+      for (std::size_t c = 0; c + 1 < coloring.colorOffsets.size (); ++c)
+	{
+	  for (int p = coloring.colorOffsets[c];
+	       p < coloring.colorOffsets[c + 1]; ++p)
+	    {
+	      int j = coloring.colorColumns[p];
+	      argument[j] += finiteDifferenceStep_
+		* std::max (1., std::abs (argument[j]));
+	    }
+
+	  (*info.function) (value.head (info.outputSize), argument);
+
+	  for (int p = coloring.colorOffsets[c];
+	       p < coloring.colorOffsets[c + 1]; ++p)
+	    {
+	      int j = coloring.colorColumns[p];
+	      // Actual (representable) step.
+	      double step = argument[j] - x_[j];
+	      for (int q = coloring.columnOffsets[j];
+		   q < coloring.columnOffsets[j + 1]; ++q)
+		{
+		  int r = coloring.columnRows[q];
+		  jacobian[coloring.columnPositions[q]] =
+		    (value[r] - reference[r]) / step;
+		}
+	      argument[j] = x_[j];
+	    }
+	}
+    }
+
+    template <typename T>
+    Index
+    Tnlp<T>::jacobianNonZeros (EigenMatrixSparse)
+    {
+      return static_cast<Index> (jacobianRows_.size ());
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalConstraintJacobian (std::size_t constraint,
+				     std::size_t worker, EigenMatrixSparse)
+    {
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      const ConstraintInfo& info = constraintsTable_[constraint];
+      if (!finiteDifferenceColorings_.empty () && !info.linear)
+	{
+	  evalFiniteDifferenceJacobian (constraint, worker);
+	  return;
+	}
+
+      const jacobianIndex_t& positions = jacobianIndex_[constraint];
+
+      Eigen::Map<const typename function_t::vector_t>
+	x_ (taskX_, solver_.problem ().function ().inputSize ());
+
+      // The Jacobian buffer has the layout locked by the structure
+      // pass: set its values to 0 while keeping this layout.
+      jacobian_t& jac = constraintJacobians_[constraint];
+      assert (sameLayout (jac, positions));
+      std::fill (jac.valuePtr (), jac.valuePtr () + jac.nonZeros (), 0.);
+
+      info.function->jacobian (jac, x_);
+
+      IpoptCheckGradient
+	(*info.function, 0, x_, static_cast<int> (constraint), solver_);
+
+      if (sameLayout (jac, positions))
+	return;
+
+      // The function did not keep the layout: move its values back to
+      // the locked layout, which must contain all its nonzeros. Inner
+      // indices are sorted in both layouts: each outer vector is
+      // merged in a single pass.
+      jacobian_t& locked = lockedJacobians_[constraint];
+      assert (sameLayout (locked, positions));
+      double* value = locked.valuePtr ();
+      const int* outer = positions.outerIndexPtr ();
+      const int* inner = positions.innerIndexPtr ();
+
+      structureEntries_t outside;
+      for (int k = 0; k < jac.outerSize (); ++k)
+	{
+	  int p = outer[k];
+	  for (typename jacobian_t::InnerIterator it (jac, k); it; ++it)
+	    {
+	      while (p < outer[k + 1] && inner[p] < it.index ())
+		++p;
+
+	      if (p < outer[k + 1] && inner[p] == it.index ())
+		value[p] = it.value ();
+	      else if (it.value () != 0.)
+		outside.push_back
+		  (std::make_pair
+		   (static_cast<Index> (info.offset + it.row ()),
+		    static_cast<Index> (it.col ())));
+	    }
+	}
+
+      // Copying into the function buffer keeps the locked buffer for
+      // the next evaluations, without allocation once the function
+      // buffer is large enough.
+      jac = locked;
+      std::fill (value, value + locked.nonZeros (), 0.);
+
+      if (!outside.empty ())
+	jacobianStructureError (constraint, outside);
+    }
+
+    template <typename T>
+    bool
+    Tnlp<T>::evalJacobian (Index n, const Number* x, bool new_x,
+			   Index ROBOPTIM_DEBUG_ONLY(m),
+			   Index ROBOPTIM_DEBUG_ONLY(nele_jac),
+			   Index* iRow, Index *jCol,
+			   Number* values, EigenMatrixSparse)
+    {
+      typedef typename function_t::size_type size_type;
+      typedef typename function_t::jacobian_t jacobian_t;
+
+      ROBOPTIM_DEBUG_ONLY (size_type n_ = static_cast<size_type> (n));
+      assert (solver_.problem ().function ().inputSize () == n_);
+      assert (constraintsOutputSize () == m);
+
+      assert (jacobianRows_.size () == static_cast<std::size_t> (nele_jac));
+
+      if (!values)
+	{
+	  // The structure has been computed by get_nlp_info.
+	  std::copy (jacobianRows_.begin (), jacobianRows_.end (), iRow);
+	  std::copy (jacobianCols_.begin (), jacobianCols_.end (), jCol);
+	  return true;
+	}
+
+      updateIterate (n, x, new_x);
+      if (!isCached (IpoptCacheStatistics::CONSTRAINTS_JACOBIAN))
+	{
+	  // Finite differences start from the constraints values if
+	  // they are known at this point.
+	  finiteDifferenceReference_ =
+	    cache_.valid[IpoptCacheStatistics::CONSTRAINTS]
+	    ? constraints_->data () : 0;
+
+	  // A nonzero outside of the Jacobian pattern is reported as a
+	  // solver error.
+	  try
+	    {
+	      MallocAllowedScope allocation (false);
+	      taskX_ = x;
+	      runConstraintsTask (evalConstraintJacobianTask_,
+				  jacobiansCost_);
+	    }
+	  catch (const std::runtime_error& error)
+	    {
+	      return reportError (error);
+	    }
+	  setCached (IpoptCacheStatistics::CONSTRAINTS_JACOBIAN);
+	}
+
+      // Scatter the constraint Jacobians in Ipopt's values. Their
+      // layout is locked by evalConstraintJacobian.
+      for (std::size_t i = 0; i < constraintJacobians_.size (); ++i)
+	{
+	  const jacobian_t& jac = constraintJacobians_[i];
+	  const jacobianIndex_t& positions = jacobianIndex_[i];
+	  const Index* scatter = positions.valuePtr ();
+	  std::size_t nnz = static_cast<std::size_t> (positions.nonZeros ());
+
+	  assert (sameLayout (jac, positions));
+	  if (nnz == 0)
+	    continue;
+
+	  if (jacobianContiguous_[i])
+	    std::memcpy (values + scatter[0] - 1, jac.valuePtr (),
+			 nnz * sizeof (Number));
+	  else
+	    for (std::size_t k = 0; k < nnz; ++k)
+	      values[scatter[k] - 1] = jac.valuePtr ()[k];
+	}
+
+      return true;
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverSparseTd>::setupHessianStructure ()
+    {
+      typedef Eigen::Triplet<double> triplet_t;
+      typedef solver_t::sparsityPattern_t pattern_t;
+
+      function_t::size_type n = solver_.problem ().function ().inputSize ();
+
+      if (!loadCachedHessianStructure ())
+	{
+	  // Lower triangle structural nonzeros (duplicates allowed).
+	  std::vector<triplet_t> entries;
+
+	  if (solver_.hessianSparsityPattern ())
+	    {
+	      const pattern_t& pattern = *solver_.hessianSparsityPattern ();
+	      if (pattern.rows () != n || pattern.cols () != n)
+		throw std::runtime_error
+		  ("invalid Hessian sparsity pattern size");
+
+	      for (int k = 0; k < pattern.outerSize (); ++k)
+		for (pattern_t::InnerIterator it (pattern, k); it; ++it)
+		  entries.push_back
+		    (triplet_t
+		     (static_cast<int> (std::max (it.row (), it.col ())),
+		      static_cast<int> (std::min (it.row (), it.col ())), 1.));
+	    }
+	  else
+	    {
+	      std::vector<solver_t::vector_t> points;
+	      structureSamplePoints (points);
+
+	      function_t::hessian_t h (n, n);
+	      for (std::size_t k = 0; k < points.size (); ++k)
+		{
+		  h.setZero ();
+		  solver_.problem ().function ().hessian (h, points[k], 0);
+		  appendLowerEntries (entries, h);
+
+		  typedef constraintsTable_t::const_iterator citer_t;
+		  // Linear constraints have no Hessian.
+		  for (citer_t it = constraintsTable_.begin ();
+		       it != constraintsTable_.end (); ++it)
+		    for (function_t::size_type r = 0;
+			 !it->linear && r < it->outputSize; ++r)
+		      {
+			h.setZero ();
+			it->function->hessian (h, points[k], r);
+			appendLowerEntries (entries, h);
+		      }
+		}
+
+	      // Nonzeros missed by the sample points.
+	      for (std::size_t k = 0; k < hessianExtraEntries_.size (); ++k)
+		entries.push_back
+		  (triplet_t (hessianExtraEntries_[k].first,
+			      hessianExtraEntries_[k].second, 1.));
+	    }
+
+	  pattern_t lower (n, n);
+	  lower.setFromTriplets (entries.begin (), entries.end ());
+
+	  hessianRows_.clear ();
+	  hessianCols_.clear ();
+	  hessianRows_.reserve (static_cast<std::size_t> (lower.nonZeros ()));
+	  hessianCols_.reserve (static_cast<std::size_t> (lower.nonZeros ()));
+	  for (int k = 0; k < lower.outerSize (); ++k)
+	    for (pattern_t::InnerIterator it (lower, k); it; ++it)
+	      {
+		hessianRows_.push_back (static_cast<Index> (it.row ()));
+		hessianCols_.push_back (static_cast<Index> (it.col ()));
+	      }
+	}
+
+      std::vector<Eigen::Triplet<Index> > index;
+      index.reserve (hessianRows_.size ());
+      for (std::size_t k = 0; k < hessianRows_.size (); ++k)
+	index.push_back
+	  (Eigen::Triplet<Index>
+	   (hessianRows_[k], hessianCols_[k], static_cast<Index> (k + 1)));
+
+      hessianIndex_.resize (n, n);
+      hessianIndex_.setFromTriplets (index.begin (), index.end ());
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverSparseTd>::detectNonlinearVariables
+    (std::vector<bool>& nonlinear) const
+    {
+      markHessianVariables (nonlinear);
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverSparseTd>::setupHessianEvaluation ()
+    {
+      function_t::size_type n = solver_.problem ().function ().inputSize ();
+      std::size_t workers = threadPool_ ? threadPool_->size () : 1;
+
+      cacheHessians_ =
+	pluginParameter (solver_, "ipopt.plugin.cache_hessians", true);
+
+      hessiansCost_ = constraintsCost_;
+      hessianWeightsCost_ = constraintsCost_;
+      costHessian_.resize (n, n);
+      setupHessianStructure ();
+
+      hessianValues_.resize (workers);
+      for (std::size_t w = 0; w < workers; ++w)
+	hessianValues_[w].resize
+	  (static_cast<function_t::size_type> (hessianRows_.size ()));
+
+      // Either keep the Hessian of every constraint row, or a single
+      // buffer per worker.
+      std::size_t buffers = cacheHessians_
+	? static_cast<std::size_t> (constraintsOutputSize_) : 0;
+      constraintHessians_.resize (buffers);
+      typedef constraintsTable_t::const_iterator citer_t;
+      for (citer_t it = constraintsTable_.begin ();
+	   cacheHessians_ && it != constraintsTable_.end (); ++it)
+	{
+	  // Linear constraints have no Hessian to keep.
+	  function_t::size_type size = it->linear ? 0 : n;
+	  for (function_t::size_type r = 0; r < it->outputSize; ++r)
+	    constraintHessians_[static_cast<std::size_t> (it->offset + r)]
+	      .resize (size, size);
+	}
+
+      buffers = cacheHessians_ ? 0 : workers;
+      hessianScratch_.resize (buffers);
+      for (std::size_t w = 0; w < buffers; ++w)
+	hessianScratch_[w].resize (n, n);
+
+      // Scatter maps of each constraint row Hessian, then of the
+      // objective Hessian, built on their first evaluation.
+      hessianScatter_.assign
+	(static_cast<std::size_t> (constraintsOutputSize_) + 1,
+	 jacobianIndex_t ());
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverSparseTd>::evalConstraintHessianTask
+    (std::size_t constraint, std::size_t worker)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+
+      // Linear constraints do not contribute to the Hessian.
+      if (info.linear)
+	return;
+
+      Eigen::Map<const function_t::argument_t>
+	x_ (taskX_, solver_.problem ().function ().inputSize ());
+
+      for (function_t::size_type r = 0; r < info.outputSize; ++r)
+	{
+	  std::size_t row = static_cast<std::size_t> (info.offset + r);
+
+	  // A cached Hessian is set to 0 while keeping its structure. The
+	  // shared scratch is emptied instead, keeping its capacity: the
+	  // union of the previous rows layouts would not match the
+	  // scatter map of this row.
+	  function_t::hessian_t& h = cacheHessians_
+	    ? constraintHessians_[row] : hessianScratch_[worker];
+	  if (cacheHessians_)
+	    h *= 0.;
+	  else
+	    h.setZero ();
+	  info.function->hessian (h, x_, r);
+
+	  structureEntries_t outside;
+	  if (!accumulateSparseLowerTriangle
+	      (hessianValues_[worker], taskLambda_[row], h,
+	       hessianScatter_[row], hessianIndex_, outside))
+	    hessianStructureError (info.function->getName (),
+				   static_cast<int> (constraint), r, outside);
+	}
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverSparseTd>::weightConstraintHessianTask
+    (std::size_t constraint, std::size_t worker)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+
+      // Linear constraints do not contribute to the Hessian.
+      if (info.linear)
+	return;
+
+      // Cached Hessians have been checked when evaluated.
+      structureEntries_t outside;
+      for (function_t::size_type r = 0; r < info.outputSize; ++r)
+	{
+	  std::size_t row = static_cast<std::size_t> (info.offset + r);
+	  accumulateSparseLowerTriangle
+	    (hessianValues_[worker], taskLambda_[row],
+	     constraintHessians_[row], hessianScatter_[row], hessianIndex_,
+	     outside);
+	}
+    }
+
+    template <>
+    inline bool
+    Tnlp<IpoptSolverSparseTd>::eval_h
+    (Index n, const Number* x, bool new_x,
+     Number obj_factor, Index ROBOPTIM_DEBUG_ONLY(m), const Number* lambda,
+     bool, Index nele_hess, Index* iRow,
+     Index* jCol, Number* values)
+    {
+      ROBOPTIM_DEBUG_ONLY(function_t::size_type n_ = static_cast<function_t::size_type> (n));
+
+      assert (solver_.problem ().function ().inputSize () == n_);
+      assert (constraintsOutputSize () == m);
+      assert (hessianRows_.size () == static_cast<std::size_t> (nele_hess));
+
+      if (!values)
+	{
+	  std::copy (hessianRows_.begin (), hessianRows_.end (), iRow);
+	  std::copy (hessianCols_.begin (), hessianCols_.end (), jCol);
+	  return true;
+	}
+
+      updateIterate (n, x, new_x);
+
+      for (std::size_t w = 0; w < hessianValues_.size (); ++w)
+	hessianValues_[w].setZero ();
+
+      taskX_ = x;
+      taskLambda_ = lambda;
+
+      try
+	{
+	  MallocAllowedScope allocation (false);
+
+	  // Without cached Hessians, there is no cache lookup to count.
+	  if (cacheHessians_ && isCached (IpoptCacheStatistics::HESSIANS))
+	    runConstraintsTask
+	      (weightConstraintHessianTask_, hessianWeightsCost_);
+	  else
+	    {
+	      runConstraintsTask (evalConstraintHessianTask_, hessiansCost_);
+
+	      Eigen::Map<const solver_t::vector_t> x_ (x, n);
+	      costHessian_ *= 0.;
+	      solver_.problem ().function ().hessian (costHessian_, x_, 0);
+
+	      if (cacheHessians_)
+		setCached (IpoptCacheStatistics::HESSIANS);
+	    }
+
+	  Eigen::Map<function_t::vector_t> values_ (values, nele_hess);
+	  values_.setZero ();
+
+	  structureEntries_t outside;
+	  if (!accumulateSparseLowerTriangle
+	      (values_, obj_factor, costHessian_, hessianScatter_.back (),
+	       hessianIndex_, outside))
+	    hessianStructureError
+	      (solver_.problem ().function ().getName (), -1, 0, outside);
+
+	  for (std::size_t w = 0; w < hessianValues_.size (); ++w)
+	    values_ += hessianValues_[w];
+	}
+      catch (const std::runtime_error& error)
+	{
+	  return reportError (error);
+	}
+
+      return true;
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_PLUGIN_IPOPT_TNLP_SPARSE_HXX
@@ -18,10 +18,16 @@
 #ifndef ROBOPTIM_CORE_IPOPT_TNLP_HH
 # define ROBOPTIM_CORE_IPOPT_TNLP_HH
 
+# include <algorithm>
+# include <string>
+# include <utility>
 # include <vector>
 
+# include <boost/date_time/posix_time/posix_time_types.hpp>
 # include <boost/mpl/at.hpp>
 # include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/mutex.hpp>
 
 # include <coin/IpSmartPtr.hpp>
 # include <coin/IpIpoptApplication.hpp>
@@ -29,6 +35,10 @@
 # include <roboptim/core/plugin/ipopt/ipopt.hh>
 # include <roboptim/core/solver-state.hh>
 
+# include "checkpoint.hh"
+# include "structure-cache.hh"
+# include "thread-pool.hh"
+
 #ifdef ROBOPTIM_CORE_IPOPT_PLUGIN_CHECK_GRADIENT
 # include <boost/format.hpp>
 # include <roboptim/core/finite-difference-gradient.hh>
@@ -79,7 +89,7 @@ namespace roboptim
       get_starting_point (Index n, bool init_x, Number* x,
                           bool init_z, Number* z_L, Number* z_U,
                           Index m, bool init_lambda,
-                          Number*);
+                          Number* lambda);
 
       virtual bool
       get_warm_start_iterate (Ipopt::IteratesVector&);
@@ -107,8 +117,8 @@ namespace roboptim
 
       virtual void
       finalize_solution(Ipopt::SolverReturn status,
-                        Index n, const Number* x, const Number*,
-                        const Number*, Index m, const Number* g,
+                        Index n, const Number* x, const Number* z_L,
+                        const Number* z_U, Index m, const Number* g,
                         const Number* lambda, Number obj_value,
                         const Ipopt::IpoptData*,
                         Ipopt::IpoptCalculatedQuantities*);
@@ -132,11 +142,370 @@ namespace roboptim
                                        Index*);
 
     protected:
-      void compute_hessian (TwiceDifferentiableFunction::hessian_t& h,
-			    const typename solver_t::vector_t& x,
+      /// \brief Compute the values of the Lagrangian Hessian structural
+      /// nonzeros (ipopt-td only).
+      void compute_hessian (Number* values,
+			    Index n, const Number* x,
 			    Number obj_factor,
 			    const Number* lambda);
 
+      /// \brief Compute the lower-triangular Lagrangian Hessian from
+      /// differences of gradients (ipopt-td only).
+      ///
+      /// One Lagrangian gradient is evaluated at x, and one at x plus
+      /// the steps of the variables of each color of the star coloring
+      /// of the Hessian structure.
+      void computeFiniteDifferenceHessian
+      (Number* values,
+       Index n, const Number* x,
+       Number obj_factor,
+       const Number* lambda);
+
+      /// \brief Color the Lagrangian Hessian structure for finite
+      /// differences of gradients (ipopt-td only, if enabled).
+      void setupFiniteDifferenceHessian ();
+
+      /// \brief Add the constraint Jacobians transposed products with
+      /// their multipliers, at x and at each colored step, to the
+      /// products of the worker.
+      void evalFiniteDifferenceHessianTask (std::size_t constraint,
+					    std::size_t worker);
+
+      /// \brief Build the table of constraints.
+      ///
+      /// Resolve the constraints variant once, so that evaluation
+      /// callbacks do not have to.
+      void buildConstraintsTable ();
+
+      /// \brief Compute the constraints Jacobian structure (dense
+      /// case, nothing to do).
+      void setupJacobianStructure (EigenMatrixDense);
+
+      /// \brief Compute the constraints Jacobian structure (sparse
+      /// case).
+      ///
+      /// Uses the user-declared pattern if any, otherwise the union of
+      /// the constraints Jacobians patterns at the structure sample
+      /// points and of the nonzeros previous solves found outside of
+      /// it. The structure is then frozen for the solve.
+      void setupJacobianStructure (EigenMatrixSparse);
+
+      /// \brief Fingerprint of the problem structure.
+      ///
+      /// Problem fingerprint of the solver, combined with the structure
+      /// detection parameters.
+      StructureCache::fingerprint_t structureFingerprint () const;
+
+      /// \brief Map the structure cache file of the problem.
+      ///
+      /// Reads the ipopt.plugin.structure_cache parameter. The cache is
+      /// not used if the user declared a sparsity pattern.
+      void openStructureCache ();
+
+      /// \brief Write the detected structures to the cache file if it
+      /// was missing or invalid, then unmap it.
+      void saveStructureCache ();
+
+      /// \brief Read the checkpoint parameters and reset the
+      /// checkpoint timers.
+      ///
+      /// Called at the beginning of each solve, see beginSolve.
+      void setupCheckpoint (Index n, Index m);
+
+      /// \brief Save the current iterate to the checkpoint file if a
+      /// checkpoint is due.
+      ///
+      /// The iterate is unscaled and expressed in the problem variables
+      /// and constraints, as in finalize_solution.
+      void checkpoint (Ipopt::AlgorithmMode mode, Index iteration,
+		       const Ipopt::IpoptData* ip_data,
+		       Ipopt::IpoptCalculatedQuantities* ip_cq);
+
+      /// \brief Restore the constraints Jacobians layouts from the
+      /// structure cache.
+      ///
+      /// \return whether the cache held valid layouts.
+      bool loadCachedJacobianStructure ();
+
+      /// \brief Restore the Lagrangian Hessian structure from the
+      /// structure cache.
+      ///
+      /// \return whether the cache held a valid structure.
+      bool loadCachedHessianStructure ();
+
+      /// \brief Constraints Jacobians layouts to cache (dense case,
+      /// none).
+      void jacobianLayouts (std::vector<StructureCache::Layout>& layouts,
+			    EigenMatrixDense) const;
+
+      /// \brief Constraints Jacobians layouts to cache (sparse case).
+      void jacobianLayouts (std::vector<StructureCache::Layout>& layouts,
+			    EigenMatrixSparse) const;
+
+      /// \brief Number of structural nonzeros of the constraints
+      /// Jacobian (dense case).
+      Index jacobianNonZeros (EigenMatrixDense);
+
+      /// \brief Number of structural nonzeros of the constraints
+      /// Jacobian (sparse case).
+      Index jacobianNonZeros (EigenMatrixSparse);
+
+      /// \brief Implementation of eval_jac_g (dense case).
+      bool evalJacobian (Index n, const Number* x, bool new_x,
+			 Index m, Index nele_jac, Index* iRow,
+			 Index *jCol, Number* values, EigenMatrixDense);
+
+      /// \brief Implementation of eval_jac_g (sparse case).
+      bool evalJacobian (Index n, const Number* x, bool new_x,
+			 Index m, Index nele_jac, Index* iRow,
+			 Index *jCol, Number* values, EigenMatrixSparse);
+
+      /// \brief Evaluate a constraint Jacobian in the task output
+      /// buffer (dense case).
+      void evalConstraintJacobian (std::size_t constraint,
+				   std::size_t worker, EigenMatrixDense);
+
+      /// \brief Evaluate a constraint Jacobian in its constraint
+      /// Jacobian buffer (sparse case).
+      ///
+      /// Uses compressed finite differences if they are enabled.
+      void evalConstraintJacobian (std::size_t constraint,
+				   std::size_t worker, EigenMatrixSparse);
+
+      /// \brief Color the constraints Jacobians structures for
+      /// compressed finite differences (sparse case only).
+      ///
+      /// Reads the ipopt.plugin.finite_difference_jacobians and
+      /// ipopt.plugin.finite_difference_step parameters.
+      void setupFiniteDifferenceJacobians ();
+
+      /// \brief Evaluate a nonlinear constraint Jacobian by compressed
+      /// finite differences in its constraint Jacobian buffer (sparse
+      /// case only).
+      ///
+      /// The columns of a color are perturbed together, so the
+      /// Jacobian costs one evaluation of the constraint per color
+      /// (plus one for the reference point if the constraints values
+      /// are not known).
+      void evalFiniteDifferenceJacobian (std::size_t constraint,
+					 std::size_t worker);
+
+      /// \brief Evaluate the constant Jacobians of the linear
+      /// constraints (dense case).
+      ///
+      /// They are kept in dedicated buffers and copied to Ipopt's
+      /// values afterwards.
+      void setupLinearJacobians (EigenMatrixDense);
+
+      /// \brief Evaluate the constant Jacobians of the linear
+      /// constraints (sparse case).
+      ///
+      /// Their values stay in the constraint Jacobian buffers, which
+      /// are not evaluated again.
+      void setupLinearJacobians (EigenMatrixSparse);
+
+      /// \brief Stack the linear constraints for their batched
+      /// evaluation.
+      ///
+      /// \param entries nonzeros of the linear constraints Jacobians,
+      /// in the rows of the constraints vector.
+      void setupLinearConstraints
+      (const std::vector<Eigen::Triplet<double> >& entries);
+
+      /// \brief Copy a linear constraint Jacobian in the task output
+      /// buffer (dense case).
+      void restoreLinearJacobian (std::size_t constraint, EigenMatrixDense);
+
+      /// \brief Restore a linear constraint Jacobian (sparse case,
+      /// nothing to do).
+      void restoreLinearJacobian (std::size_t constraint, EigenMatrixSparse);
+
+      /// \brief Set up the parallel evaluation of the constraints.
+      ///
+      /// Reads the ipopt.plugin.eval_threads parameter and (re)creates
+      /// the thread pool if needed.
+      void setupParallelEvaluation ();
+
+      /// \brief Run a per-constraint task on every constraint.
+      ///
+      /// Tasks are distributed among the thread pool workers when
+      /// parallel evaluation is enabled, and run sequentially
+      /// otherwise.
+      ///
+      /// \param task task called with the constraint index.
+      /// \param costs estimated cost of the task for each constraint,
+      /// updated with the measured evaluation times.
+      void runConstraintsTask (const ThreadPool::task_t& task,
+			       std::vector<double>& costs);
+
+      /// \brief Distribute the constraints among the workers.
+      ///
+      /// Longest processing time first: constraints are sorted by
+      /// decreasing estimated cost and assigned to the least loaded
+      /// worker. Workers then steal work from each other to absorb
+      /// estimation errors.
+      void scheduleConstraints (const std::vector<double>& costs);
+
+      /// \brief Run the current task and measure its duration.
+      void timedConstraintTask (std::size_t constraint, std::size_t worker);
+
+      /// \brief Evaluate a constraint in the task output buffer.
+      void evalConstraintTask (std::size_t constraint, std::size_t worker);
+
+      /// \brief Evaluate a constraint Jacobian.
+      ///
+      /// Dense Jacobians are written in the task output buffer, sparse
+      /// ones in the constraint Jacobian buffers. Linear constraints
+      /// Jacobians are not evaluated again.
+      void evalConstraintJacobianTask (std::size_t constraint,
+				       std::size_t worker);
+
+      /// \brief Set up the Lagrangian Hessian buffers.
+      ///
+      /// Buffers are allocated once per solve (only for twice
+      /// differentiable problems).
+      void setupHessianEvaluation ();
+
+      /// \brief Compute the points at which sparsity patterns are
+      /// detected.
+      ///
+      /// The first point is the starting point (or zero), the others
+      /// are deterministic random perturbations of it. All of them are
+      /// projected inside the argument bounds.
+      ///
+      /// \param points sample points (output).
+      void structureSamplePoints
+      (std::vector<typename solver_t::vector_t>& points) const;
+
+      /// \brief Find the variables which appear nonlinearly in the
+      /// problem.
+      ///
+      /// Reads the ipopt.plugin.linear_variables parameter. Uses the
+      /// user-declared Hessian pattern if any, otherwise
+      /// detectNonlinearVariables.
+      void setupNonlinearVariables ();
+
+      /// \brief Detect the variables which appear nonlinearly.
+      ///
+      /// Twice differentiable problems use the Lagrangian Hessian
+      /// structure. Otherwise, markStructureVariables is used, unless
+      /// ipopt.plugin.sample_linear_variables is set: a variable is
+      /// then nonlinear if the cost or nonlinear constraints
+      /// derivatives with respect to it differ between the structure
+      /// sample points.
+      ///
+      /// \param nonlinear flag of each variable (output, only set to
+      /// true).
+      void detectNonlinearVariables (std::vector<bool>& nonlinear) const;
+
+      /// \brief Mark the variables involved in the lower-triangular
+      /// Lagrangian Hessian structure.
+      ///
+      /// \param nonlinear flag of each variable (output, only set to
+      /// true).
+      void markHessianVariables (std::vector<bool>& nonlinear) const;
+
+      /// \brief Mark the variables involved in the derivatives
+      /// structure (dense case: all of them).
+      void markStructureVariables (std::vector<bool>& nonlinear,
+				   EigenMatrixDense) const;
+
+      /// \brief Mark the variables involved in the cost gradient or
+      /// in a nonlinear constraint Jacobian structure (sparse case).
+      ///
+      /// Uses the locked Jacobians layouts, and the union of the cost
+      /// gradient structures at the structure sample points.
+      void markStructureVariables (std::vector<bool>& nonlinear,
+				   EigenMatrixSparse) const;
+
+      /// \brief Compute the lower-triangular Lagrangian Hessian
+      /// structure.
+      ///
+      /// Uses the user-declared pattern if any, otherwise the union of
+      /// the Hessians patterns at the structure sample points and of
+      /// the nonzeros previous solves found outside of it.
+      void setupHessianStructure ();
+
+      /// \brief Evaluate a constraint Hessian and add it, weighted by
+      /// its multiplier, to the accumulator of the worker.
+      void evalConstraintHessianTask (std::size_t constraint,
+				      std::size_t worker);
+
+      /// \brief Add a cached constraint Hessian, weighted by its
+      /// multiplier, to the accumulator of the worker.
+      void weightConstraintHessianTask (std::size_t constraint,
+					std::size_t worker);
+
+      /// \brief Cached quantity type.
+      typedef IpoptCacheStatistics::Quantity quantity_t;
+
+      /// \brief Register the point at which Ipopt requests an evaluation.
+      ///
+      /// If the point differs from the cached one, all the cached
+      /// quantities are dropped. Ipopt's new_x flag is trusted when
+      /// it is false, otherwise the point is compared to the cached
+      /// one through its fingerprint.
+      ///
+      /// \param n input size.
+      /// \param x point requested by Ipopt.
+      /// \param new_x whether Ipopt considers x as a new point.
+      void updateIterate (Index n, const Number* x, bool new_x);
+
+      /// \brief Drop all the cached quantities.
+      void invalidateIterate ();
+
+      /// \brief Reset the per-solve state once per optimization started
+      /// by the solver: evaluation cache, error flag and checkpoints.
+      ///
+      /// Called by the first problem queries of Ipopt: get_nlp_info
+      /// for solves, get_bounds_info for re-solves, which keep the
+      /// problem structure and do not call get_nlp_info.
+      void beginSolve ();
+
+      /// \brief Store an error in the solver result.
+      ///
+      /// The error is kept when Ipopt finalizes the solution.
+      ///
+      /// \return false, so that callbacks can return its result.
+      bool reportError (const std::runtime_error& error);
+
+      /// \brief Structural nonzeros (row, column) type.
+      typedef std::vector<std::pair<Index, Index> > structureEntries_t;
+
+      /// \brief Throw the error of constraints Jacobian nonzeros
+      /// outside of the Jacobian structure.
+      ///
+      /// If the structure was detected, the nonzeros are added to it
+      /// and the solver starts the optimization again (see
+      /// IpoptSolverCommon::optimizeTNLP).
+      ///
+      /// \param constraint constraint index.
+      /// \param entries nonzeros, in the rows of the constraints vector.
+      void jacobianStructureError (std::size_t constraint,
+				   const structureEntries_t& entries);
+
+      /// \brief Throw the error of Hessian nonzeros outside of the
+      /// Lagrangian Hessian structure.
+      ///
+      /// If the structure was detected, the nonzeros are added to it
+      /// and the solver starts the optimization again (see
+      /// IpoptSolverCommon::optimizeTNLP).
+      ///
+      /// \param name function name.
+      /// \param constraint constraint index, -1 for the cost function.
+      /// \param functionRow row of the function.
+      /// \param entries nonzeros (lower triangle).
+      void hessianStructureError (const std::string& name, int constraint,
+				  Function::size_type functionRow,
+				  const structureEntries_t& entries);
+
+      /// \brief Check whether a quantity is available in the cache
+      /// and update the cache statistics accordingly.
+      bool isCached (quantity_t quantity);
+
+      /// \brief Mark a quantity as cached for the current point.
+      void setCached (quantity_t quantity);
+
     /// \brief Pointer to function logger (see log4cxx documentation).
     static log4cxx::LoggerPtr logger;
 
@@ -178,17 +547,386 @@ namespace roboptim
       /// \brief Constraints buffer.
       boost::optional<typename function_t::result_t> constraints_;
 
-      /// \brief Constraints jacobian buffer.
-      boost::optional<typename function_t::matrix_t> jacobian_;
+      /// \brief Constraints Jacobian values buffer for the dense case,
+      /// in Ipopt's layout (only if cacheJacobian_ is set).
+      boost::optional<typename function_t::vector_t> constraintsJacobian_;
+
+      /// \brief Whether the dense Jacobian values are kept for the
+      /// current iterate (ipopt.plugin.cache_dense_jacobian parameter).
+      bool cacheJacobian_;
 
       /// \brief Constraint Jacobian matrices buffer for the sparse case.
       /// Since we cannot just rely on Eigen::Ref in the sparse case, temporary
       /// Jacobian matrices are used for each constraint.
       typedef std::vector<typename function_t::matrix_t> constraintJacobians_t;
       constraintJacobians_t constraintJacobians_;
+
+      /// \brief Zero Jacobian of each constraint with the layout locked
+      /// by the structure pass (sparse case only).
+      ///
+      /// Jacobians returned with another layout are moved back to the
+      /// locked layout through these buffers, see evalConstraintJacobian.
+      constraintJacobians_t lockedJacobians_;
+
+      /// \brief Constant Jacobian of each linear constraint (dense
+      /// case only, empty for nonlinear constraints).
+      constraintJacobians_t linearJacobians_;
+
+      /// \brief Jacobians of the linear constraints, stacked in the
+      /// rows of the constraints vector (other rows are empty).
+      Eigen::SparseMatrix<double, Eigen::RowMajor> linearMatrix_;
+
+      /// \brief Value of the linear constraints at zero (empty if there
+      /// is no linear constraint).
+      typename function_t::vector_t linearOffset_;
+
+      /// \brief Common constraint function type.
+      typedef typename solver_t::commonConstraintFunction_t
+      constraintFunction_t;
+
+      /// \brief Pre-resolved constraint.
+      struct ConstraintInfo
+      {
+	/// \brief Constraint function (owned by the problem).
+	const constraintFunction_t* function;
+
+	/// \brief Whether the constraint is linear.
+	bool linear;
+
+	/// \brief Index of the constraint's first row in the constraints
+	/// vector.
+	typename function_t::size_type offset;
+
+	/// \brief Output size of the constraint.
+	typename function_t::size_type outputSize;
+      };
+
+      /// \brief Constraints table type.
+      typedef std::vector<ConstraintInfo> constraintsTable_t;
+
+      /// \brief Constraints, in the problem's order.
+      constraintsTable_t constraintsTable_;
+
+      /// \brief Total output size of the constraints.
+      typename function_t::size_type constraintsOutputSize_;
+
+      /// \brief Thread pool (only if parallel evaluation is enabled).
+      boost::shared_ptr<ThreadPool> threadPool_;
+
+      /// \brief Constraints assigned to each worker.
+      ThreadPool::schedule_t schedule_;
+
+      /// \brief Constraints sorted by decreasing cost (scheduling buffer).
+      std::vector<std::size_t> sortedConstraints_;
+
+      /// \brief Load of each worker (scheduling buffer).
+      std::vector<double> workersLoad_;
+
+      /// \brief Estimated evaluation time of each constraint.
+      std::vector<double> constraintsCost_;
+
+      /// \brief Estimated Jacobian evaluation time of each constraint.
+      std::vector<double> jacobiansCost_;
+
+      /// \brief Constraint evaluation task.
+      ThreadPool::task_t evalConstraintTask_;
+
+      /// \brief Constraint Jacobian evaluation task.
+      ThreadPool::task_t evalConstraintJacobianTask_;
+
+      /// \brief Constraint Hessian evaluation task.
+      ThreadPool::task_t evalConstraintHessianTask_;
+
+      /// \brief Cached constraint Hessian weighting task.
+      ThreadPool::task_t weightConstraintHessianTask_;
+
+      /// \brief Finite differences Hessian task.
+      ThreadPool::task_t evalFiniteDifferenceHessianTask_;
+
+      /// \brief Task wrapper measuring evaluation times.
+      ThreadPool::task_t timedConstraintTask_;
+
+      /// \brief Task currently run by the thread pool.
+      const ThreadPool::task_t* currentTask_;
+
+      /// \brief Costs updated by the task currently run.
+      std::vector<double>* currentCosts_;
+
+      /// \brief Point at which tasks evaluate the constraints.
+      const Number* taskX_;
+
+      /// \brief Output buffer of the tasks (Ipopt's g or values).
+      Number* taskOutput_;
+
+      /// \brief Constraint multipliers used by the Hessian tasks.
+      const Number* taskLambda_;
+
+      /// \brief Estimated Hessian evaluation time of each constraint.
+      std::vector<double> hessiansCost_;
+
+      /// \brief Estimated Hessian weighting time of each constraint.
+      std::vector<double> hessianWeightsCost_;
+
+      /// \brief Constraint Hessian buffer for each worker (with
+      /// ipopt-sparse-td, only if Hessians are not cached).
+      std::vector<typename function_t::matrix_t> hessianScratch_;
+
+      /// \brief Whether individual Hessians are kept for the current
+      /// iterate (ipopt.plugin.cache_hessians parameter).
+      bool cacheHessians_;
+
+      /// \brief Whether every Hessian evaluation checks for nonzeros
+      /// outside of the structure (ipopt.plugin.check_hessian_structure
+      /// parameter, ipopt-td only).
+      bool checkHessianStructure_;
+
+      /// \brief Whether the detected Hessian structure has not been
+      /// checked by an evaluation yet (ipopt-td only).
+      bool hessianStructureUnchecked_;
+
+      /// \brief Objective Hessian at the current iterate.
+      typename function_t::matrix_t costHessian_;
+
+      /// \brief Values of the objective Hessian structural nonzeros at
+      /// the current iterate (ipopt-td only).
+      typename function_t::vector_t costHessianValues_;
+
+      /// \brief Constraint Hessians at the current iterate (only if
+      /// Hessians are cached).
+      ///
+      /// With ipopt-td, one matrix per constraint holds the values of
+      /// the structural nonzeros of its rows Hessians, one column per
+      /// row. With ipopt-sparse-td, one matrix per constraint row holds
+      /// its Hessian.
+      std::vector<typename function_t::matrix_t> constraintHessians_;
+
+      /// \brief Values of the structural nonzeros of the rows Hessians
+      /// of the constraint being evaluated, one column per row, for each
+      /// worker (ipopt-td only, only if Hessians are not cached).
+      std::vector<typename function_t::matrix_t> hessianRowValues_;
+
+      /// \brief Row indices of the Lagrangian Hessian structural
+      /// nonzeros (lower triangle).
+      std::vector<Index> hessianRows_;
+
+      /// \brief Column indices of the Lagrangian Hessian structural
+      /// nonzeros (lower triangle).
+      std::vector<Index> hessianCols_;
+
+      /// \brief Row indices of the constraints Jacobian structural
+      /// nonzeros (sparse case only).
+      ///
+      /// Nonzeros are ordered constraint by constraint, following the
+      /// storage order of each constraint Jacobian.
+      std::vector<Index> jacobianRows_;
+
+      /// \brief Column indices of the constraints Jacobian structural
+      /// nonzeros (sparse case only).
+      std::vector<Index> jacobianCols_;
+
+      /// \brief Position map type (sparse case).
+      typedef Eigen::SparseMatrix
+      <Index, GenericFunctionTraits<typename function_t::traits_t>::StorageOrder>
+      jacobianIndex_t;
+
+      /// \brief Position (plus one) of each structural nonzero of a
+      /// constraint Jacobian in Ipopt's values (sparse case only).
+      ///
+      /// These maps share the layout of the constraint Jacobians after
+      /// the structure pass, so their value arrays are the scatter
+      /// maps of the Jacobians compressed value arrays.
+      std::vector<jacobianIndex_t> jacobianIndex_;
+
+      /// \brief Whether the positions of each constraint are
+      /// consecutive in Ipopt's values (sparse case only).
+      std::vector<bool> jacobianContiguous_;
+
+      /// \brief Position (plus one) of each structural nonzero in
+      /// Ipopt's Hessian values (sparse case only).
+      Eigen::SparseMatrix<Index, Eigen::ColMajor> hessianIndex_;
+
+      /// \brief Scatter map of the last Hessian of each constraint row,
+      /// then of the objective Hessian, in Ipopt's Hessian values
+      /// (ipopt-sparse-td only).
+      ///
+      /// These maps share the layout of the Hessians returned by the
+      /// functions, see accumulateSparseLowerTriangle.
+      std::vector<jacobianIndex_t> hessianScatter_;
+
+      /// \brief Lagrangian Hessian values accumulated by each worker.
+      std::vector<typename function_t::vector_t> hessianValues_;
+
+      /// \brief Column coloring of a constraint Jacobian structure.
+      struct FiniteDifferenceColoring
+      {
+	/// \brief Start of each color in colorColumns (number of colors
+	/// plus one elements).
+	std::vector<int> colorOffsets;
+
+	/// \brief Columns, grouped by color.
+	std::vector<int> colorColumns;
+
+	/// \brief Start of each column in columnRows and
+	/// columnPositions.
+	std::vector<int> columnOffsets;
+
+	/// \brief Row of each structural nonzero, grouped by column.
+	std::vector<int> columnRows;
+
+	/// \brief Position of each structural nonzero in the compressed
+	/// values of the Jacobian buffer, grouped by column.
+	std::vector<int> columnPositions;
+      };
+
+      /// \brief Coloring of each constraint (empty if finite
+      /// differences are disabled, unused for linear constraints).
+      std::vector<FiniteDifferenceColoring> finiteDifferenceColorings_;
+
+      /// \brief Relative finite differences step.
+      double finiteDifferenceStep_;
+
+      /// \brief Constraints values at the point the Jacobians are
+      /// evaluated at, if known.
+      const Number* finiteDifferenceReference_;
+
+      /// \brief Perturbed point for each worker.
+      std::vector<typename function_t::vector_t> finiteDifferenceArguments_;
+
+      /// \brief Constraint value at the reference point for each
+      /// worker.
+      std::vector<typename function_t::vector_t> finiteDifferenceReferences_;
+
+      /// \brief Constraint value at the perturbed point for each
+      /// worker.
+      std::vector<typename function_t::vector_t> finiteDifferenceValues_;
+
+      /// \brief Whether the Lagrangian Hessian is computed from
+      /// gradients differences (ipopt.plugin.finite_difference_hessian
+      /// parameter).
+      bool finiteDifferenceHessian_;
+
+      /// \brief Star coloring of the Lagrangian Hessian structure.
+      struct HessianColoring
+      {
+	/// \brief Start of each color in colorColumns (number of colors
+	/// plus one elements).
+	std::vector<int> colorOffsets;
+
+	/// \brief Columns, grouped by color.
+	std::vector<int> colorColumns;
+
+	/// \brief Color of the product holding each structural nonzero.
+	std::vector<int> sourceColors;
+
+	/// \brief Row of the product holding each structural nonzero.
+	std::vector<int> sourceRows;
+
+	/// \brief Column whose step divides each structural nonzero.
+	std::vector<int> sourceColumns;
+      };
+
+      /// \brief Coloring of the Lagrangian Hessian structure (empty if
+      /// finite differences are disabled).
+      HessianColoring hessianColoring_;
+
+      /// \brief Constraint Jacobian buffer for each worker.
+      std::vector<typename function_t::matrix_t> finiteDifferenceJacobians_;
+
+      /// \brief Lagrangian gradients at x and at each colored step,
+      /// summed by each worker.
+      std::vector<typename function_t::matrix_t> finiteDifferenceProducts_;
+
+      /// \brief Cost gradient buffer.
+      typename function_t::vector_t finiteDifferenceGradient_;
+
+      /// \brief Step of each variable at the current point.
+      typename function_t::vector_t finiteDifferenceSteps_;
+
+      /// \brief Variables appearing nonlinearly in the problem, in
+      /// increasing order.
+      std::vector<Index> nonlinearVariables_;
+
+      /// \brief Mapped structure cache file (only during get_nlp_info).
+      StructureCache structureCache_;
+
+      /// \brief Structure cache file of the problem (empty if the
+      /// cache is disabled).
+      std::string structureCachePath_;
+
+      /// \brief Fingerprint of the problem structure.
+      StructureCache::fingerprint_t structureFingerprint_;
+
+      /// \brief Checkpoint file (empty if checkpoints are disabled).
+      std::string checkpointPath_;
+
+      /// \brief Number of iterations between checkpoints (0 if
+      /// disabled).
+      int checkpointIterations_;
+
+      /// \brief Number of seconds between checkpoints (0 if disabled).
+      double checkpointSeconds_;
+
+      /// \brief Iteration of the last checkpoint.
+      Index checkpointIteration_;
+
+      /// \brief Time of the last checkpoint.
+      boost::posix_time::ptime checkpointTime_;
+
+      /// \brief Fingerprint of the problem, stored in checkpoints.
+      Checkpoint::fingerprint_t checkpointFingerprint_;
+
+      /// \brief Checkpoint buffer.
+      Checkpoint checkpoint_;
+
+      /// \brief Per-iterate evaluation cache.
+      ///
+      /// The values themselves are stored in the evaluation buffers
+      /// above, this only records the point they correspond to.
+      struct IterateCache
+      {
+	IterateCache ()
+	  : x (),
+	    fingerprint (0)
+	{
+	  std::fill (valid, valid + IpoptCacheStatistics::NB_QUANTITIES,
+		     false);
+	}
+
+	/// \brief Point at which the cached quantities were evaluated.
+	typename function_t::vector_t x;
+
+	/// \brief Hash of x used to quickly detect a point change.
+	std::size_t fingerprint;
+
+	/// \brief Whether each quantity is valid for x.
+	bool valid[IpoptCacheStatistics::NB_QUANTITIES];
+      };
+
+      /// \brief Evaluation cache for the current iterate.
+      IterateCache cache_;
+
+      /// \brief Whether an error was reported during the current
+      /// solve (see reportError).
+      bool evaluationFailed_;
+
+      /// \brief Optimization of the solver the per-solve state was
+      /// last reset for (see beginSolve).
+      std::size_t optimization_;
+
+      /// \brief Constraints Jacobian nonzeros found outside of the
+      /// detected structure by previous solves.
+      structureEntries_t jacobianExtraEntries_;
+
+      /// \brief Lagrangian Hessian nonzeros (lower triangle) found
+      /// outside of the detected structure by previous solves.
+      structureEntries_t hessianExtraEntries_;
+
+      /// \brief Protect the extra entries, recorded by the workers.
+      boost::mutex structureMutex_;
     };
   } // end of namespace detail.
 } // end of namespace roboptim.
 
 # include "tnlp.hxx"
+# include "tnlp-sparse.hxx"
 #endif //! ROBOPTIM_CORE_IPOPT_TNLP_HH
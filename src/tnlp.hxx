@@ -18,7 +18,24 @@
 #ifndef ROBOPTIM_CORE_PLUGING_IPOPT_TNLP_HXX
 # define ROBOPTIM_CORE_PLUGING_IPOPT_TNLP_HXX
 
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <cstring>
+# include <limits>
+# include <sstream>
+# include <stdexcept>
+# include <string>
+# include <utility>
+
+# include <boost/bind.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <boost/random/mersenne_twister.hpp>
+# include <boost/random/uniform_real_distribution.hpp>
 # include <boost/shared_ptr.hpp>
+# include <boost/static_assert.hpp>
+# include <boost/functional/hash.hpp>
+# include <boost/type_traits/is_same.hpp>
 
 # include <boost/mpl/assert.hpp>
 # include <boost/mpl/at.hpp>
@@ -27,6 +44,7 @@
 
 # include <roboptim/core/plugin/ipopt/ipopt-td.hh>
 # include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+# include <roboptim/core/plugin/ipopt/ipopt-sparse-td.hh>
 # include <roboptim/core/debug.hh>
 
 # include <coin/IpIpoptCalculatedQuantities.hpp>
@@ -34,139 +52,1601 @@
 # include <coin/IpOrigIpoptNLP.hpp>
 # include <coin/IpTNLPAdapter.hpp>
 
+# include "coloring.hh"
+
 namespace roboptim
 {
   using namespace Ipopt;
 
-  namespace detail
-  {
-    template <typename T>
-    log4cxx::LoggerPtr Tnlp<T>::logger
-    (log4cxx::Logger::getLogger ("roboptim.ipopt"));
+  namespace detail
+  {
+    template <typename T>
+    log4cxx::LoggerPtr Tnlp<T>::logger
+    (log4cxx::Logger::getLogger ("roboptim.ipopt"));
+
+    /// \internal
+#ifdef ROBOPTIM_CORE_IPOPT_PLUGIN_CHECK_GRADIENT
+    template <typename T, typename F>
+    void IpoptCheckGradient (const F& function,
+			     unsigned functionId,
+			     Eigen::Map<const Function::vector_t>& x,
+			     int constraintId,
+			     T& solver)
+    {
+      using boost::format;
+      try
+	{
+	  checkGradientAndThrow (function, functionId, x, 1.);
+	}
+      catch (BadGradient& bg)
+	{
+	  solver.invalidateGradient ();
+	  std::cerr
+	    << ((functionId < 0)
+		? "Invalid cost function gradient:"
+		: (format ("Invalid constraint function gradient (id = %1%):")
+		   % constraintId).str ())
+	    << std::endl
+	    << function.getName ()
+	    << std::endl
+	    << bg
+	    << std::endl;
+	}
+    }
+#else
+    template <typename T, typename F>
+    void IpoptCheckGradient (const F&,
+			     unsigned,
+			     Eigen::Map<const Function::vector_t>&,
+			     int,
+			     T&)
+    {}
+#endif //!ROBOPTIM_CORE_IPOPT_PLUGIN_CHECK_GRADIENT
+
+    /// \internal
+    /// \brief Scoped override of Eigen's runtime allocation check.
+    ///
+    /// Evaluations done in steady state are expected to be
+    /// allocation-free: disallowing heap allocations around them makes
+    /// Eigen abort on any allocation when the check is enabled.
+#ifndef ROBOPTIM_DO_NOT_CHECK_ALLOCATION
+    struct MallocAllowedScope
+    {
+      explicit MallocAllowedScope (bool allowed)
+	: previous_ (Eigen::internal::is_malloc_allowed ())
+      {
+	Eigen::internal::set_is_malloc_allowed (allowed);
+      }
+
+      ~MallocAllowedScope ()
+      {
+	Eigen::internal::set_is_malloc_allowed (previous_);
+      }
+
+    private:
+      bool previous_;
+    };
+#else
+    struct MallocAllowedScope
+    {
+      explicit MallocAllowedScope (bool)
+      {}
+    };
+#endif //! ROBOPTIM_DO_NOT_CHECK_ALLOCATION
+
+
+    /// \internal
+    /// \brief Read a plug-in parameter.
+    ///
+    /// \param solver solver holding the parameters.
+    /// \param key parameter name.
+    /// \param defaultValue value returned if the parameter does not
+    /// exist or does not have the expected type.
+    template <typename V, typename S>
+    V pluginParameter (const S& solver, const std::string& key,
+		       const V& defaultValue)
+    {
+      typename S::parameters_t::const_iterator
+	it = solver.parameters ().find (key);
+      if (it == solver.parameters ().end ())
+	return defaultValue;
+
+      const V* value = boost::get<V> (&it->second.value);
+      return value ? *value : defaultValue;
+    }
+
+    /// \internal
+    /// \brief Order indices by decreasing cost.
+    struct CostGreater
+    {
+      explicit CostGreater (const std::vector<double>& costs)
+	: costs_ (costs)
+      {}
+
+      bool operator () (std::size_t i, std::size_t j) const
+      {
+	return costs_[i] > costs_[j];
+      }
+
+    private:
+      const std::vector<double>& costs_;
+    };
+
+    /// \internal
+    /// \brief Add the weighted structural nonzeros of a dense Hessian to
+    /// Lagrangian Hessian values.
+    ///
+    /// The structural nonzeros of h are reset to zero once read, so h
+    /// does not need to be cleared before the next evaluation: its
+    /// other entries are never read.
+    ///
+    /// \param values values of the Lagrangian Hessian structural nonzeros.
+    /// \param weight weight of the Hessian.
+    /// \param h Hessian.
+    /// \param rows row of each structural nonzero (lower triangle).
+    /// \param cols column of each structural nonzero.
+    template <typename V, typename M>
+    void accumulateLowerStructure (V& values, double weight, M& h,
+				   const std::vector<Index>& rows,
+				   const std::vector<Index>& cols)
+    {
+      for (std::size_t k = 0; k < rows.size (); ++k)
+	{
+	  typename M::Scalar& entry = h.coeffRef (rows[k], cols[k]);
+	  values[static_cast<typename V::Index> (k)] += weight * entry;
+	  entry = 0.;
+	}
+    }
+
+    /// \internal
+    /// \brief Copy the structural nonzeros of a dense Hessian.
+    ///
+    /// As with accumulateLowerStructure, the structural nonzeros of h
+    /// are reset to zero once read.
+    ///
+    /// \param values values of the structural nonzeros (output).
+    /// \param h Hessian.
+    /// \param rows row of each structural nonzero (lower triangle).
+    /// \param cols column of each structural nonzero.
+    template <typename V, typename M>
+    void extractLowerStructure (V values, M& h,
+				const std::vector<Index>& rows,
+				const std::vector<Index>& cols)
+    {
+      for (std::size_t k = 0; k < rows.size (); ++k)
+	{
+	  typename M::Scalar& entry = h.coeffRef (rows[k], cols[k]);
+	  values[static_cast<typename V::Index> (k)] = entry;
+	  entry = 0.;
+	}
+    }
+
+    /// \internal
+    /// \brief Find the nonzeros in the lower triangle of a dense matrix.
+    ///
+    /// \param entries positions of the nonzeros (appended, column by
+    /// column).
+    /// \return whether there is any.
+    template <typename M>
+    bool findLowerNonZeros (std::vector<std::pair<Index, Index> >& entries,
+			    const M& h)
+    {
+      std::size_t size = entries.size ();
+      for (typename M::Index j = 0; j < h.cols (); ++j)
+	for (typename M::Index i = j; i < h.rows (); ++i)
+	  if (h (i, j) != 0.)
+	    entries.push_back
+	      (std::make_pair (static_cast<Index> (i), static_cast<Index> (j)));
+      return entries.size () > size;
+    }
+
+    void
+    jacobianFromGradients
+    (DerivableFunction::matrix_t& jac,
+     const IpoptSolver::problem_t::constraints_t& c,
+     const DerivableFunction::vector_t& x);
+
+    /// \internal
+    /// \brief Mark the columns holding nonzero entries (dense case).
+    template <typename D>
+    void markNonZeroColumns (std::vector<bool>& columns,
+			     const Eigen::MatrixBase<D>& m)
+    {
+      for (typename D::Index j = 0; j < m.cols (); ++j)
+	if ((m.col (j).array () != 0.).any ())
+	  columns[static_cast<std::size_t> (j)] = true;
+    }
+
+    /// \internal
+    /// \brief Mark the columns holding nonzero entries (sparse case).
+    template <int O>
+    void markNonZeroColumns (std::vector<bool>& columns,
+			     const Eigen::SparseMatrix<double, O>& m)
+    {
+      typedef Eigen::SparseMatrix<double, O> matrix_t;
+      for (int k = 0; k < m.outerSize (); ++k)
+	for (typename matrix_t::InnerIterator it (m, k); it; ++it)
+	  if (it.value () != 0.)
+	    columns[static_cast<std::size_t> (it.col ())] = true;
+    }
+
+    /// \internal
+    /// \brief Mark the variables which a function does not depend on
+    /// linearly.
+    ///
+    /// A variable appears linearly if the derivatives with respect to
+    /// it are the same at all the sample points. With a single point,
+    /// all the variables the function depends on are marked.
+    template <typename F, typename V>
+    void markNonlinearVariables (std::vector<bool>& nonlinear, const F& f,
+				 const std::vector<V>& points)
+    {
+      typedef typename F::jacobian_t jacobian_t;
+
+      const jacobian_t reference = f.jacobian (points[0]);
+      if (points.size () < 2)
+	markNonZeroColumns (nonlinear, reference);
+
+      for (std::size_t k = 1; k < points.size (); ++k)
+	{
+	  jacobian_t difference = f.jacobian (points[k]) - reference;
+	  markNonZeroColumns (nonlinear, difference);
+	}
+    }
+
+    /// \internal
+    /// \brief Mark the Hessian entries revealed by differences of a
+    /// function Jacobian.
+    ///
+    /// Each variable is perturbed in turn: the Jacobian columns which
+    /// change give the nonzeros of the corresponding Hessian columns.
+    /// This costs n + 1 Jacobian evaluations of f, n being the number
+    /// of variables.
+    ///
+    /// \param mask structural nonzeros (lower triangle).
+    /// \param f function.
+    /// \param x point.
+    /// \param step relative step.
+    template <typename M, typename F, typename V>
+    void markGradientDifferences (M& mask, const F& f, const V& x,
+				  double step)
+    {
+      typedef typename F::jacobian_t jacobian_t;
+      typedef typename F::size_type size_type;
+
+      const jacobian_t reference = f.jacobian (x);
+      V argument = x;
+      for (size_type j = 0; j < x.size (); ++j)
+	{
+	  argument[j] += step * std::max (1., std::abs (x[j]));
+	  jacobian_t difference = f.jacobian (argument) - reference;
+	  argument[j] = x[j];
+
+	  for (size_type k = 0; k < difference.cols (); ++k)
+	    if ((difference.col (k).array () != 0.).any ())
+	      mask (std::max (j, k), std::min (j, k)) = true;
+	}
+    }
+
+    template <typename T>
+    Tnlp<T>::Tnlp (const typename solver_t::problem_t& pb, solver_t& solver)
+      : solver_ (solver),
+        solverState_ (pb),
+	cost_ (),
+	costGradient_ (),
+	constraints_ (),
+	constraintsJacobian_ (),
+	cacheJacobian_ (false),
+	constraintJacobians_ (),
+	lockedJacobians_ (),
+	linearJacobians_ (),
+	linearMatrix_ (),
+	linearOffset_ (),
+	constraintsTable_ (),
+	constraintsOutputSize_ (0),
+	threadPool_ (),
+	schedule_ (),
+	sortedConstraints_ (),
+	workersLoad_ (),
+	constraintsCost_ (),
+	jacobiansCost_ (),
+	evalConstraintTask_
+	(boost::bind (&Tnlp<T>::evalConstraintTask, this, _1, _2)),
+	evalConstraintJacobianTask_
+	(boost::bind (&Tnlp<T>::evalConstraintJacobianTask, this, _1, _2)),
+	evalConstraintHessianTask_
+	(boost::bind (&Tnlp<T>::evalConstraintHessianTask, this, _1, _2)),
+	weightConstraintHessianTask_
+	(boost::bind (&Tnlp<T>::weightConstraintHessianTask, this, _1, _2)),
+	evalFiniteDifferenceHessianTask_
+	(boost::bind (&Tnlp<T>::evalFiniteDifferenceHessianTask, this, _1, _2)),
+	timedConstraintTask_
+	(boost::bind (&Tnlp<T>::timedConstraintTask, this, _1, _2)),
+	currentTask_ (0),
+	currentCosts_ (0),
+	taskX_ (0),
+	taskOutput_ (0),
+	taskLambda_ (0),
+	hessiansCost_ (),
+	hessianWeightsCost_ (),
+	hessianScratch_ (),
+	cacheHessians_ (false),
+	checkHessianStructure_ (false),
+	hessianStructureUnchecked_ (false),
+	costHessian_ (),
+	costHessianValues_ (),
+	constraintHessians_ (),
+	hessianRowValues_ (),
+	hessianRows_ (),
+	hessianCols_ (),
+	jacobianRows_ (),
+	jacobianCols_ (),
+	jacobianIndex_ (),
+	jacobianContiguous_ (),
+	hessianIndex_ (),
+	hessianScatter_ (),
+	hessianValues_ (),
+	finiteDifferenceColorings_ (),
+	finiteDifferenceStep_ (1e-8),
+	finiteDifferenceReference_ (0),
+	finiteDifferenceArguments_ (),
+	finiteDifferenceReferences_ (),
+	finiteDifferenceValues_ (),
+	finiteDifferenceHessian_ (false),
+	hessianColoring_ (),
+	finiteDifferenceJacobians_ (),
+	finiteDifferenceProducts_ (),
+	finiteDifferenceGradient_ (),
+	finiteDifferenceSteps_ (),
+	nonlinearVariables_ (),
+	structureCache_ (),
+	structureCachePath_ (),
+	structureFingerprint_ (0),
+	checkpointPath_ (),
+	checkpointIterations_ (0),
+	checkpointSeconds_ (0.),
+	checkpointIteration_ (0),
+	checkpointTime_ (),
+	checkpointFingerprint_ (0),
+	checkpoint_ (),
+	cache_ (),
+	evaluationFailed_ (false),
+	optimization_ (0),
+	jacobianExtraEntries_ (),
+	hessianExtraEntries_ (),
+	structureMutex_ ()
+    {
+      BOOST_MPL_ASSERT_RELATION
+	( (boost::mpl::size<
+           typename solver_t::problem_t::constraintsList_t>::value), ==, 2);
+    }
+
+    template <typename T>
+    Function::size_type
+    Tnlp<T>::constraintsOutputSize ()
+    {
+      return constraintsOutputSize_;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::buildConstraintsTable ()
+    {
+      using namespace boost;
+
+      typedef typename solver_t::problem_t::constraints_t::const_iterator
+	citer_t;
+
+      constraintsTable_.clear ();
+      constraintsTable_.reserve (solver_.problem ().constraints ().size ());
+      constraintsOutputSize_ = 0;
+
+      for (citer_t it = solver_.problem ().constraints ().begin ();
+	   it != solver_.problem ().constraints ().end (); ++it)
+	{
+	  ConstraintInfo info;
+	  info.linear = (it->which () == LINEAR);
+	  if (info.linear)
+	    info.function = get<shared_ptr<linearFunction_t> > (*it).get ();
+	  else
+	    info.function = get<shared_ptr<nonLinearFunction_t> > (*it).get ();
+	  info.offset = constraintsOutputSize_;
+	  info.outputSize = info.function->outputSize ();
+
+	  constraintsTable_.push_back (info);
+	  constraintsOutputSize_ += info.outputSize;
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupParallelEvaluation ()
+    {
+      int threads =
+	pluginParameter (solver_, "ipopt.plugin.eval_threads", 1);
+
+      // Evaluation costs are initially assumed proportional to the
+      // constraints output size, then measured.
+      constraintsCost_.resize (constraintsTable_.size ());
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	constraintsCost_[i] =
+	  1e-6 * static_cast<double> (constraintsTable_[i].outputSize);
+      jacobiansCost_ = constraintsCost_;
+
+      if (threads <= 1 || constraintsTable_.size () < 2)
+	{
+	  threadPool_.reset ();
+	  return;
+	}
+
+      std::size_t size = std::min (static_cast<std::size_t> (threads),
+				   constraintsTable_.size ());
+      if (!threadPool_ || threadPool_->size () != size)
+	threadPool_.reset (new ThreadPool (size));
+
+      schedule_.resize (size);
+      for (std::size_t i = 0; i < size; ++i)
+	schedule_[i].reserve (constraintsTable_.size ());
+      sortedConstraints_.resize (constraintsTable_.size ());
+      workersLoad_.resize (size);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::runConstraintsTask (const ThreadPool::task_t& task,
+				 std::vector<double>& costs)
+    {
+      if (!threadPool_)
+	{
+	  for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	    task (i, 0);
+	  return;
+	}
+
+      scheduleConstraints (costs);
+      currentTask_ = &task;
+      currentCosts_ = &costs;
+
+      // Eigen's allocation check relies on a process-wide flag, which
+      // RobOptim functions toggle on each evaluation: concurrent
+      // evaluations leave it in an arbitrary state, so it is only
+      // enforced by the functions themselves while the workers run.
+      MallocAllowedScope allocation (true);
+      threadPool_->run (timedConstraintTask_, schedule_);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::scheduleConstraints (const std::vector<double>& costs)
+    {
+      for (std::size_t i = 0; i < sortedConstraints_.size (); ++i)
+	sortedConstraints_[i] = i;
+      std::sort (sortedConstraints_.begin (), sortedConstraints_.end (),
+		 CostGreater (costs));
+
+      std::fill (workersLoad_.begin (), workersLoad_.end (), 0.);
+      for (std::size_t w = 0; w < schedule_.size (); ++w)
+	schedule_[w].clear ();
+
+      for (std::size_t i = 0; i < sortedConstraints_.size (); ++i)
+	{
+	  std::size_t worker = static_cast<std::size_t>
+	    (std::min_element (workersLoad_.begin (), workersLoad_.end ())
+	     - workersLoad_.begin ());
+	  schedule_[worker].push_back (sortedConstraints_[i]);
+	  workersLoad_[worker] += costs[sortedConstraints_[i]];
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::timedConstraintTask (std::size_t constraint, std::size_t worker)
+    {
+      using namespace boost::posix_time;
+
+      ptime start = microsec_clock::universal_time ();
+      (*currentTask_) (constraint, worker);
+      double duration = 1e-6 * static_cast<double>
+	((microsec_clock::universal_time () - start).total_microseconds ());
+
+      // Each constraint is handled by a single worker, no need to lock.
+      double& cost = (*currentCosts_)[constraint];
+      cost = .5 * cost + .5 * duration;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalConstraintTask (std::size_t constraint, std::size_t)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+
+      // Linear constraints are evaluated together, see eval_g.
+      if (info.linear)
+	return;
+
+      Eigen::Map<const typename function_t::argument_t>
+	x_ (taskX_, solver_.problem ().function ().inputSize ());
+      Eigen::Map<typename function_t::result_t>
+	g_ (taskOutput_, constraintsOutputSize_);
+
+      (*info.function) (g_.segment (info.offset, info.outputSize), x_);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalConstraintJacobianTask (std::size_t constraint,
+					 std::size_t worker)
+    {
+      // Linear constraints Jacobians are constant, see
+      // setupLinearJacobians.
+      if (constraintsTable_[constraint].linear)
+	restoreLinearJacobian
+	  (constraint, typename function_t::traits_t ());
+      else
+	evalConstraintJacobian
+	  (constraint, worker, typename function_t::traits_t ());
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupLinearJacobians (EigenMatrixDense)
+    {
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+
+      // Any point will do.
+      typename function_t::vector_t x = function_t::vector_t::Zero (n);
+
+      linearJacobians_.resize (constraintsTable_.size ());
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  const ConstraintInfo& info = constraintsTable_[i];
+	  typename function_t::jacobian_t& jac = linearJacobians_[i];
+
+	  if (!info.linear)
+	    {
+	      jac.resize (0, 0);
+	      continue;
+	    }
+
+	  jac.setZero (info.outputSize, n);
+	  info.function->jacobian (jac, x);
+	}
+
+      std::vector<Eigen::Triplet<double> > entries;
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  const typename function_t::jacobian_t& jac = linearJacobians_[i];
+	  for (typename function_t::size_type c = 0; c < jac.cols (); ++c)
+	    for (typename function_t::size_type r = 0; r < jac.rows (); ++r)
+	      if (jac (r, c) != 0.)
+		entries.push_back
+		  (Eigen::Triplet<double>
+		   (static_cast<int> (constraintsTable_[i].offset + r),
+		    static_cast<int> (c), jac (r, c)));
+	}
+      setupLinearConstraints (entries);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupLinearConstraints
+    (const std::vector<Eigen::Triplet<double> >& entries)
+    {
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+
+      bool linear = false;
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	linear = linear || constraintsTable_[i].linear;
+
+      if (!linear)
+	{
+	  linearMatrix_.resize (0, 0);
+	  linearOffset_.resize (0);
+	  return;
+	}
+
+      linearMatrix_.resize (constraintsOutputSize_, n);
+      linearMatrix_.setFromTriplets (entries.begin (), entries.end ());
+      linearMatrix_.makeCompressed ();
+
+      // Constant term: value at zero.
+      typename function_t::vector_t x = function_t::vector_t::Zero (n);
+      linearOffset_.setZero (constraintsOutputSize_);
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	{
+	  const ConstraintInfo& info = constraintsTable_[i];
+	  if (info.linear)
+	    (*info.function)
+	      (linearOffset_.segment (info.offset, info.outputSize), x);
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::restoreLinearJacobian (std::size_t constraint, EigenMatrixDense)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+
+      Eigen::Map<typename function_t::jacobian_t>
+	values_ (taskOutput_, constraintsOutputSize_, n);
+      values_.block (info.offset, 0, info.outputSize, n) =
+	linearJacobians_[constraint];
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalConstraintJacobian (std::size_t constraint, std::size_t,
+				     EigenMatrixDense)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+
+      Eigen::Map<const typename function_t::vector_t> x_ (taskX_, n);
+      Eigen::Map<typename function_t::jacobian_t>
+	values_ (taskOutput_, constraintsOutputSize_, n);
+
+      // Functions may only fill their structural nonzeros.
+      values_.block (info.offset, 0, info.outputSize, n).setZero ();
+      info.function->jacobian
+	(values_.block (info.offset, 0, info.outputSize, n), x_);
+
+      IpoptCheckGradient
+	(*info.function, 0, x_, static_cast<int> (constraint), solver_);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::structureSamplePoints
+    (std::vector<typename solver_t::vector_t>& points) const
+    {
+      typedef typename solver_t::problem_t::intervals_t intervals_t;
+
+      const intervals_t& bounds = solver_.argumentBounds ();
+      typename function_t::size_type
+	n = solver_.problem ().function ().inputSize ();
+      int samples =
+	pluginParameter (solver_, "ipopt.plugin.structure_samples", 3);
+
+      points.resize (static_cast<std::size_t> (std::max (samples, 1)));
+
+      typename solver_t::vector_t& start = points[0];
+      if (solver_.startingPoint ())
+	start = *solver_.startingPoint ();
+      else
+	start.setZero (n);
+
+      // Fixed seed: detected patterns must be reproducible.
+      boost::random::mt19937 generator (0);
+      boost::random::uniform_real_distribution<double> perturbation (-1., 1.);
+
+      for (std::size_t k = 0; k < points.size (); ++k)
+	{
+	  typename solver_t::vector_t& x = points[k];
+	  x = start;
+	  for (typename function_t::size_type i = 0; i < n; ++i)
+	    {
+	      if (k > 0)
+		x[i] += .1 * std::max (1., std::abs (x[i]))
+		  * perturbation (generator);
+	      const typename intervals_t::value_type&
+		bound = bounds[static_cast<std::size_t> (i)];
+	      x[i] = std::min (std::max (x[i], bound.first), bound.second);
+	    }
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupNonlinearVariables ()
+    {
+      typedef typename solver_t::sparsityPattern_t pattern_t;
+
+      std::size_t n = static_cast<std::size_t>
+	(solver_.problem ().function ().inputSize ());
+      bool detect =
+	pluginParameter (solver_, "ipopt.plugin.linear_variables", true);
+
+      std::vector<bool> nonlinear (n, !detect);
+      if (detect && solver_.hessianSparsityPattern ())
+	{
+	  const pattern_t& pattern = *solver_.hessianSparsityPattern ();
+	  for (int k = 0; k < pattern.outerSize (); ++k)
+	    for (typename pattern_t::InnerIterator it (pattern, k); it; ++it)
+	      {
+		nonlinear[static_cast<std::size_t> (it.row ())] = true;
+		nonlinear[static_cast<std::size_t> (it.col ())] = true;
+	      }
+	}
+      else if (detect)
+	detectNonlinearVariables (nonlinear);
+
+      nonlinearVariables_.clear ();
+      for (std::size_t j = 0; j < n; ++j)
+	if (nonlinear[j])
+	  nonlinearVariables_.push_back (static_cast<Index> (j));
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::detectNonlinearVariables (std::vector<bool>& nonlinear) const
+    {
+      // Sampled derivatives can only prove that a variable is
+      // nonlinear: kinks or curvature vanishing at all the samples are
+      // missed. Only use them on request, the structure otherwise.
+      if (!pluginParameter
+	  (solver_, "ipopt.plugin.sample_linear_variables", false))
+	{
+	  markStructureVariables (nonlinear, typename function_t::traits_t ());
+	  return;
+	}
+
+      std::vector<typename solver_t::vector_t> points;
+      structureSamplePoints (points);
+
+      // Linear constraints do not involve any nonlinear variable.
+      markNonlinearVariables (nonlinear, solver_.problem ().function (),
+			      points);
+      typedef typename constraintsTable_t::const_iterator citer_t;
+      for (citer_t it = constraintsTable_.begin ();
+	   it != constraintsTable_.end (); ++it)
+	if (!it->linear)
+	  markNonlinearVariables (nonlinear, *it->function, points);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::markHessianVariables (std::vector<bool>& nonlinear) const
+    {
+      for (std::size_t k = 0; k < hessianRows_.size (); ++k)
+	{
+	  nonlinear[static_cast<std::size_t> (hessianRows_[k])] = true;
+	  nonlinear[static_cast<std::size_t> (hessianCols_[k])] = true;
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::markStructureVariables (std::vector<bool>& nonlinear,
+				     EigenMatrixDense) const
+    {
+      // Dense derivatives have no structure.
+      std::fill (nonlinear.begin (), nonlinear.end (), true);
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::detectNonlinearVariables
+    (std::vector<bool>& nonlinear) const
+    {
+      markHessianVariables (nonlinear);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupCheckpoint (Index n, Index m)
+    {
+      checkpointPath_ =
+	pluginParameter (solver_, "ipopt.plugin.checkpoint_file",
+			 std::string ());
+      checkpointIterations_ =
+	pluginParameter (solver_, "ipopt.plugin.checkpoint_iterations", 10);
+      checkpointSeconds_ =
+	pluginParameter (solver_, "ipopt.plugin.checkpoint_seconds", 60.);
+      checkpointIteration_ = 0;
+      checkpointTime_ = boost::posix_time::microsec_clock::universal_time ();
+
+      if (checkpointPath_.empty ())
+	return;
+
+      checkpointFingerprint_ = solver_.problemFingerprint ();
+      checkpoint_.x.resize (n);
+      checkpoint_.lambda.resize (m);
+      checkpoint_.zL.resize (n);
+      checkpoint_.zU.resize (n);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::checkpoint (AlgorithmMode mode, Index iteration,
+			 const IpoptData* ip_data,
+			 IpoptCalculatedQuantities* ip_cq)
+    {
+      using namespace boost::posix_time;
+
+      // Restoration phase iterates are not worth resuming from.
+      if (checkpointPath_.empty () || mode != RegularMode
+	  || !ip_data || !ip_cq)
+	return;
+
+      ptime now = microsec_clock::universal_time ();
+      bool due = (checkpointIterations_ > 0
+		  && iteration - checkpointIteration_ >= checkpointIterations_)
+	|| (checkpointSeconds_ > 0.
+	    && static_cast<double> ((now - checkpointTime_)
+				    .total_microseconds ())
+	    >= 1e6 * checkpointSeconds_);
+      if (!due)
+	return;
+
+      OrigIpoptNLP* orignlp =
+	dynamic_cast<OrigIpoptNLP*> (GetRawPtr (ip_cq->GetIpoptNLP ()));
+      if (!orignlp)
+	return;
+      TNLPAdapter* adapter =
+	dynamic_cast<TNLPAdapter*> (GetRawPtr (orignlp->nlp ()));
+      if (!adapter)
+	return;
+
+      // Unscale the iterate as OrigIpoptNLP::FinalizeSolution does.
+      SmartPtr<const IteratesVector> curr = ip_data->curr ();
+      SmartPtr<NLPScalingObject> scaling = orignlp->NLP_scaling ();
+      SmartPtr<const Vector> x =
+	scaling->unapply_vector_scaling_x (curr->x ());
+      SmartPtr<const Vector> y_c =
+	scaling->apply_vector_scaling_c (curr->y_c ());
+      SmartPtr<const Vector> y_d =
+	scaling->apply_vector_scaling_d (curr->y_d ());
+      SmartPtr<const Vector> z_L = curr->z_L ();
+      SmartPtr<const Vector> z_U = curr->z_U ();
+      if (scaling->have_x_scaling ())
+	{
+	  z_L = scaling->apply_vector_scaling_x_LU
+	    (*orignlp->Px_L (), z_L, *orignlp->x_space ());
+	  z_U = scaling->apply_vector_scaling_x_LU
+	    (*orignlp->Px_U (), z_U, *orignlp->x_space ());
+	}
+
+      adapter->ResortX (*x, checkpoint_.x.data ());
+      adapter->ResortG (*y_c, *y_d, checkpoint_.lambda.data ());
+      adapter->ResortBnds (*z_L, checkpoint_.zL.data (),
+			   *z_U, checkpoint_.zU.data ());
+
+      Number factor = scaling->unapply_obj_scaling (1.);
+      checkpoint_.lambda *= factor;
+      checkpoint_.zL *= factor;
+      checkpoint_.zU *= factor;
+      checkpoint_.mu = ip_data->curr_mu ();
+      checkpoint_.iteration = iteration;
+
+      // Checkpoints are an optimization: failures are not fatal.
+      Checkpoint::save (checkpointPath_, checkpointFingerprint_, checkpoint_);
+      checkpointIteration_ = iteration;
+      checkpointTime_ = now;
+    }
+
+    template <typename T>
+    StructureCache::fingerprint_t
+    Tnlp<T>::structureFingerprint () const
+    {
+      std::size_t seed = solver_.problemFingerprint ();
+      boost::hash_combine
+	(seed, pluginParameter (solver_, "ipopt.plugin.structure_samples", 3));
+      return seed;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::openStructureCache ()
+    {
+      structureCache_.close ();
+      structureCachePath_ =
+	pluginParameter (solver_, "ipopt.plugin.structure_cache",
+			 std::string ());
+
+      // Declared patterns always take precedence.
+      if (structureCachePath_.empty ()
+	  || solver_.jacobianSparsityPattern ()
+	  || solver_.hessianSparsityPattern ())
+	{
+	  structureCachePath_.clear ();
+	  return;
+	}
+
+      structureFingerprint_ = structureFingerprint ();
+      structureCachePath_ =
+	StructureCache::path (structureCachePath_, structureFingerprint_);
+
+      // Structures extended during a solve replace the cached ones.
+      if (jacobianExtraEntries_.empty () && hessianExtraEntries_.empty ())
+	structureCache_.load (structureCachePath_, structureFingerprint_);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::saveStructureCache ()
+    {
+      if (structureCachePath_.empty ())
+	return;
+
+      // The cache is unmapped by the loaders when its content is
+      // rejected, so that the file is regenerated.
+      if (!structureCache_.isLoaded ())
+	{
+	  std::vector<StructureCache::Layout> layouts;
+	  jacobianLayouts (layouts, typename function_t::traits_t ());
+
+	  // The cache is an optimization: failures are not fatal.
+	  StructureCache::save (structureCachePath_, structureFingerprint_,
+				layouts, hessianRows_, hessianCols_);
+	}
+
+      structureCache_.close ();
+    }
+
+    template <typename T>
+    bool
+    Tnlp<T>::loadCachedHessianStructure ()
+    {
+      BOOST_STATIC_ASSERT
+	((boost::is_same<Index, StructureCache::index_t>::value));
+
+      if (!structureCache_.isLoaded ())
+	return false;
+
+      Index n = static_cast<Index> (solver_.problem ().function ().inputSize ());
+      std::size_t nnz = structureCache_.hessianNonZeros ();
+      const Index* rows = structureCache_.hessianRows ();
+      const Index* cols = structureCache_.hessianCols ();
+
+      // Lower triangle entries only.
+      for (std::size_t k = 0; k < nnz; ++k)
+	if (cols[k] < 0 || cols[k] > rows[k] || rows[k] >= n)
+	  {
+	    structureCache_.close ();
+	    return false;
+	  }
+
+      hessianRows_.assign (rows, rows + nnz);
+      hessianCols_.assign (cols, cols + nnz);
+      return true;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::jacobianLayouts (std::vector<StructureCache::Layout>& layouts,
+			      EigenMatrixDense) const
+    {
+      // Dense Jacobians have no structure to cache.
+      layouts.clear ();
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupHessianStructure ()
+    {
+      // Only twice differentiable problems provide Hessians.
+      hessianRows_.clear ();
+      hessianCols_.clear ();
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::setupHessianStructure ()
+    {
+      if (loadCachedHessianStructure ())
+	return;
+
+      function_t::size_type n = solver_.problem ().function ().inputSize ();
+
+      // Structural nonzeros (only the lower triangle is used).
+      Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
+	mask = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Zero (n, n);
+
+      if (solver_.hessianSparsityPattern ())
+	{
+	  typedef solver_t::sparsityPattern_t pattern_t;
+	  const pattern_t& pattern = *solver_.hessianSparsityPattern ();
+	  if (pattern.rows () != n || pattern.cols () != n)
+	    throw std::runtime_error ("invalid Hessian sparsity pattern size");
+
+	  for (int k = 0; k < pattern.outerSize (); ++k)
+	    for (pattern_t::InnerIterator it (pattern, k); it; ++it)
+	      mask (std::max (it.row (), it.col ()),
+		    std::min (it.row (), it.col ())) = true;
+	}
+      else if (finiteDifferenceHessian_)
+	{
+	  // Hessians are not available: detect the structure from
+	  // gradients differences, at the price of n + 1 Jacobians of
+	  // each function per sample point.
+	  std::vector<solver_t::vector_t> points;
+	  structureSamplePoints (points);
+
+	  for (std::size_t k = 0; k < points.size (); ++k)
+	    {
+	      markGradientDifferences
+		(mask, solver_.problem ().function (), points[k],
+		 finiteDifferenceStep_);
+
+	      typedef constraintsTable_t::const_iterator citer_t;
+	      for (citer_t it = constraintsTable_.begin ();
+		   it != constraintsTable_.end (); ++it)
+		if (!it->linear)
+		  markGradientDifferences
+		    (mask, *it->function, points[k], finiteDifferenceStep_);
+	    }
+	}
+      else
+	{
+	  std::vector<solver_t::vector_t> points;
+	  structureSamplePoints (points);
+
+	  for (std::size_t k = 0; k < points.size (); ++k)
+	    {
+	      costHessian_.setZero ();
+	      solver_.problem ().function ().hessian
+		(costHessian_, points[k], 0);
+	      mask = (mask.array () || (costHessian_.array () != 0.)).matrix ();
+
+	      typedef constraintsTable_t::const_iterator citer_t;
+	      // Linear constraints have no Hessian.
+	      for (citer_t it = constraintsTable_.begin ();
+		   it != constraintsTable_.end (); ++it)
+		for (function_t::size_type r = 0;
+		     !it->linear && r < it->outputSize; ++r)
+		  {
+		    costHessian_.setZero ();
+		    it->function->hessian (costHessian_, points[k], r);
+		    mask =
+		      (mask.array () || (costHessian_.array () != 0.)).matrix ();
+		  }
+	    }
+	}
+
+      // Nonzeros missed by the sample points (declared patterns are
+      // never extended).
+      for (std::size_t k = 0; k < hessianExtraEntries_.size (); ++k)
+	mask (hessianExtraEntries_[k].first,
+	      hessianExtraEntries_[k].second) = true;
+
+      hessianRows_.clear ();
+      hessianCols_.clear ();
+      for (function_t::size_type j = 0; j < n; ++j)
+	for (function_t::size_type i = j; i < n; ++i)
+	  if (mask (i, j))
+	    {
+	      hessianRows_.push_back (static_cast<Index> (i));
+	      hessianCols_.push_back (static_cast<Index> (j));
+	    }
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupFiniteDifferenceHessian ()
+    {
+      // Only twice differentiable problems provide Hessians.
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::setupFiniteDifferenceHessian ()
+    {
+      HessianColoring& coloring = hessianColoring_;
+      coloring = HessianColoring ();
+      if (!finiteDifferenceHessian_)
+	return;
+
+      function_t::size_type n = solver_.problem ().function ().inputSize ();
+      int size = static_cast<int> (n);
+
+      // Adjacency graph of the structure (diagonal excluded).
+      std::vector<int> offsets (static_cast<std::size_t> (size) + 1, 0);
+      for (std::size_t k = 0; k < hessianRows_.size (); ++k)
+	if (hessianRows_[k] != hessianCols_[k])
+	  {
+	    ++offsets[static_cast<std::size_t> (hessianRows_[k]) + 1];
+	    ++offsets[static_cast<std::size_t> (hessianCols_[k]) + 1];
+	  }
+      for (int i = 0; i < size; ++i)
+	offsets[i + 1] += offsets[i];
+
+      std::vector<int> neighbors (static_cast<std::size_t> (offsets.back ()));
+      std::vector<int> next (offsets.begin (), offsets.end () - 1);
+      for (std::size_t k = 0; k < hessianRows_.size (); ++k)
+	if (hessianRows_[k] != hessianCols_[k])
+	  {
+	    neighbors[next[hessianRows_[k]]++] = hessianCols_[k];
+	    neighbors[next[hessianCols_[k]]++] = hessianRows_[k];
+	  }
+
+      std::vector<int> colors;
+      int count = starColoring (size, offsets, neighbors, colors);
+
+      coloring.colorOffsets.assign (static_cast<std::size_t> (count) + 1, 0);
+      for (int j = 0; j < size; ++j)
+	++coloring.colorOffsets[static_cast<std::size_t> (colors[j]) + 1];
+      for (int c = 0; c < count; ++c)
+	coloring.colorOffsets[c + 1] += coloring.colorOffsets[c];
+      coloring.colorColumns.resize (static_cast<std::size_t> (size));
+      next.assign (coloring.colorOffsets.begin (),
+		   coloring.colorOffsets.end () - 1);
+      for (int j = 0; j < size; ++j)
+	coloring.colorColumns[next[colors[j]]++] = j;
+
+      // Entry (i, j) is read in the product of the color of j at row i
+      // if no other neighbor of i has this color, otherwise (star
+      // coloring) in the product of the color of i at row j.
+      std::size_t nnz = hessianRows_.size ();
+      coloring.sourceColors.resize (nnz);
+      coloring.sourceRows.resize (nnz);
+      coloring.sourceColumns.resize (nnz);
+      for (std::size_t k = 0; k < nnz; ++k)
+	{
+	  int i = hessianRows_[k];
+	  int j = hessianCols_[k];
+
+	  bool direct = true;
+	  for (int p = offsets[i]; direct && p < offsets[i + 1]; ++p)
+	    direct = neighbors[p] == j || colors[neighbors[p]] != colors[j];
+
+	  if (!direct)
+	    std::swap (i, j);
+	  coloring.sourceColors[k] = colors[j];
+	  coloring.sourceRows[k] = i;
+	  coloring.sourceColumns[k] = j;
+	}
+
+      function_t::size_type outputSize = 0;
+      for (std::size_t i = 0; i < constraintsTable_.size (); ++i)
+	if (!constraintsTable_[i].linear)
+	  outputSize = std::max (outputSize, constraintsTable_[i].outputSize);
+
+      std::size_t workers = threadPool_ ? threadPool_->size () : 1;
+      finiteDifferenceArguments_.resize (workers);
+      finiteDifferenceJacobians_.resize (workers);
+      finiteDifferenceProducts_.resize (workers);
+      for (std::size_t w = 0; w < workers; ++w)
+	{
+	  finiteDifferenceArguments_[w].resize (n);
+	  finiteDifferenceJacobians_[w].resize (outputSize, n);
+	  finiteDifferenceProducts_[w].resize (n, count + 1);
+	}
+      finiteDifferenceGradient_.resize (n);
+      finiteDifferenceSteps_.resize (n);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupHessianEvaluation ()
+    {
+      // Only twice differentiable problems provide Hessians.
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::setupHessianEvaluation ()
+    {
+      function_t::size_type n = solver_.problem ().function ().inputSize ();
+      std::size_t workers = threadPool_ ? threadPool_->size () : 1;
+
+      finiteDifferenceHessian_ =
+	pluginParameter (solver_, "ipopt.plugin.finite_difference_hessian",
+			 false);
+      finiteDifferenceStep_ =
+	pluginParameter (solver_, "ipopt.plugin.finite_difference_step", 1e-8);
+
+      // Finite differences do not use the Hessians buffers.
+      cacheHessians_ = !finiteDifferenceHessian_
+	&& pluginParameter (solver_, "ipopt.plugin.cache_hessians", true);
+      if (finiteDifferenceHessian_)
+	workers = 0;
+
+      // Scanning a whole Hessian for nonzeros outside of the structure
+      // costs O(n²) per row: a detected structure is only checked by
+      // its first evaluation, and a declared one never, unless asked.
+      checkHessianStructure_ =
+	pluginParameter (solver_, "ipopt.plugin.check_hessian_structure",
+			 false);
+      hessianStructureUnchecked_ = !solver_.hessianSparsityPattern ();
+
+      hessiansCost_ = constraintsCost_;
+      hessianWeightsCost_ = constraintsCost_;
+      costHessian_.resize (n, n);
+      setupHessianStructure ();
+      setupFiniteDifferenceHessian ();
+
+      // Evaluation buffers are cleared here, and before checked
+      // evaluations: otherwise, only their structural nonzeros are
+      // read, and reset.
+      function_t::size_type nnz =
+	static_cast<function_t::size_type> (hessianRows_.size ());
+      costHessian_.setZero ();
+      costHessianValues_.resize (nnz);
+      hessianValues_.resize (workers);
+      hessianScratch_.resize (workers);
+      for (std::size_t w = 0; w < workers; ++w)
+	{
+	  hessianValues_[w].resize (nnz);
+	  hessianScratch_[w].setZero (n, n);
+	}
+
+      // Keep the structural nonzeros of each constraint Hessian, one
+      // column per row.
+      constraintHessians_.resize
+	(cacheHessians_ ? constraintsTable_.size () : 0);
+      for (std::size_t i = 0; i < constraintHessians_.size (); ++i)
+	{
+	  // Linear constraints have no Hessian to keep.
+	  const ConstraintInfo& info = constraintsTable_[i];
+	  constraintHessians_[i].resize (info.linear ? 0 : nnz,
+					 info.linear ? 0 : info.outputSize);
+	}
+
+      // Otherwise, a single such block per worker, for the constraint
+      // being evaluated.
+      function_t::size_type outputSize = 0;
+      for (std::size_t i = 0; !cacheHessians_ && i < constraintsTable_.size ();
+	   ++i)
+	if (!constraintsTable_[i].linear)
+	  outputSize = std::max (outputSize, constraintsTable_[i].outputSize);
+      hessianRowValues_.resize (cacheHessians_ ? 0 : workers);
+      for (std::size_t w = 0; w < hessianRowValues_.size (); ++w)
+	hessianRowValues_[w].resize (nnz, outputSize);
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalFiniteDifferenceHessianTask (std::size_t, std::size_t)
+    {
+      // Only twice differentiable problems provide Hessians.
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::evalFiniteDifferenceHessianTask
+    (std::size_t constraint, std::size_t worker)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+
+      // Linear constraints do not contribute to the Hessian.
+      if (info.linear)
+	return;
+
+      const HessianColoring& coloring = hessianColoring_;
+      Eigen::Map<const function_t::vector_t>
+	x_ (taskX_, solver_.problem ().function ().inputSize ());
+      Eigen::Map<const function_t::vector_t>
+	lambda_ (taskLambda_ + info.offset, info.outputSize);
+      function_t::vector_t& argument = finiteDifferenceArguments_[worker];
+      function_t::matrix_t& jac = finiteDifferenceJacobians_[worker];
+      function_t::matrix_t& products = finiteDifferenceProducts_[worker];
+
+      // Column 0: weighted gradients at x, column c + 1: at x plus the
+      // steps of the color c.
+      for (std::size_t c = 0; c < coloring.colorOffsets.size (); ++c)
+	{
+	  argument = x_;
+	  for (int p = c > 0 ? coloring.colorOffsets[c - 1] : 0;
+	       c > 0 && p < coloring.colorOffsets[c]; ++p)
+	    {
+	      int j = coloring.colorColumns[p];
+	      argument[j] += finiteDifferenceSteps_[j];
+	    }
 
-    /// \internal
-#ifdef ROBOPTIM_CORE_IPOPT_PLUGIN_CHECK_GRADIENT
-    template <typename T, typename F>
-    void IpoptCheckGradient (const F& function,
-			     unsigned functionId,
-			     Eigen::Map<const Function::vector_t>& x,
-			     int constraintId,
-			     T& solver)
+	  jac.topRows (info.outputSize).setZero ();
+	  info.function->jacobian (jac.topRows (info.outputSize), argument);
+	  products.col (static_cast<function_t::size_type> (c)).noalias () +=
+	    jac.topRows (info.outputSize).transpose () * lambda_;
+	}
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::computeFiniteDifferenceHessian
+    (Number* values,
+     Index n, const Number* x,
+     Number obj_factor,
+     const Number* lambda)
     {
-      using boost::format;
-      try
+      const HessianColoring& coloring = hessianColoring_;
+      Eigen::Map<const solver_t::vector_t> x_ (x, n);
+
+      // Representable steps.
+      for (Index j = 0; j < n; ++j)
+	finiteDifferenceSteps_[j] =
+	  (x_[j] + finiteDifferenceStep_ * std::max (1., std::abs (x_[j])))
+	  - x_[j];
+
+      for (std::size_t w = 0; w < finiteDifferenceProducts_.size (); ++w)
+	finiteDifferenceProducts_[w].setZero ();
+
+      taskX_ = x;
+      taskLambda_ = lambda;
+      runConstraintsTask (evalFiniteDifferenceHessianTask_, hessiansCost_);
+
+      function_t::matrix_t& products = finiteDifferenceProducts_[0];
+      for (std::size_t w = 1; w < finiteDifferenceProducts_.size (); ++w)
+	products += finiteDifferenceProducts_[w];
+
+      function_t::vector_t& argument = finiteDifferenceArguments_[0];
+      for (std::size_t c = 0; c < coloring.colorOffsets.size (); ++c)
 	{
-	  checkGradientAndThrow (function, functionId, x, 1.);
+	  argument = x_;
+	  for (int p = c > 0 ? coloring.colorOffsets[c - 1] : 0;
+	       c > 0 && p < coloring.colorOffsets[c]; ++p)
+	    {
+	      int j = coloring.colorColumns[p];
+	      argument[j] += finiteDifferenceSteps_[j];
+	    }
+
+	  solver_.problem ().function ().gradient
+	    (finiteDifferenceGradient_, argument, 0);
+	  products.col (static_cast<function_t::size_type> (c)) +=
+	    obj_factor * finiteDifferenceGradient_;
 	}
-      catch (BadGradient& bg)
+
+      for (std::size_t k = 0; k < hessianRows_.size (); ++k)
 	{
-	  solver.invalidateGradient ();
-	  std::cerr
-	    << ((functionId < 0)
-		? "Invalid cost function gradient:"
-		: (format ("Invalid constraint function gradient (id = %1%):")
-		   % constraintId).str ())
-	    << std::endl
-	    << function.getName ()
-	    << std::endl
-	    << bg
-	    << std::endl;
+	  int i = coloring.sourceRows[k];
+	  int c = coloring.sourceColors[k] + 1;
+	  values[k] = (products (i, c) - products (i, 0))
+	    / finiteDifferenceSteps_[coloring.sourceColumns[k]];
 	}
     }
-#else
-    template <typename T, typename F>
-    void IpoptCheckGradient (const F&,
-			     unsigned,
-			     Eigen::Map<const Function::vector_t>&,
-			     int,
-			     T&)
-    {}
-#endif //!ROBOPTIM_CORE_IPOPT_PLUGIN_CHECK_GRADIENT
-
 
+    template <typename T>
     void
-    jacobianFromGradients
-    (DerivableFunction::matrix_t& jac,
-     const IpoptSolver::problem_t::constraints_t& c,
-     const DerivableFunction::vector_t& x);
+    Tnlp<T>::weightConstraintHessianTask (std::size_t, std::size_t)
+    {
+      // Only twice differentiable problems provide Hessians.
+    }
 
-    template  <typename T>
-    Function::size_type
-    computeConstraintsOutputSize (const T& solver)
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::weightConstraintHessianTask
+    (std::size_t constraint, std::size_t worker)
     {
-      using namespace boost;
+      const ConstraintInfo& info = constraintsTable_[constraint];
 
-      BOOST_MPL_ASSERT_RELATION
-	( (boost::mpl::size<typename T::problem_t::constraintsList_t>::value),
-	  ==, 2);
-
-      // Non-linear function type is supposed to be the second
-      // constraint type and the linear function type is the
-      // first.
-      typedef typename
-	mpl::at<typename T::problem_t::constraintsList_t,
-		mpl::int_<1> >::type
-	nonLinearFunction_t;
-
-      typedef typename
-	mpl::at<typename T::problem_t::constraintsList_t,
-		mpl::int_<0> >::type
-	linearFunction_t;
-
-      Function::size_type result = 0;
-      typedef typename T::problem_t::constraints_t::const_iterator citer_t;
-      for (citer_t it = solver.problem ().constraints ().begin ();
-	   it != solver.problem ().constraints ().end (); ++it)
-	{
-	  shared_ptr<typename T::commonConstraintFunction_t> g;
-	  if (it->which () == IpoptSolver::LINEAR)
-	    g = get<shared_ptr<linearFunction_t> > (*it);
-	  else
-	    g = get<shared_ptr<nonLinearFunction_t> > (*it);
-	  result += g->outputSize ();
+      // Linear constraints do not contribute to the Hessian.
+      if (info.linear)
+	return;
+
+      Eigen::Map<const function_t::vector_t>
+	lambda_ (taskLambda_ + info.offset, info.outputSize);
+      hessianValues_[worker].noalias () +=
+	constraintHessians_[constraint] * lambda_;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::evalConstraintHessianTask (std::size_t, std::size_t)
+    {
+      // Only twice differentiable problems provide Hessians.
+    }
+
+    template <>
+    inline void
+    Tnlp<IpoptSolverTd>::evalConstraintHessianTask
+    (std::size_t constraint, std::size_t worker)
+    {
+      const ConstraintInfo& info = constraintsTable_[constraint];
+
+      // Linear constraints do not contribute to the Hessian.
+      if (info.linear)
+	return;
+
+      Eigen::Map<const function_t::argument_t>
+	x_ (taskX_, solver_.problem ().function ().inputSize ());
+      function_t::matrix_t& h = hessianScratch_[worker];
+
+      // RobOptim evaluates the Hessian of one row at a time. Only the
+      // structural nonzeros of each row are read, in one column per
+      // row: all the rows are then weighted by their multipliers at
+      // once. These columns are kept if Hessians are cached.
+      function_t::matrix_t& rows = cacheHessians_
+	? constraintHessians_[constraint] : hessianRowValues_[worker];
+      bool check = checkHessianStructure_ || hessianStructureUnchecked_;
+      for (function_t::size_type r = 0; r < info.outputSize; ++r)
+	{
+	  // Unchecked evaluations may have left nonzeros outside of the
+	  // structure.
+	  if (check)
+	    h.setZero ();
+	  info.function->hessian (h, x_, r);
+	  extractLowerStructure (rows.col (r), h, hessianRows_, hessianCols_);
+
+	  // The structural nonzeros have been reset: any nonzero left
+	  // lies outside of the structure.
+	  structureEntries_t outside;
+	  if (check && findLowerNonZeros (outside, h))
+	    hessianStructureError (info.function->getName (),
+				   static_cast<int> (constraint), r, outside);
 	}
-      return result;
+
+      Eigen::Map<const function_t::vector_t>
+	lambda_ (taskLambda_ + info.offset, info.outputSize);
+      hessianValues_[worker].noalias () +=
+	rows.leftCols (info.outputSize) * lambda_;
     }
 
     template <typename T>
-    Tnlp<T>::Tnlp (const typename solver_t::problem_t& pb, solver_t& solver)
-      : solver_ (solver),
-        solverState_ (pb),
-	cost_ (),
-	costGradient_ (),
-	constraints_ (),
-	jacobian_ (),
-	constraintJacobians_ ()
+    void
+    Tnlp<T>::updateIterate (Index n, const Number* x, bool new_x)
     {
-      BOOST_MPL_ASSERT_RELATION
-	( (boost::mpl::size<
-           typename solver_t::problem_t::constraintsList_t>::value), ==, 2);
+      // Ipopt guarantees that x did not change since the last call.
+      if (!new_x && cache_.x.size () == n)
+	return;
+
+      // Ipopt may also flag a point as new while coming back to an
+      // already evaluated one (e.g. line search backtracking).
+      std::size_t fingerprint = boost::hash_range (x, x + n);
+      if (cache_.x.size () == n && cache_.fingerprint == fingerprint
+	  && std::memcmp (cache_.x.data (), x,
+			  static_cast<std::size_t> (n) * sizeof (Number)) == 0)
+	return;
+
+      cache_.x = Eigen::Map<const typename function_t::vector_t> (x, n);
+      cache_.fingerprint = fingerprint;
+      std::fill (cache_.valid,
+		 cache_.valid + IpoptCacheStatistics::NB_QUANTITIES, false);
     }
 
     template <typename T>
-    Function::size_type
-    Tnlp<T>::constraintsOutputSize ()
+    void
+    Tnlp<T>::invalidateIterate ()
     {
-      return computeConstraintsOutputSize (solver_);
+      cache_.x.resize (0);
+      cache_.fingerprint = 0;
+      std::fill (cache_.valid,
+		 cache_.valid + IpoptCacheStatistics::NB_QUANTITIES, false);
     }
 
-    template <>
+    template <typename T>
+    void
+    Tnlp<T>::beginSolve ()
+    {
+      if (optimization_ == solver_.optimizations_)
+	return;
+      optimization_ = solver_.optimizations_;
+
+      // Function values may have changed since the previous solve.
+      invalidateIterate ();
+      evaluationFailed_ = false;
+      setupCheckpoint
+	(static_cast<Index> (solver_.problem ().function ().inputSize ()),
+	 static_cast<Index> (constraintsOutputSize ()));
+    }
+
+    template <typename T>
+    bool
+    Tnlp<T>::reportError (const std::runtime_error& error)
+    {
+      // Ipopt would only report that an exception was thrown: keep
+      // its message in the result instead.
+      solver_.result_ = SolverError (error.what ());
+      evaluationFailed_ = true;
+      return false;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::jacobianStructureError (std::size_t constraint,
+				     const structureEntries_t& entries)
+    {
+      assert (!entries.empty ());
+      const ConstraintInfo& info = constraintsTable_[constraint];
+
+      // Detected structures may miss nonzeros which only appear far
+      // from the sample points: extend them rather than failing.
+      if (!solver_.jacobianSparsityPattern ())
+	{
+	  boost::mutex::scoped_lock lock (structureMutex_);
+	  jacobianExtraEntries_.insert (jacobianExtraEntries_.end (),
+					entries.begin (), entries.end ());
+	  solver_.structureExtended_ = true;
+	}
+
+      std::ostringstream error;
+      error << "the Jacobian of constraint " << constraint
+	    << " (" << info.function->getName () << ")"
+	    << " has a nonzero at (" << entries[0].first - info.offset
+	    << ", " << entries[0].second << ") outside of its sparsity pattern";
+      throw std::runtime_error (error.str ());
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::hessianStructureError (const std::string& name, int constraint,
+				    Function::size_type functionRow,
+				    const structureEntries_t& entries)
+    {
+      assert (!entries.empty ());
+
+      if (!solver_.hessianSparsityPattern ())
+	{
+	  boost::mutex::scoped_lock lock (structureMutex_);
+	  hessianExtraEntries_.insert (hessianExtraEntries_.end (),
+				       entries.begin (), entries.end ());
+	  solver_.structureExtended_ = true;
+	}
+
+      std::ostringstream error;
+      error << "the Hessian of ";
+      if (constraint < 0)
+	error << "the cost function";
+      else
+	error << "row " << functionRow << " of constraint " << constraint;
+      error << " (" << name << ") has a nonzero at (" << entries[0].first
+	    << ", " << entries[0].second
+	    << ") outside of the Hessian sparsity pattern";
+      throw std::runtime_error (error.str ());
+    }
+
+    template <typename T>
     bool
-    Tnlp<IpoptSolverSparse>::get_nlp_info (Index& n, Index& m, Index& nnz_jac_g,
-					   Index& nnz_h_lag,
-					   TNLP::IndexStyleEnum& index_style);
+    Tnlp<T>::isCached (quantity_t quantity)
+    {
+      if (cache_.valid[quantity])
+	{
+	  ++solver_.cacheStatistics_.hits[quantity];
+	  return true;
+	}
+      ++solver_.cacheStatistics_.misses[quantity];
+      return false;
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setCached (quantity_t quantity)
+    {
+      cache_.valid[quantity] = true;
+    }
 
     template <typename T>
     bool
     Tnlp<T>::get_nlp_info (Index& n, Index& m, Index& nnz_jac_g,
                            Index& nnz_h_lag, TNLP::IndexStyleEnum& index_style)
     {
-      n = static_cast<Index> (solver_.problem ().function ().inputSize ());
-      m = static_cast<Index> (constraintsOutputSize ());
-      nnz_jac_g = n * m;
-      nnz_h_lag = n * (n + 1) / 2;
-      index_style = TNLP::C_STYLE;
-      return true;
+      try
+	{
+	  buildConstraintsTable ();
+	  beginSolve ();
+	  openStructureCache ();
+	  setupParallelEvaluation ();
+	  setupHessianEvaluation ();
+
+	  n = static_cast<Index> (solver_.problem ().function ().inputSize ());
+	  m = static_cast<Index> (constraintsOutputSize ());
+	  setupJacobianStructure (typename function_t::traits_t ());
+	  saveStructureCache ();
+	  setupLinearJacobians (typename function_t::traits_t ());
+	  setupNonlinearVariables ();
+	  nnz_jac_g = jacobianNonZeros (typename function_t::traits_t ());
+	  nnz_h_lag = static_cast<Index> (hessianRows_.size ());
+	  index_style = TNLP::C_STYLE;
+	  return true;
+	}
+      catch (const std::runtime_error& error)
+	{
+	  return reportError (error);
+	}
+    }
+
+    template <typename T>
+    void
+    Tnlp<T>::setupJacobianStructure (EigenMatrixDense)
+    {
+      // Dense Jacobians are written directly in Ipopt's buffer, which
+      // Ipopt already keeps per iterate: a copy is only kept on demand.
+      cacheJacobian_ =
+	pluginParameter (solver_, "ipopt.plugin.cache_dense_jacobian", false);
+      if (!cacheJacobian_)
+	constraintsJacobian_.reset ();
+    }
+
+    template <typename T>
+    Index
+    Tnlp<T>::jacobianNonZeros (EigenMatrixDense)
+    {
+      return static_cast<Index>
+	(solver_.problem ().function ().inputSize ()
+	 * constraintsOutputSize ());
     }
 
     template <typename T>
@@ -178,16 +1658,18 @@ namespace roboptim
       assert (solver_.problem ().function ().inputSize () - n == 0);
       assert (constraintsOutputSize () - m == 0);
 
+      beginSolve ();
+
       typedef IpoptSolver::problem_t::intervals_t::const_iterator citer_t;
-      for (citer_t it = solver_.problem ().argumentBounds ().begin ();
-	   it != solver_.problem ().argumentBounds ().end (); ++it)
+      for (citer_t it = solver_.argumentBounds ().begin ();
+	   it != solver_.argumentBounds ().end (); ++it)
 	*(x_l++) = (*it).first, *(x_u++) = (*it).second;
 
       typedef IpoptSolver::problem_t::intervalsVect_t::const_iterator
 	citerVect_t;
 
-      for (citerVect_t it = solver_.problem ().boundsVector ().begin ();
-	   it != solver_.problem ().boundsVector ().end (); ++it)
+      for (citerVect_t it = solver_.boundsVector ().begin ();
+	   it != solver_.boundsVector ().end (); ++it)
 	for (citer_t it2 = it->begin (); it2 != it->end (); ++it2)
 	  *(g_l++) = it2->first, *(g_u++) = it2->second;
       return true;
@@ -199,24 +1681,26 @@ namespace roboptim
                                      bool& use_x_scaling,
                                      Index ROBOPTIM_DEBUG_ONLY(n),
                                      Number* x_scaling,
-                                     bool& use_g_scaling, Index m,
+                                     bool& use_g_scaling,
+                                     Index ROBOPTIM_DEBUG_ONLY(m),
                                      Number* g_scaling)
     {
       ROBOPTIM_DEBUG_ONLY(std::size_t n_ = static_cast<std::size_t> (n));
-      std::size_t m_ = static_cast<std::size_t> (m);
 
-      assert (solver_.problem ().argumentScaling ().size () == n_);
+      assert (solver_.argumentScaling ().size () == n_);
+      assert (constraintsOutputSize () - m == 0);
 
       use_x_scaling = true, use_g_scaling = true;
-      std::copy (solver_.problem ().argumentScaling ().begin (),
-		 solver_.problem ().argumentScaling ().end (),
+      std::copy (solver_.argumentScaling ().begin (),
+		 solver_.argumentScaling ().end (),
 		 x_scaling);
 
 
-      for (std::size_t i = 0; i < m_; ++i)
-        for (std::size_t j = 0;
-             j < solver_.problem ().scalingVector ()[i].size (); ++j)
-          g_scaling[i] = solver_.problem ().scalingVector ()[i][j];
+      // One scale per constraint row.
+      typedef typename solver_t::scalesVect_t::const_iterator citer_t;
+      for (citer_t it = solver_.scalingVector ().begin ();
+	   it != solver_.scalingVector ().end (); ++it)
+	g_scaling = std::copy (it->begin (), it->end (), g_scaling);
       return true;
     }
 
@@ -225,9 +1709,10 @@ namespace roboptim
     Tnlp<T>::get_variables_linearity (Index n, LinearityType* var_types)
     {
       assert (solver_.problem ().function ().inputSize () - n == 0);
-      //FIXME: detect from problem.
-      for (Index i = 0; i < n; ++i)
-	var_types[i] = TNLP::NON_LINEAR;
+
+      std::fill (var_types, var_types + n, TNLP::LINEAR);
+      for (std::size_t k = 0; k < nonlinearVariables_.size (); ++k)
+	var_types[nonlinearVariables_[k]] = TNLP::NON_LINEAR;
       return true;
     }
 
@@ -236,65 +1721,83 @@ namespace roboptim
     Tnlp<T>::get_constraints_linearity (Index ROBOPTIM_DEBUG_ONLY(m),
                                      LinearityType* const_types)
     {
-      using namespace boost;
-
       assert (constraintsOutputSize () - m == 0);
 
-      typedef typename solver_t::problem_t::constraints_t::const_iterator
-	citer_t;
-
-      unsigned idx = 0;
-      for (citer_t it = solver_.problem ().constraints ().begin ();
-	   it != solver_.problem ().constraints ().end (); ++it)
-
-	{
-	  LinearityType type =
-	    (it->which () == LINEAR) ? TNLP::LINEAR : TNLP::NON_LINEAR;
-	  shared_ptr<typename solver_t::commonConstraintFunction_t> g;
-	  if (type == LINEAR)
-	    g = get<shared_ptr<linearFunction_t> > (*it);
-	  else
-	    g = get<shared_ptr<nonLinearFunction_t> > (*it);
+      typedef typename constraintsTable_t::const_iterator citer_t;
 
-	  for (Function::size_type j = 0; j < g->outputSize (); ++j)
-	    const_types[idx++] = type;
-	}
+      for (citer_t it = constraintsTable_.begin ();
+	   it != constraintsTable_.end (); ++it)
+	std::fill (const_types + it->offset,
+		   const_types + it->offset + it->outputSize,
+		   it->linear ? TNLP::LINEAR : TNLP::NON_LINEAR);
       return true;
     }
 
     template <typename T>
     bool
     Tnlp<T>::get_starting_point (Index n, bool init_x, Number* x, bool init_z,
-                                 Number* z_L, Number* z_U, Index ROBOPTIM_DEBUG_ONLY(m),
-                                 bool ROBOPTIM_DEBUG_ONLY(init_lambda), Number*)
+                                 Number* z_L, Number* z_U, Index m,
+                                 bool init_lambda, Number* lambda)
     {
       assert (solver_.problem ().function ().inputSize () - n == 0);
       assert (constraintsOutputSize () - m == 0);
 
-      //FIXME: handle all modes.
-      assert(init_lambda == false);
+      const boost::optional<IpoptIterate>& warmStart =
+	solver_.startingIterate ();
+      if (warmStart
+	  && (warmStart->x.size () != n || warmStart->lambda.size () != m
+	      || (warmStart->zL.size () != 0 && warmStart->zL.size () != n)
+	      || (warmStart->zU.size () != 0 && warmStart->zU.size () != n)))
+	{
+	  solver_.result_ =
+	    SolverError ("Ipopt warm start does not match the problem size.");
+	  return false;
+	}
 
       // Set bound multipliers.
       if (init_z)
 	{
+	  Eigen::Map<Function::vector_t> zL_ (z_L, n);
+	  Eigen::Map<Function::vector_t> zU_ (z_U, n);
+
 	  //FIXME: for now, if required, scale is one.
 	  //When do we need something else?
-	  for (Index i = 0; i < n; ++i)
-	    z_L[i] = 1., z_U[i] = 1.;
+	  zL_.setOnes ();
+	  zU_.setOnes ();
+	  if (warmStart && warmStart->zL.size () != 0)
+	    zL_ = warmStart->zL;
+	  if (warmStart && warmStart->zU.size () != 0)
+	    zU_ = warmStart->zU;
+	}
+
+      // Set constraints multipliers.
+      if (init_lambda)
+	{
+	  Eigen::Map<Function::vector_t> lambda_ (lambda, m);
+	  if (warmStart)
+	    lambda_ = warmStart->lambda;
+	  else
+	    lambda_.setZero ();
+	}
+
+      Eigen::Map<Function::vector_t> x_ (x, n);
+      if (warmStart)
+	{
+	  x_ = warmStart->x;
+	  return true;
 	}
 
       // Set the starting point.
-      if (!solver_.problem ().startingPoint () && init_x)
+      if (!solver_.startingPoint () && init_x)
 	{
 	  solver_.result_ =
 	    SolverError ("Ipopt method needs a starting point.");
 	  return false;
 	}
-      if (!solver_.problem ().startingPoint ())
+      if (!solver_.startingPoint ())
 	return true;
 
-      Eigen::Map<Function::result_t> x_ (x, n);
-      x_ = *solver_.problem ().startingPoint ();
+      x_ = *solver_.startingPoint ();
       return true;
     }
 
@@ -302,26 +1805,33 @@ namespace roboptim
     bool
     Tnlp<T>::get_warm_start_iterate (IteratesVector&)
     {
-      //FIXME: implement this.
       //IteratesVector is defined in src/Algorithm/IteratesVector.hpp
-      //and is not distributed (not a distributed header).
-      //Hence, seems difficult to manipulate this type.
-      //Idea 1: offer the possibility either to retrive this data after
-      //solving a problem.
-      //Idea 2: creating this type manually from problem + rough guess
-      //(or previous solution).
+      //and is not distributed (not a distributed header). Warm starts
+      //go through get_starting_point instead (see
+      //IpoptSolverCommon::setWarmStart).
       return false;
     }
 
     template <typename T>
     bool
-    Tnlp<T>::eval_f (Index n, const Number* x, bool, Number& obj_value)
+    Tnlp<T>::eval_f (Index n, const Number* x, bool new_x, Number& obj_value)
     {
       assert (solver_.problem ().function ().inputSize () - n == 0);
 
-      cost_ = typename function_t::vector_t (1);
-      Eigen::Map<const typename function_t::argument_t> x_ (x, n);
-      solver_.problem ().function () (*cost_, x_);
+      updateIterate (n, x, new_x);
+      if (!isCached (IpoptCacheStatistics::COST))
+	{
+	  if (!cost_)
+	    {
+	      MallocAllowedScope allocation (true);
+	      cost_ = typename function_t::result_t (1);
+	    }
+
+	  MallocAllowedScope allocation (false);
+	  Eigen::Map<const typename function_t::argument_t> x_ (x, n);
+	  solver_.problem ().function () (*cost_, x_);
+	  setCached (IpoptCacheStatistics::COST);
+	}
 
       obj_value = (*cost_)[0];
       return true;
@@ -329,19 +1839,29 @@ namespace roboptim
 
     template <typename T>
     bool
-    Tnlp<T>::eval_grad_f (Index n, const Number* x, bool, Number* grad_f)
+    Tnlp<T>::eval_grad_f (Index n, const Number* x, bool new_x,
+			  Number* grad_f)
     {
       assert (solver_.problem ().function ().inputSize () - n == 0);
 
-      if (!costGradient_)
-	costGradient_ = typename function_t::gradient_t
-	  (solver_.problem ().function ().inputSize ());
+      updateIterate (n, x, new_x);
+      if (!isCached (IpoptCacheStatistics::COST_GRADIENT))
+	{
+	  if (!costGradient_)
+	    {
+	      MallocAllowedScope allocation (true);
+	      costGradient_ = typename function_t::gradient_t
+		(solver_.problem ().function ().inputSize ());
+	    }
 
-      Eigen::Map<const typename function_t::argument_t> x_ (x, n);
-      solver_.problem ().function ().gradient (*costGradient_, x_, 0);
+	  MallocAllowedScope allocation (false);
+	  Eigen::Map<const typename function_t::argument_t> x_ (x, n);
+	  solver_.problem ().function ().gradient (*costGradient_, x_, 0);
 
-      IpoptCheckGradient
-        (solver_.problem ().function (), 0, x_, -1, solver_);
+	  IpoptCheckGradient
+	    (solver_.problem ().function (), 0, x_, -1, solver_);
+	  setCached (IpoptCacheStatistics::COST_GRADIENT);
+	}
 
       Eigen::Map<typename function_t::vector_t> grad_f_ (grad_f, n);
       grad_f_ =  *costGradient_;
@@ -350,65 +1870,71 @@ namespace roboptim
 
     template <typename T>
     bool
-    Tnlp<T>::eval_g (Index n, const Number* x, bool,
+    Tnlp<T>::eval_g (Index n, const Number* x, bool new_x,
 		     Index m, Number* g)
     {
-      using namespace boost;
       ROBOPTIM_DEBUG_ONLY(typename function_t::size_type n_ =
 			  static_cast<typename function_t::size_type> (n));
 
       assert (solver_.problem ().function ().inputSize () == n_);
       assert (constraintsOutputSize () == m);
 
-      if (!constraints_)
-	constraints_ =
-	  typename function_t::result_t (constraintsOutputSize ());
-
-#ifndef ROBOPTIM_DO_NOT_CHECK_ALLOCATION
-      Eigen::internal::set_is_malloc_allowed (true);
-#endif //! ROBOPTIM_DO_NOT_CHECK_ALLOCATION
+      Eigen::Map<typename function_t::result_t> g_ (g, m);
 
-      Eigen::Map<const typename function_t::argument_t> x_ (x, n);
-
-      typedef typename solver_t::problem_t::constraints_t::const_iterator
-	citer_t;
+      updateIterate (n, x, new_x);
+      if (isCached (IpoptCacheStatistics::CONSTRAINTS))
+	{
+	  g_ = *constraints_;
+	  return true;
+	}
 
-      typename function_t::size_type idx = 0;
-      for (citer_t it = solver_.problem ().constraints ().begin ();
-	   it != solver_.problem ().constraints ().end (); ++it)
+      if (!constraints_)
 	{
-	  shared_ptr<typename solver_t::commonConstraintFunction_t> g;
-	  if (it->which () == LINEAR)
-	    g = get<shared_ptr<linearFunction_t> > (*it);
-	  else
-	    g = get<shared_ptr<nonLinearFunction_t> > (*it);
+	  MallocAllowedScope allocation (true);
+	  constraints_ =
+	    typename function_t::result_t (constraintsOutputSize ());
+	}
 
-	  constraints_->segment (idx, g->outputSize ()) = (*g) (x_);
-	  idx += g->outputSize ();
-        }
+      // Linear constraints rows with a single product, the other rows
+      // being overwritten below.
+      if (linearOffset_.size () > 0)
+	{
+	  Eigen::Map<const typename function_t::argument_t> x_ (x, n);
+	  g_.noalias () = linearMatrix_ * x_;
+	  g_ += linearOffset_;
+	}
 
-      Eigen::Map<typename function_t::result_t> g_ (g, m, 1);
-      g_ =  *constraints_;
+      // Constraints are evaluated in place, directly in Ipopt's buffer.
+      taskX_ = x;
+      taskOutput_ = g;
+      {
+	MallocAllowedScope allocation (false);
+	runConstraintsTask (evalConstraintTask_, constraintsCost_);
+      }
+
+      // Keep a copy for subsequent requests at the same point.
+      *constraints_ = g_;
+      setCached (IpoptCacheStatistics::CONSTRAINTS);
       return true;
     }
 
 
-    template <>
-    bool
-    Tnlp<IpoptSolverSparse>::eval_jac_g(Index n, const Number* x, bool,
-					Index m,
-					Index nele_jac,
-					Index* iRow, Index *jCol,
-					Number* values);
-
     template <typename T>
     bool
-    Tnlp<T>::eval_jac_g(Index n, const Number* x, bool,
-			Index m, Index, Index* iRow,
+    Tnlp<T>::eval_jac_g(Index n, const Number* x, bool new_x,
+			Index m, Index nele_jac, Index* iRow,
 			Index *jCol, Number* values)
     {
-      using namespace boost;
+      return evalJacobian (n, x, new_x, m, nele_jac, iRow, jCol, values,
+			   typename function_t::traits_t ());
+    }
 
+    template <typename T>
+    bool
+    Tnlp<T>::evalJacobian (Index n, const Number* x, bool new_x,
+			   Index m, Index nele_jac, Index* iRow,
+			   Index *jCol, Number* values, EigenMatrixDense)
+    {
       ROBOPTIM_DEBUG_ONLY(typename function_t::size_type n_ =
 			  static_cast<typename function_t::size_type> (n));
       assert (solver_.problem ().function ().inputSize () == n_);
@@ -440,41 +1966,43 @@ namespace roboptim
 	}
       else
 	{
-	  if (!jacobian_)
+	  Eigen::Map<typename function_t::vector_t> values_ (values, nele_jac);
+
+	  updateIterate (n, x, new_x);
+
+	  // Without a cached copy, there is no cache lookup to count.
+	  if (cacheJacobian_
+	      && isCached (IpoptCacheStatistics::CONSTRAINTS_JACOBIAN))
 	    {
-	      jacobian_ = typename function_t::matrix_t
-		(constraintsOutputSize (),
-		 solver_.problem ().function ().inputSize ());
-	      jacobian_->setZero ();
+	      values_ = *constraintsJacobian_;
+	      return true;
 	    }
 
-	  Eigen::Map<const typename function_t::vector_t> x_ (x, n);
+	  if (cacheJacobian_
+	      && (!constraintsJacobian_
+		  || constraintsJacobian_->size () != nele_jac))
+	    {
+	      MallocAllowedScope allocation (true);
+	      constraintsJacobian_ =
+		typename function_t::vector_t (nele_jac);
+	    }
 
-	  typedef typename
-	    solver_t::problem_t::constraints_t::const_iterator
-	    citer_t;
+	  // The Jacobian is written directly in Ipopt's values array,
+	  // whose layout matches the storage order of jacobian_t (see
+	  // the structure computed above).
+	  taskX_ = x;
+	  taskOutput_ = values;
+	  {
+	    MallocAllowedScope allocation (false);
+	    runConstraintsTask (evalConstraintJacobianTask_, jacobiansCost_);
+	  }
 
-	  typename function_t::size_type idx = 0;
-	  int constraintId = 0;
-	  for (citer_t it = solver_.problem ().constraints ().begin ();
-	       it != solver_.problem ().constraints ().end (); ++it)
+	  // Keep a copy for subsequent requests at the same point.
+	  if (cacheJacobian_)
 	    {
-	      shared_ptr<typename solver_t::commonConstraintFunction_t> g;
-	      if (it->which () == LINEAR)
-		g = get<shared_ptr<linearFunction_t> > (*it);
-	      else
-		g = get<shared_ptr<nonLinearFunction_t> > (*it);
-
-	      g->jacobian (jacobian_->block (idx, 0, g->outputSize (), n), x_);
-	      idx += g->outputSize ();
-
-	      IpoptCheckGradient
-		(*g, 0, x_,
-		 constraintId++, solver_);
+	      *constraintsJacobian_ = values_;
+	      setCached (IpoptCacheStatistics::CONSTRAINTS_JACOBIAN);
 	    }
-
-	  Eigen::Map<typename function_t::jacobian_t> values_ (values, m, n);
-	  values_ =  *jacobian_;
 	}
 
       return true;
@@ -484,36 +2012,64 @@ namespace roboptim
     template <>
     inline void
     Tnlp<IpoptSolverTd>::compute_hessian
-    (TwiceDifferentiableFunction::hessian_t& h,
-     const solver_t::vector_t& x,
+    (Number* values,
+     Index n, const Number* x,
      Number obj_factor,
      const Number* lambda)
     {
-      using namespace boost;
+      if (finiteDifferenceHessian_)
+	{
+	  computeFiniteDifferenceHessian (values, n, x, obj_factor, lambda);
+	  return;
+	}
 
-      typedef solver_t::problem_t::constraints_t::const_iterator citer_t;
+      // Constraint Hessians are summed in per-worker values, reduced
+      // afterwards.
+      for (std::size_t w = 0; w < hessianValues_.size (); ++w)
+	hessianValues_[w].setZero ();
 
-      TwiceDifferentiableFunction::hessian_t fct_h =
-        solver_.problem ().function ().hessian (x, 0);
-      h = obj_factor * fct_h;
+      taskX_ = x;
+      taskLambda_ = lambda;
 
-      int i = 0;
-      for (citer_t it = solver_.problem ().constraints ().begin ();
-           it != solver_.problem ().constraints ().end (); ++it)
-        {
-          shared_ptr<TwiceDifferentiableFunction> g;
-          if (it->which () == LINEAR)
-            g = get<shared_ptr<linearFunction_t> > (*it);
-          else
-            g = get<shared_ptr<nonLinearFunction_t> > (*it);
-          h += lambda[i++] * g->hessian (x, 0);
-        }
+      // Without cached Hessians, there is no cache lookup to count.
+      if (cacheHessians_ && isCached (IpoptCacheStatistics::HESSIANS))
+	// Same point, only the multipliers changed: re-weight the
+	// Hessians computed for this point.
+	runConstraintsTask (weightConstraintHessianTask_, hessianWeightsCost_);
+      else
+	{
+	  bool check = checkHessianStructure_ || hessianStructureUnchecked_;
+	  runConstraintsTask (evalConstraintHessianTask_, hessiansCost_);
+
+	  Eigen::Map<const solver_t::vector_t> x_ (x, n);
+	  if (check)
+	    costHessian_.setZero ();
+	  solver_.problem ().function ().hessian (costHessian_, x_, 0);
+	  costHessianValues_.setZero ();
+	  accumulateLowerStructure
+	    (costHessianValues_, 1., costHessian_, hessianRows_, hessianCols_);
+
+	  structureEntries_t outside;
+	  if (check && findLowerNonZeros (outside, costHessian_))
+	    hessianStructureError
+	      (solver_.problem ().function ().getName (), -1, 0, outside);
+	  hessianStructureUnchecked_ = false;
+
+	  if (cacheHessians_)
+	    setCached (IpoptCacheStatistics::HESSIANS);
+	}
+
+      Eigen::Map<function_t::vector_t>
+	values_ (values, costHessianValues_.size ());
+      values_ = obj_factor * costHessianValues_;
+      for (std::size_t w = 0; w < hessianValues_.size (); ++w)
+	values_ += hessianValues_[w];
     }
 
     template <>
     inline bool
     Tnlp<IpoptSolverTd>::eval_h
-    (Index n, const Number* x, bool,
+    (Index n, const Number* x, bool new_x,
      Number obj_factor, Index ROBOPTIM_DEBUG_ONLY(m), const Number* lambda,
      bool, Index ROBOPTIM_DEBUG_ONLY(nele_hess), Index* iRow,
      Index* jCol, Number* values)
@@ -525,33 +2081,27 @@ namespace roboptim
 
       //FIXME: check if a hessian is provided.
 
+      // Only the structural nonzeros (lower triangle) are given to
+      // Ipopt, see setupHessianStructure.
+      assert (hessianRows_.size () == static_cast<std::size_t> (nele_hess));
+
       if (!values)
 	{
-	  //FIXME: always dense for now.
-	  int idx = 0;
-	  for (int i = 0; i < n; ++i)
-	    for (int j = 0; j < i + 1; ++j)
-	      {
-		iRow[idx] = i, jCol[idx] = j;
-		++idx;
-	      }
-	  assert (idx == nele_hess);
+	  std::copy (hessianRows_.begin (), hessianRows_.end (), iRow);
+	  std::copy (hessianCols_.begin (), hessianCols_.end (), jCol);
 	}
       else
 	{
-	  solver_t::vector_t x_ (n);
-	  array_to_vector (x_, x);
-
-	  TwiceDifferentiableFunction::hessian_t h
-	    (solver_.problem ().function ().inputSize (),
-	     solver_.problem ().function ().inputSize ());
-	  compute_hessian (h, x_, obj_factor, lambda);
-
-	  int idx = 0;
-	  for (int i = 0; i < n; ++i)
-	    for (int j = 0; j < i + 1; ++j)
-	      values[idx++] = h (i, j);
-	  assert (idx == nele_hess);
+	  updateIterate (n, x, new_x);
+	  try
+	    {
+	      MallocAllowedScope allocation (false);
+	      compute_hessian (values, n, x, obj_factor, lambda);
+	    }
+	  catch (const std::runtime_error& error)
+	    {
+	      return reportError (error);
+	    }
 	}
 
       return true;
@@ -626,8 +2176,8 @@ namespace roboptim
     void
     Tnlp<T>::finalize_solution
     (SolverReturn status,
-     Index n, const Number* x, const Number*,
-     const Number*, Index m, const Number* g,
+     Index n, const Number* x, const Number* z_L,
+     const Number* z_U, Index m, const Number* g,
      const Number* lambda, Number obj_value,
      const IpoptData*,
      IpoptCalculatedQuantities*)
@@ -635,6 +2185,21 @@ namespace roboptim
       assert (solver_.problem ().function ().inputSize () - n == 0);
       assert (constraintsOutputSize () - m == 0);
 
+      // Keep the error which made the solve fail.
+      if (evaluationFailed_)
+	return;
+
+      // The solve is over: there is nothing left to resume.
+      if (!checkpointPath_.empty () && status == SUCCESS)
+	std::remove (checkpointPath_.c_str ());
+
+      // Keep the primal-dual iterate for warm starts.
+      IpoptIterate& iterate = solver_.finalIterate_;
+      iterate.x = Eigen::Map<const Function::vector_t> (x, n);
+      iterate.lambda = Eigen::Map<const Function::vector_t> (lambda, m);
+      iterate.zL = Eigen::Map<const Function::vector_t> (z_L, n);
+      iterate.zU = Eigen::Map<const Function::vector_t> (z_U, n);
+
       switch (status)
 	{
 	case FEASIBLE_POINT_FOUND:
@@ -664,7 +2229,7 @@ namespace roboptim
     template <typename T>
     bool
     Tnlp<T>::intermediate_callback (AlgorithmMode mode,
-                                    Index /*iter*/, Number obj_value,
+                                    Index iter, Number obj_value,
                                     Number /*inf_pr*/, Number /*inf_du*/,
 				    Number /*mu*/, Number /*d_norm*/,
 				    Number /*regularization_size*/,
@@ -673,6 +2238,13 @@ namespace roboptim
 				    const IpoptData* ip_data,
 				    IpoptCalculatedQuantities* ip_cq)
     {
+      // The result is the error: stop right away (the solver may then
+      // start again with extended structures).
+      if (evaluationFailed_)
+	return false;
+
+      checkpoint (mode, iter, ip_data, ip_cq);
+
       if (!solver_.callback ())
 	return true;
       if (!ip_cq)
@@ -699,6 +2271,16 @@ namespace roboptim
       solverState_.parameters()["ipopt.mode"].description
         = "Indicates the mode in which the algorithm is";
 
+      // evaluation cache statistics
+      solverState_.parameters ()["ipopt.plugin.cache_hits"].value =
+	static_cast<int> (solver_.cacheStatistics ().totalHits ());
+      solverState_.parameters ()["ipopt.plugin.cache_hits"].description
+        = "Number of evaluations served from the per-iterate cache";
+      solverState_.parameters ()["ipopt.plugin.cache_misses"].value =
+	static_cast<int> (solver_.cacheStatistics ().totalMisses ());
+      solverState_.parameters ()["ipopt.plugin.cache_misses"].description
+        = "Number of evaluations of the RobOptim functions";
+
       bool stop_optim = false;
       solverState_.parameters ()["ipopt.stop"].value = stop_optim;
       solverState_.parameters ()["ipopt.stop"].description
@@ -725,16 +2307,24 @@ namespace roboptim
     Index
     Tnlp<T>::get_number_of_nonlinear_variables ()
     {
-      //FIXME: implement this.
-      return -1;
+      // All the variables are nonlinear by default.
+      if (nonlinearVariables_.size ()
+	  == static_cast<std::size_t> (solver_.problem ().function ().inputSize ()))
+	return -1;
+      return static_cast<Index> (nonlinearVariables_.size ());
     }
 
     template <typename T>
     bool
-    Tnlp<T>::get_list_of_nonlinear_variables (Index, Index*)
+    Tnlp<T>::get_list_of_nonlinear_variables
+    (Index ROBOPTIM_DEBUG_ONLY(num_nonlin_vars), Index* pos_nonlin_vars)
     {
-      //FIXME: implement this.
-      return false;
+      assert (nonlinearVariables_.size ()
+	      == static_cast<std::size_t> (num_nonlin_vars));
+
+      std::copy (nonlinearVariables_.begin (), nonlinearVariables_.end (),
+		 pos_nonlin_vars);
+      return true;
     }
   } // end of namespace detail
 } // end of namespace roboptim
@@ -0,0 +1,351 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/interprocess/sync/sharable_lock.hpp>
+
+#include "atomic-file.hh"
+#include "warm-start-store.hh"
+
+namespace roboptim
+{
+  namespace detail
+  {
+    namespace
+    {
+      /// \brief Store file header.
+      ///
+      /// Followed by the slots. A slot starts with the parameters hash
+      /// and the stamp of the solve it comes from (zero for empty
+      /// slots), followed by the signature, x, lambda, zL and zU.
+      struct Header
+      {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t slots;
+	boost::uint64_t fingerprint;
+	boost::uint64_t inputSize;
+	boost::uint64_t constraintsSize;
+	boost::uint64_t signatureSize;
+	boost::uint64_t stamp;
+      };
+
+      const char magic[8] = {'R', 'O', 'B', 'O', 'I', 'P', 'W', 'S'};
+
+      const boost::uint32_t version = 1;
+
+      /// \brief Number of slots of a store.
+      const boost::uint32_t slots = 16;
+
+      /// \brief Size of the slot record (parameters hash and stamp).
+      const std::size_t recordSize = 2 * sizeof (boost::uint64_t);
+
+      typedef WarmStartStore::Entry Entry;
+      typedef Eigen::Map<const Eigen::VectorXd> constMap_t;
+      typedef Eigen::Map<Eigen::VectorXd> map_t;
+      typedef Eigen::VectorXd::Index index_t;
+
+      Header
+      makeHeader (WarmStartStore::fingerprint_t fingerprint,
+		  const Entry& entry)
+      {
+	Header header;
+	std::memset (&header, 0, sizeof (Header));
+	std::memcpy (header.magic, magic, sizeof (magic));
+	header.version = version;
+	header.slots = slots;
+	header.fingerprint = fingerprint;
+	header.inputSize = static_cast<boost::uint64_t> (entry.x.size ());
+	header.constraintsSize =
+	  static_cast<boost::uint64_t> (entry.lambda.size ());
+	header.signatureSize =
+	  static_cast<boost::uint64_t> (entry.signature.size ());
+	return header;
+      }
+
+      std::size_t
+      slotSize (const Header& header)
+      {
+	return recordSize + sizeof (double)
+	  * static_cast<std::size_t> (header.signatureSize
+				      + 3 * header.inputSize
+				      + header.constraintsSize);
+      }
+
+      std::size_t
+      fileSize (const Header& header)
+      {
+	return sizeof (Header) + header.slots * slotSize (header);
+      }
+
+      /// \brief Check a mapped file against the expected header.
+      bool
+      matches (const Header& expected, const char* data, std::size_t size)
+      {
+	if (size < sizeof (Header))
+	  return false;
+
+	Header header;
+	std::memcpy (&header, data, sizeof (Header));
+	return std::memcmp (header.magic, magic, sizeof (magic)) == 0
+	  && header.version == expected.version
+	  && header.slots == expected.slots
+	  && header.fingerprint == expected.fingerprint
+	  && header.inputSize == expected.inputSize
+	  && header.constraintsSize == expected.constraintsSize
+	  && header.signatureSize == expected.signatureSize
+	  && size == fileSize (expected);
+      }
+
+      /// \brief Check an existing file against the expected header.
+      bool
+      valid (const std::string& path, const Header& expected)
+      {
+	std::ifstream file (path.c_str (), std::ios::in | std::ios::binary);
+	if (!file)
+	  return false;
+
+	std::vector<char> data (sizeof (Header));
+	file.read (&data[0], static_cast<std::streamsize> (data.size ()));
+	file.seekg (0, std::ios::end);
+	if (!file)
+	  return false;
+	return matches (expected, &data[0],
+			static_cast<std::size_t> (file.tellg ()));
+      }
+
+      /// \brief Create an empty store.
+      ///
+      /// The file is written atomically, so that concurrent processes
+      /// never map a partial file.
+      bool
+      create (const std::string& path, const Header& header)
+      {
+	AtomicFile file (path);
+	std::ostream& out = file.stream ();
+	if (!out)
+	  return false;
+
+	out.write (reinterpret_cast<const char*> (&header), sizeof (Header));
+	std::vector<char> slot (slotSize (header), 0);
+	for (boost::uint32_t k = 0; k < header.slots; ++k)
+	  out.write (&slot[0], static_cast<std::streamsize> (slot.size ()));
+
+	return file.commit ();
+      }
+
+      /// \brief Create the lock file of a store if needed.
+      ///
+      /// file_lock needs an existing file: it is never truncated, nor
+      /// replaced.
+      bool
+      touch (const std::string& path)
+      {
+	std::ofstream file (path.c_str (),
+			    std::ios::out | std::ios::app | std::ios::binary);
+	return !!file;
+      }
+    } // end of anonymous namespace.
+
+    std::string
+    WarmStartStore::path (const std::string& directory,
+			  fingerprint_t fingerprint)
+    {
+      std::ostringstream ss;
+      ss << directory;
+      if (!directory.empty () && directory[directory.size () - 1] != '/')
+	ss << '/';
+      ss << "roboptim-ipopt-" << std::hex << fingerprint << ".warm-start";
+      return ss.str ();
+    }
+
+    std::string
+    WarmStartStore::lockPath (const std::string& path)
+    {
+      return path + ".lock";
+    }
+
+    bool
+    WarmStartStore::lookup (const std::string& path,
+			    fingerprint_t fingerprint,
+			    fingerprint_t parameters,
+			    Entry& entry)
+    {
+      using namespace boost::interprocess;
+
+      {
+	// Nothing to look up.
+	std::ifstream file (path.c_str ());
+	if (!file)
+	  return false;
+      }
+
+      // Do not let file_lock throw on missing files.
+      const std::string lockFile = lockPath (path);
+      if (!touch (lockFile))
+	return false;
+
+      const Header expected = makeHeader (fingerprint, entry);
+      std::size_t s = static_cast<std::size_t> (expected.signatureSize);
+      std::size_t n = static_cast<std::size_t> (expected.inputSize);
+      std::size_t m = static_cast<std::size_t> (expected.constraintsSize);
+
+      try
+	{
+	  file_lock lock (lockFile.c_str ());
+	  sharable_lock<file_lock> guard (lock);
+	  file_mapping file (path.c_str (), read_only);
+	  mapped_region region (file, read_only);
+
+	  const char* data = static_cast<const char*> (region.get_address ());
+	  if (!matches (expected, data, region.get_size ()))
+	    return false;
+
+	  const char* best = 0;
+	  double bestDistance = 0.;
+	  for (boost::uint32_t k = 0; k < expected.slots; ++k)
+	    {
+	      const char* slot = data + sizeof (Header) + k * slotSize (expected);
+	      boost::uint64_t record[2];
+	      std::memcpy (record, slot, recordSize);
+	      if (record[1] == 0 || record[0] != parameters)
+		continue;
+
+	      // Slots are aligned on doubles.
+	      constMap_t signature
+		(reinterpret_cast<const double*> (slot + recordSize),
+		 static_cast<index_t> (s));
+	      double distance = (signature - entry.signature).squaredNorm ();
+	      if (!best || distance < bestDistance)
+		{
+		  best = slot;
+		  bestDistance = distance;
+		}
+	    }
+
+	  if (!best)
+	    return false;
+
+	  const double* payload =
+	    reinterpret_cast<const double*> (best + recordSize) + s;
+	  entry.x = constMap_t (payload, static_cast<index_t> (n));
+	  entry.lambda = constMap_t (payload + n, static_cast<index_t> (m));
+	  entry.zL = constMap_t (payload + n + m, static_cast<index_t> (n));
+	  entry.zU =
+	    constMap_t (payload + 2 * n + m, static_cast<index_t> (n));
+	  return true;
+	}
+      catch (const interprocess_exception&)
+	{
+	  return false;
+	}
+    }
+
+    bool
+    WarmStartStore::save (const std::string& path,
+			  fingerprint_t fingerprint,
+			  fingerprint_t parameters,
+			  const Entry& entry)
+    {
+      using namespace boost::interprocess;
+
+      assert (entry.zL.size () == entry.x.size ());
+      assert (entry.zU.size () == entry.x.size ());
+
+      const Header expected = makeHeader (fingerprint, entry);
+      std::size_t s = static_cast<std::size_t> (expected.signatureSize);
+      std::size_t n = static_cast<std::size_t> (expected.inputSize);
+      std::size_t m = static_cast<std::size_t> (expected.constraintsSize);
+
+      const std::string lockFile = lockPath (path);
+      if (!touch (lockFile))
+	return false;
+
+      try
+	{
+	  // The store is replaced under the lock: concurrent writers
+	  // would otherwise replace a store another one just created, or
+	  // lock a file which is being replaced.
+	  file_lock lock (lockFile.c_str ());
+	  scoped_lock<file_lock> guard (lock);
+	  if (!valid (path, expected) && !create (path, expected))
+	    return false;
+
+	  file_mapping file (path.c_str (), read_write);
+	  mapped_region region (file, read_write);
+
+	  char* data = static_cast<char*> (region.get_address ());
+	  if (!matches (expected, data, region.get_size ()))
+	    return false;
+
+	  Header header;
+	  std::memcpy (&header, data, sizeof (Header));
+
+	  // Replace the same solve, or the oldest one.
+	  char* target = 0;
+	  boost::uint64_t oldest = 0;
+	  for (boost::uint32_t k = 0; k < header.slots; ++k)
+	    {
+	      char* slot = data + sizeof (Header) + k * slotSize (header);
+	      boost::uint64_t record[2];
+	      std::memcpy (record, slot, recordSize);
+
+	      constMap_t signature
+		(reinterpret_cast<const double*> (slot + recordSize),
+		 static_cast<index_t> (s));
+	      if (record[1] != 0 && record[0] == parameters
+		  && signature == entry.signature)
+		{
+		  target = slot;
+		  break;
+		}
+	      if (!target || record[1] < oldest)
+		{
+		  target = slot;
+		  oldest = record[1];
+		}
+	    }
+
+	  double* payload = reinterpret_cast<double*> (target + recordSize);
+	  map_t (payload, static_cast<index_t> (s)) = entry.signature;
+	  payload += s;
+	  map_t (payload, static_cast<index_t> (n)) = entry.x;
+	  map_t (payload + n, static_cast<index_t> (m)) = entry.lambda;
+	  map_t (payload + n + m, static_cast<index_t> (n)) = entry.zL;
+	  map_t (payload + 2 * n + m, static_cast<index_t> (n)) = entry.zU;
+
+	  boost::uint64_t record[2] = {parameters, ++header.stamp};
+	  std::memcpy (target, record, recordSize);
+	  std::memcpy (data, &header, sizeof (Header));
+	  return true;
+	}
+      catch (const interprocess_exception&)
+	{
+	  return false;
+	}
+    }
+  } // end of namespace detail
+} // end of namespace roboptim
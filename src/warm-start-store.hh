@@ -0,0 +1,111 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_WARM_START_STORE_HH
+# define ROBOPTIM_CORE_IPOPT_WARM_START_STORE_HH
+
+# include <string>
+
+# include <boost/cstdint.hpp>
+
+# include <Eigen/Core>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \internal
+    /// \brief On-disk store of final primal-dual iterates.
+    ///
+    /// A store file holds a fixed number of slots for the iterates of
+    /// one problem structure, identified by a fingerprint. Each slot
+    /// records the hash of the solver parameters and a signature of the
+    /// problem data (bounds, starting point) of the solve it comes from,
+    /// so that lookups return the iterate of the closest solve made
+    /// with the same parameters. Files are memory-mapped, and accesses
+    /// are serialized between processes by locks on a sidecar file,
+    /// whose inode stays the same when the store is replaced.
+    class WarmStartStore
+    {
+    public:
+      /// \brief Fingerprint and hash type.
+      typedef boost::uint64_t fingerprint_t;
+
+      /// \brief Vector type.
+      typedef Eigen::VectorXd vector_t;
+
+      /// \brief Stored iterate.
+      struct Entry
+      {
+	/// \brief Problem data signature.
+	vector_t signature;
+	/// \brief Optimization parameters.
+	vector_t x;
+	/// \brief Constraints multipliers.
+	vector_t lambda;
+	/// \brief Lower bound multipliers.
+	vector_t zL;
+	/// \brief Upper bound multipliers.
+	vector_t zU;
+      };
+
+      /// \brief Store file of a problem.
+      ///
+      /// \param directory store directory.
+      /// \param fingerprint problem fingerprint.
+      static std::string path (const std::string& directory,
+			       fingerprint_t fingerprint);
+
+      /// \brief Lock file of a store file.
+      ///
+      /// \param path store file.
+      static std::string lockPath (const std::string& path);
+
+      /// \brief Find the closest stored iterate.
+      ///
+      /// \param path store file.
+      /// \param fingerprint problem fingerprint.
+      /// \param parameters solver parameters hash.
+      /// \param entry signature to match (input), sizes of the iterate
+      /// (input) and closest iterate (output).
+      /// \return whether an iterate was found.
+      static bool lookup (const std::string& path,
+			  fingerprint_t fingerprint,
+			  fingerprint_t parameters,
+			  Entry& entry);
+
+      /// \brief Store an iterate.
+      ///
+      /// The iterate replaces the one with the same parameters and
+      /// signature if any, the oldest one otherwise. The file is
+      /// created (or replaced if it does not match the problem) while
+      /// holding the lock.
+      ///
+      /// \param path store file.
+      /// \param fingerprint problem fingerprint.
+      /// \param parameters solver parameters hash.
+      /// \param entry iterate.
+      /// \return whether the iterate could be stored.
+      static bool save (const std::string& path,
+			fingerprint_t fingerprint,
+			fingerprint_t parameters,
+			const Entry& entry);
+    };
+  } // end of namespace detail.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_WARM_START_STORE_HH
@@ -0,0 +1,256 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-allocation-sparse
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+
+#include "tnlp.hh"
+#include "schittkowski-71.hh"
+
+// Heap allocations are only detected by Eigen's runtime check, which
+// aborts through eigen_assert.
+#if defined ROBOPTIM_DO_NOT_CHECK_ALLOCATION || !defined EIGEN_RUNTIME_NO_MALLOC
+# error "this test must be built with the allocation check enabled"
+#endif
+#ifdef NDEBUG
+# error "this test must be built with assertions enabled"
+#endif
+
+using namespace roboptim;
+
+namespace
+{
+  /// \brief Sparse version of problem 71, see schittkowski-71.hh.
+  ///
+  /// Jacobians are written in the layout locked by the plug-in:
+  /// inserting in a compressed matrix would allocate.
+  struct F : public DifferentiableSparseFunction
+  {
+    F ()
+      : DifferentiableSparseFunction (4, 1, "x₀ x₃ (x₀ + x₁ + x₂) + x₂")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient.insert (0) = x[0] * x[3] + x[3] * (x[0] + x[1] + x[2]);
+      gradient.insert (1) = x[0] * x[3];
+      gradient.insert (2) = x[0] * x[3] + 1.;
+      gradient.insert (3) = x[0] * (x[0] + x[1] + x[2]);
+    }
+  };
+
+  struct G0 : public DifferentiableSparseFunction
+  {
+    G0 ()
+      : DifferentiableSparseFunction (4, 1, "x₀ x₁ x₂ x₃")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * x[1] * x[2] * x[3];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient.insert (0) = x[1] * x[2] * x[3];
+      gradient.insert (1) = x[0] * x[2] * x[3];
+      gradient.insert (2) = x[0] * x[1] * x[3];
+      gradient.insert (3) = x[0] * x[1] * x[2];
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      jacobian.coeffRef (0, 0) = x[1] * x[2] * x[3];
+      jacobian.coeffRef (0, 1) = x[0] * x[2] * x[3];
+      jacobian.coeffRef (0, 2) = x[0] * x[1] * x[3];
+      jacobian.coeffRef (0, 3) = x[0] * x[1] * x[2];
+    }
+  };
+
+  struct G1 : public DifferentiableSparseFunction
+  {
+    G1 ()
+      : DifferentiableSparseFunction (4, 1, "x₀² + x₁² + x₂² + x₃²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x.squaredNorm ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      for (size_type j = 0; j < 4; ++j)
+	gradient.insert (j) = 2. * x[j];
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      for (size_type j = 0; j < 4; ++j)
+	jacobian.coeffRef (0, j) = 2. * x[j];
+    }
+  };
+
+  void
+  setup (IpoptSolverSparse::problem_t& problem)
+  {
+    for (std::size_t i = 0; i < 4; ++i)
+      problem.argumentBounds ()[i] = Function::makeInterval (1., 5.);
+
+    boost::shared_ptr<DifferentiableSparseFunction> g0 (new G0 ());
+    boost::shared_ptr<DifferentiableSparseFunction> g1 (new G1 ());
+    problem.addConstraint (g0, Function::makeLowerInterval (25.));
+    problem.addConstraint (g1, Function::makeInterval (40., 40.));
+
+    IpoptSolverSparse::problem_t::vector_t x (4);
+    x << 1., 5., 5., 1.;
+    problem.startingPoint () = x;
+  }
+} // end of anonymous namespace.
+
+/// \brief Evaluate problem 71 at several points, with a given number
+/// of evaluation threads.
+static void
+checkSteadyState (int threads)
+{
+  F f;
+  IpoptSolverSparse::problem_t problem (f);
+  setup (problem);
+
+  IpoptSolverSparse solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverSparse> > nlp =
+    new detail::Tnlp<IpoptSolverSparse> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (n, 4);
+  BOOST_REQUIRE_EQUAL (m, 2);
+  BOOST_REQUIRE_EQUAL (nnz_jac_g, 8);
+
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+				  &rows[0], &cols[0], 0));
+
+  Function::vector_t x (n);
+  Function::vector_t g (m);
+  Function::vector_t gradient (n);
+  Function::vector_t jacobian (nnz_jac_g);
+  x << 1., 5., 5., 1.;
+
+  G0 g0;
+  G1 g1;
+
+  // The first evaluation allocates the evaluation buffers: the
+  // following ones run in steady state, where Eigen aborts on any
+  // heap allocation.
+  for (Ipopt::Index iteration = 0; iteration < 10; ++iteration)
+    {
+      x[iteration % n] += .1;
+
+      Ipopt::Number cost;
+      BOOST_REQUIRE (nlp->eval_f (n, x.data (), true, cost));
+      BOOST_REQUIRE (nlp->eval_g (n, x.data (), false, m, g.data ()));
+      BOOST_REQUIRE (nlp->eval_grad_f (n, x.data (), false,
+				       gradient.data ()));
+      BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), false, m, nnz_jac_g,
+				      0, 0, jacobian.data ()));
+
+      BOOST_CHECK_CLOSE (cost, f (x)[0], 1e-10);
+      BOOST_CHECK_CLOSE (g[0], g0 (x)[0], 1e-10);
+      BOOST_CHECK_CLOSE (g[1], g1 (x)[0], 1e-10);
+
+      F::gradient_t expected = f.gradient (x, 0);
+      for (Ipopt::Index j = 0; j < n; ++j)
+	BOOST_CHECK_CLOSE (gradient[j], expected.coeff (j), 1e-10);
+
+      G0::jacobian_t expected0 = g0.jacobian (x);
+      G1::jacobian_t expected1 = g1.jacobian (x);
+      for (std::size_t k = 0; k < rows.size (); ++k)
+	BOOST_CHECK_CLOSE (jacobian[static_cast<Ipopt::Index> (k)],
+			   rows[k] == 0
+			   ? expected0.coeff (0, cols[k])
+			   : expected1.coeff (0, cols[k]), 1e-10);
+    }
+}
+
+/// \brief Solve problem 71 with a given number of evaluation threads.
+static void
+checkSolve (int threads)
+{
+  F f;
+  IpoptSolverSparse::problem_t problem (f);
+  setup (problem);
+
+  IpoptSolverSparse solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+  solver.solve ();
+
+  const IpoptSolverSparse::result_t& result = solver.minimum ();
+  BOOST_REQUIRE (result.which () == IpoptSolverSparse::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).value[0],
+		     schittkowski71::minimum, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE (steady_state_evaluations)
+{
+  checkSteadyState (1);
+}
+
+BOOST_AUTO_TEST_CASE (solve)
+{
+  checkSolve (1);
+}
+
+// The check is only left to the functions while the workers run.
+BOOST_AUTO_TEST_CASE (parallel_evaluations)
+{
+  checkSteadyState (2);
+  checkSolve (2);
+}
@@ -0,0 +1,300 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-allocation-td
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-td.hh>
+
+#include "tnlp.hh"
+#include "schittkowski-71.hh"
+
+// Heap allocations are only detected by Eigen's runtime check, which
+// aborts through eigen_assert.
+#if defined ROBOPTIM_DO_NOT_CHECK_ALLOCATION || !defined EIGEN_RUNTIME_NO_MALLOC
+# error "this test must be built with the allocation check enabled"
+#endif
+#ifdef NDEBUG
+# error "this test must be built with assertions enabled"
+#endif
+
+using namespace roboptim;
+
+namespace
+{
+  /// \brief Twice differentiable version of problem 71, see
+  /// schittkowski-71.hh.
+  struct F : public TwiceDifferentiableFunction
+  {
+    F ()
+      : TwiceDifferentiableFunction (4, 1, "x₀ x₃ (x₀ + x₁ + x₂) + x₂")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient << x[0] * x[3] + x[3] * (x[0] + x[1] + x[2]),
+	x[0] * x[3], x[0] * x[3] + 1., x[0] * (x[0] + x[1] + x[2]);
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian <<
+	2. * x[3], x[3], x[3], 2. * x[0] + x[1] + x[2],
+	x[3],      0.,   0.,   x[0],
+	x[3],      0.,   0.,   x[0],
+	2. * x[0] + x[1] + x[2], x[0], x[0], 0.;
+    }
+  };
+
+  struct G0 : public TwiceDifferentiableFunction
+  {
+    G0 ()
+      : TwiceDifferentiableFunction (4, 1, "x₀ x₁ x₂ x₃")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * x[1] * x[2] * x[3];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient << x[1] * x[2] * x[3], x[0] * x[2] * x[3],
+	x[0] * x[1] * x[3], x[0] * x[1] * x[2];
+    }
+
+    // The default Jacobian goes through gradient temporaries.
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      jacobian.row (0) <<
+	x[1] * x[2] * x[3], x[0] * x[2] * x[3],
+	x[0] * x[1] * x[3], x[0] * x[1] * x[2];
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian <<
+	0.,          x[2] * x[3], x[1] * x[3], x[1] * x[2],
+	x[2] * x[3], 0.,          x[0] * x[3], x[0] * x[2],
+	x[1] * x[3], x[0] * x[3], 0.,          x[0] * x[1],
+	x[1] * x[2], x[0] * x[2], x[0] * x[1], 0.;
+    }
+  };
+
+  struct G1 : public TwiceDifferentiableFunction
+  {
+    G1 ()
+      : TwiceDifferentiableFunction (4, 1, "x₀² + x₁² + x₂² + x₃²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x.squaredNorm ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient = 2. * x;
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      jacobian.row (0) = 2. * x.transpose ();
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref,
+		  size_type) const
+    {
+      hessian.setZero ();
+      hessian.diagonal ().setConstant (2.);
+    }
+  };
+
+  void
+  setup (IpoptSolverTd::problem_t& problem)
+  {
+    for (std::size_t i = 0; i < 4; ++i)
+      problem.argumentBounds ()[i] = Function::makeInterval (1., 5.);
+
+    boost::shared_ptr<TwiceDifferentiableFunction> g0 (new G0 ());
+    boost::shared_ptr<TwiceDifferentiableFunction> g1 (new G1 ());
+    problem.addConstraint (g0, Function::makeLowerInterval (25.));
+    problem.addConstraint (g1, Function::makeInterval (40., 40.));
+
+    IpoptSolverTd::problem_t::vector_t x (4);
+    x << 1., 5., 5., 1.;
+    problem.startingPoint () = x;
+  }
+} // end of anonymous namespace.
+
+/// \brief Evaluate problem 71 and its Lagrangian Hessian at several
+/// points, with a given number of evaluation threads.
+static void
+checkSteadyState (int threads, bool cacheHessians)
+{
+  F f;
+  IpoptSolverTd::problem_t problem (f);
+  setup (problem);
+
+  IpoptSolverTd solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+  solver.parameters ()["ipopt.plugin.cache_hessians"].value = cacheHessians;
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp =
+    new detail::Tnlp<IpoptSolverTd> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (n, 4);
+  BOOST_REQUIRE_EQUAL (m, 2);
+
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+				  &rows[0], &cols[0], 0));
+
+  std::vector<Ipopt::Index> hessianRows (static_cast<std::size_t> (nnz_h_lag));
+  std::vector<Ipopt::Index> hessianCols (static_cast<std::size_t> (nnz_h_lag));
+  BOOST_REQUIRE (nlp->eval_h (n, 0, true, 0., m, 0, true, nnz_h_lag,
+			      &hessianRows[0], &hessianCols[0], 0));
+
+  Function::vector_t x (n);
+  Function::vector_t g (m);
+  Function::vector_t gradient (n);
+  Function::vector_t jacobian (nnz_jac_g);
+  Function::vector_t hessian (nnz_h_lag);
+  Function::vector_t lambda (m);
+  x << 1., 5., 5., 1.;
+  lambda << .5, -1.5;
+
+  G0 g0;
+  G1 g1;
+
+  // The first evaluation allocates the evaluation buffers: the
+  // following ones run in steady state, where Eigen aborts on any
+  // heap allocation.
+  for (Ipopt::Index iteration = 0; iteration < 10; ++iteration)
+    {
+      x[iteration % n] += .1;
+      lambda[iteration % m] += .25;
+
+      Ipopt::Number cost;
+      BOOST_REQUIRE (nlp->eval_f (n, x.data (), true, cost));
+      BOOST_REQUIRE (nlp->eval_g (n, x.data (), false, m, g.data ()));
+      BOOST_REQUIRE (nlp->eval_grad_f (n, x.data (), false,
+				       gradient.data ()));
+      BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), false, m, nnz_jac_g,
+				      0, 0, jacobian.data ()));
+      BOOST_REQUIRE (nlp->eval_h (n, x.data (), false, 2., m, lambda.data (),
+				  true, nnz_h_lag, 0, 0, hessian.data ()));
+
+      // Same point, new multipliers: cached Hessians are re-weighted.
+      BOOST_REQUIRE (nlp->eval_h (n, x.data (), false, 1., m, lambda.data (),
+				  true, nnz_h_lag, 0, 0, hessian.data ()));
+
+      BOOST_CHECK_CLOSE (cost, f (x)[0], 1e-10);
+      BOOST_CHECK_CLOSE (g[0], g0 (x)[0], 1e-10);
+      BOOST_CHECK_CLOSE (g[1], g1 (x)[0], 1e-10);
+
+      Function::vector_t expected = f.gradient (x, 0);
+      for (Ipopt::Index j = 0; j < n; ++j)
+	BOOST_CHECK_CLOSE (gradient[j], expected[j], 1e-10);
+
+      Function::matrix_t expectedJacobian (m, n);
+      expectedJacobian << g0.jacobian (x), g1.jacobian (x);
+      for (std::size_t k = 0; k < rows.size (); ++k)
+	BOOST_CHECK_CLOSE (jacobian[static_cast<Ipopt::Index> (k)],
+			   expectedJacobian (rows[k], cols[k]), 1e-10);
+
+      Function::matrix_t expectedHessian = f.hessian (x, 0)
+	+ lambda[0] * g0.hessian (x, 0) + lambda[1] * g1.hessian (x, 0);
+      for (std::size_t k = 0; k < hessianRows.size (); ++k)
+	BOOST_CHECK_SMALL (hessian[static_cast<Ipopt::Index> (k)]
+			   - expectedHessian (hessianRows[k], hessianCols[k]),
+			   1e-10);
+    }
+}
+
+/// \brief Solve problem 71 with a given number of evaluation threads.
+static void
+checkSolve (int threads)
+{
+  F f;
+  IpoptSolverTd::problem_t problem (f);
+  setup (problem);
+
+  IpoptSolverTd solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+  solver.solve ();
+
+  const IpoptSolverTd::result_t& result = solver.minimum ();
+  BOOST_REQUIRE (result.which () == IpoptSolverTd::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).value[0],
+		     schittkowski71::minimum, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE (steady_state_evaluations)
+{
+  checkSteadyState (1, true);
+}
+
+BOOST_AUTO_TEST_CASE (steady_state_evaluations_without_hessian_cache)
+{
+  checkSteadyState (1, false);
+}
+
+BOOST_AUTO_TEST_CASE (solve)
+{
+  checkSolve (1);
+}
+
+// The check is only left to the functions while the workers run.
+BOOST_AUTO_TEST_CASE (parallel_evaluations)
+{
+  checkSteadyState (2, true);
+  checkSolve (2);
+}
@@ -0,0 +1,143 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-allocation
+
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/util.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "tnlp.hh"
+#include "schittkowski-71.hh"
+
+// Heap allocations are only detected by Eigen's runtime check, which
+// aborts through eigen_assert.
+#if defined ROBOPTIM_DO_NOT_CHECK_ALLOCATION || !defined EIGEN_RUNTIME_NO_MALLOC
+# error "this test must be built with the allocation check enabled"
+#endif
+#ifdef NDEBUG
+# error "this test must be built with assertions enabled"
+#endif
+
+using namespace roboptim;
+
+/// \brief Evaluate problem 71 at several points, with a given number
+/// of evaluation threads.
+static void
+checkSteadyState (int threads)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolver> > nlp =
+    new detail::Tnlp<IpoptSolver> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (n, 4);
+  BOOST_REQUIRE_EQUAL (m, 2);
+
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+				  &rows[0], &cols[0], 0));
+
+  Function::vector_t x (n);
+  Function::vector_t g (m);
+  Function::vector_t gradient (n);
+  Function::vector_t jacobian (nnz_jac_g);
+  x << 1., 5., 5., 1.;
+
+  schittkowski71::G0 g0;
+  schittkowski71::G1 g1;
+
+  // The first evaluation allocates the evaluation buffers: the
+  // following ones run in steady state, where Eigen aborts on any
+  // heap allocation.
+  for (Ipopt::Index iteration = 0; iteration < 10; ++iteration)
+    {
+      x[iteration % n] += .1;
+
+      Ipopt::Number cost;
+      BOOST_REQUIRE (nlp->eval_f (n, x.data (), true, cost));
+      BOOST_REQUIRE (nlp->eval_g (n, x.data (), false, m, g.data ()));
+      BOOST_REQUIRE (nlp->eval_grad_f (n, x.data (), false,
+				       gradient.data ()));
+      BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), false, m, nnz_jac_g,
+				      0, 0, jacobian.data ()));
+
+      BOOST_CHECK_CLOSE (cost, f (x)[0], 1e-10);
+      BOOST_CHECK_CLOSE (g[0], g0 (x)[0], 1e-10);
+      BOOST_CHECK_CLOSE (g[1], g1 (x)[0], 1e-10);
+
+      Function::vector_t expected = f.gradient (x, 0);
+      for (Ipopt::Index j = 0; j < n; ++j)
+	BOOST_CHECK_CLOSE (gradient[j], expected[j], 1e-10);
+
+      Function::matrix_t expectedJacobian (m, n);
+      expectedJacobian << g0.jacobian (x), g1.jacobian (x);
+      for (std::size_t k = 0; k < rows.size (); ++k)
+	BOOST_CHECK_CLOSE (jacobian[static_cast<Ipopt::Index> (k)],
+			   expectedJacobian (rows[k], cols[k]), 1e-10);
+    }
+}
+
+/// \brief Solve problem 71 with a given number of evaluation threads.
+static void
+checkSolve (int threads)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+  solver.solve ();
+
+  const IpoptSolver::result_t& result = solver.minimum ();
+  BOOST_REQUIRE (result.which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).value[0],
+		     schittkowski71::minimum, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE (steady_state_evaluations)
+{
+  checkSteadyState (1);
+}
+
+BOOST_AUTO_TEST_CASE (solve)
+{
+  checkSolve (1);
+}
+
+// The check is only left to the functions while the workers run.
+BOOST_AUTO_TEST_CASE (parallel_evaluations)
+{
+  checkSteadyState (2);
+  checkSolve (2);
+}
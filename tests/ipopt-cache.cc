@@ -0,0 +1,160 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-cache
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "tnlp.hh"
+#include "schittkowski-71.hh"
+
+using namespace roboptim;
+
+BOOST_AUTO_TEST_CASE (cache_statistics)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+
+  const IpoptSolver::result_t& result = solver.minimum ();
+  BOOST_REQUIRE (result.which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).value[0],
+		     schittkowski71::minimum, 1e-4);
+
+  // Ipopt requests the quantities of an iterate several times: at
+  // least some of these requests must be served from the cache.
+  const IpoptCacheStatistics& statistics = solver.cacheStatistics ();
+  BOOST_CHECK_GT (statistics.totalHits (), 0ul);
+  BOOST_CHECK_GT (statistics.totalMisses (), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE (cache_counts)
+{
+  typedef IpoptCacheStatistics statistics_t;
+
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.parameters ()["ipopt.plugin.cache_dense_jacobian"].value = true;
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolver> > nlp =
+    new detail::Tnlp<IpoptSolver> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+
+  Function::vector_t x (n);
+  x << 1., 5., 5., 1.;
+  Ipopt::Number cost;
+  Function::vector_t gradient (n);
+  Function::vector_t g (m);
+  Function::vector_t jacobian (nnz_jac_g);
+
+  // First requests at a point: one miss per quantity.
+  BOOST_REQUIRE (nlp->eval_f (n, x.data (), true, cost));
+  BOOST_REQUIRE (nlp->eval_grad_f (n, x.data (), false, gradient.data ()));
+  BOOST_REQUIRE (nlp->eval_g (n, x.data (), false, m, g.data ()));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), false, m, nnz_jac_g,
+				  0, 0, jacobian.data ()));
+
+  // Same point, either flagged as such or not: one hit per quantity
+  // and per request, with the same values.
+  Ipopt::Number cachedCost;
+  Function::vector_t cachedGradient (n);
+  Function::vector_t cachedG (m);
+  Function::vector_t cachedJacobian (nnz_jac_g);
+  for (int i = 0; i < 2; ++i)
+    {
+      bool newX = i == 1;
+      BOOST_REQUIRE (nlp->eval_f (n, x.data (), newX, cachedCost));
+      BOOST_REQUIRE (nlp->eval_grad_f (n, x.data (), newX,
+				       cachedGradient.data ()));
+      BOOST_REQUIRE (nlp->eval_g (n, x.data (), newX, m, cachedG.data ()));
+      BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), newX, m, nnz_jac_g,
+				      0, 0, cachedJacobian.data ()));
+
+      BOOST_CHECK_EQUAL (cachedCost, cost);
+      BOOST_CHECK_EQUAL (cachedGradient, gradient);
+      BOOST_CHECK_EQUAL (cachedG, g);
+      BOOST_CHECK_EQUAL (cachedJacobian, jacobian);
+    }
+
+  // New point: one more miss for each requested quantity.
+  x[0] += .5;
+  BOOST_REQUIRE (nlp->eval_f (n, x.data (), true, cost));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), false, m, nnz_jac_g,
+				  0, 0, jacobian.data ()));
+
+  const statistics_t& statistics = solver.cacheStatistics ();
+  BOOST_CHECK_EQUAL (statistics.misses[statistics_t::COST], 2ul);
+  BOOST_CHECK_EQUAL (statistics.hits[statistics_t::COST], 2ul);
+  BOOST_CHECK_EQUAL (statistics.misses[statistics_t::COST_GRADIENT], 1ul);
+  BOOST_CHECK_EQUAL (statistics.hits[statistics_t::COST_GRADIENT], 2ul);
+  BOOST_CHECK_EQUAL (statistics.misses[statistics_t::CONSTRAINTS], 1ul);
+  BOOST_CHECK_EQUAL (statistics.hits[statistics_t::CONSTRAINTS], 2ul);
+  BOOST_CHECK_EQUAL
+    (statistics.misses[statistics_t::CONSTRAINTS_JACOBIAN], 2ul);
+  BOOST_CHECK_EQUAL (statistics.hits[statistics_t::CONSTRAINTS_JACOBIAN], 2ul);
+
+  // No Hessian with ipopt.
+  BOOST_CHECK_EQUAL (statistics.misses[statistics_t::HESSIANS], 0ul);
+  BOOST_CHECK_EQUAL (statistics.hits[statistics_t::HESSIANS], 0ul);
+}
+
+BOOST_AUTO_TEST_CASE (dense_jacobian_not_cached)
+{
+  typedef IpoptCacheStatistics statistics_t;
+
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  // Dense Jacobians are not copied by default.
+  IpoptSolver solver (problem);
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolver> > nlp =
+    new detail::Tnlp<IpoptSolver> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+
+  Function::vector_t x (n);
+  x << 1., 5., 5., 1.;
+  Function::vector_t jacobian (nnz_jac_g);
+  Function::vector_t evaluated (nnz_jac_g);
+  BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), true, m, nnz_jac_g,
+				  0, 0, jacobian.data ()));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), false, m, nnz_jac_g,
+				  0, 0, evaluated.data ()));
+  BOOST_CHECK_EQUAL (evaluated, jacobian);
+
+  // Without a copy, there is no lookup to count.
+  const statistics_t& statistics = solver.cacheStatistics ();
+  BOOST_CHECK_EQUAL
+    (statistics.misses[statistics_t::CONSTRAINTS_JACOBIAN], 0ul);
+  BOOST_CHECK_EQUAL (statistics.hits[statistics_t::CONSTRAINTS_JACOBIAN], 0ul);
+}
@@ -0,0 +1,234 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-checkpoint
+
+#include <cstdio>
+#include <string>
+
+#include <boost/optional.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpIpoptApplication.hpp>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "checkpoint.hh"
+#include "schittkowski-71.hh"
+
+using namespace roboptim;
+using detail::Checkpoint;
+
+namespace
+{
+  const std::string path = "ipopt-checkpoint.checkpoint";
+
+  /// \brief Checkpoint file, removed at the beginning and end of each
+  /// case.
+  struct CheckpointFile
+  {
+    CheckpointFile ()
+    {
+      std::remove (path.c_str ());
+    }
+
+    ~CheckpointFile ()
+    {
+      std::remove (path.c_str ());
+    }
+  };
+
+  /// \brief Solver exposing the fingerprint of its checkpoints.
+  struct Solver : public IpoptSolver
+  {
+    explicit Solver (const problem_t& problem)
+      : IpoptSolver (problem)
+    {}
+
+    using IpoptSolver::problemFingerprint;
+  };
+
+  /// \brief Record, at each iteration, the starting iterate and the
+  /// barrier parameter option of a solve.
+  struct Recorder
+  {
+    Recorder (Solver& solver, std::size_t& iterations,
+	      boost::optional<IpoptIterate>& start, double& mu)
+      : solver_ (solver),
+	iterations_ (iterations),
+	start_ (start),
+	mu_ (mu)
+    {}
+
+    void operator () (const IpoptSolver::problem_t&,
+		      IpoptSolver::solverState_t&)
+    {
+      ++iterations_;
+      start_ = solver_.startingIterate ();
+      solver_.getIpoptApplication ()->Options ()->GetNumericValue
+	("mu_init", mu_, "");
+    }
+
+    Solver& solver_;
+    std::size_t& iterations_;
+    boost::optional<IpoptIterate>& start_;
+    double& mu_;
+  };
+
+  void
+  enableCheckpoints (IpoptSolver& solver)
+  {
+    solver.parameters ()["ipopt.plugin.checkpoint_file"].value = path;
+    solver.parameters ()["ipopt.plugin.checkpoint_iterations"].value = 1;
+    solver.parameters ()["ipopt.plugin.checkpoint_seconds"].value = 0.;
+  }
+
+  bool
+  loadCheckpoint (const Solver& solver, Checkpoint& checkpoint)
+  {
+    checkpoint.x.resize (4);
+    checkpoint.lambda.resize (2);
+    return Checkpoint::load (path, solver.problemFingerprint (), checkpoint);
+  }
+
+  void
+  checkMinimum (const IpoptSolver& solver)
+  {
+    BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+    BOOST_CHECK_CLOSE (boost::get<Result> (solver.minimum ()).value[0],
+		       schittkowski71::minimum, 1e-4);
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (write_and_resume)
+{
+  CheckpointFile file;
+
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  // Interrupted solve.
+  Solver interrupted (problem);
+  enableCheckpoints (interrupted);
+  interrupted.parameters ()["max-iterations"].value = 5;
+  interrupted.solve ();
+  BOOST_CHECK (interrupted.minimum ().which () != IpoptSolver::SOLVER_VALUE);
+
+  Checkpoint checkpoint;
+  BOOST_REQUIRE (loadCheckpoint (interrupted, checkpoint));
+  BOOST_CHECK_GT (checkpoint.iteration, 0);
+  BOOST_CHECK_LE (checkpoint.iteration, 5);
+  BOOST_CHECK_GT (checkpoint.mu, 0.);
+  BOOST_REQUIRE_EQUAL (checkpoint.zL.size (), 4);
+  BOOST_REQUIRE_EQUAL (checkpoint.zU.size (), 4);
+  for (int i = 0; i < 4; ++i)
+    {
+      BOOST_CHECK_GE (checkpoint.x[i], 1.);
+      BOOST_CHECK_LE (checkpoint.x[i], 5.);
+    }
+
+  // Resumed solve: it starts from the checkpoint with its barrier
+  // parameter.
+  Solver resumed (problem);
+  enableCheckpoints (resumed);
+  resumed.parameters ()["ipopt.plugin.checkpoint_resume"].value = true;
+
+  double muBefore = 0.;
+  resumed.getIpoptApplication ()->Options ()->GetNumericValue
+    ("mu_init", muBefore, "");
+
+  std::size_t iterations = 0;
+  boost::optional<IpoptIterate> start;
+  double mu = 0.;
+  resumed.setIterationCallback (Recorder (resumed, iterations, start, mu));
+  resumed.solve ();
+  checkMinimum (resumed);
+
+  BOOST_REQUIRE (start);
+  BOOST_CHECK_EQUAL (start->x, checkpoint.x);
+  BOOST_CHECK_EQUAL (start->lambda, checkpoint.lambda);
+  BOOST_CHECK_EQUAL (mu, checkpoint.mu);
+  BOOST_CHECK_GT (iterations, 0u);
+
+  // Options and stored iterate only hold for the resumed solve.
+  double muAfter = 0.;
+  resumed.getIpoptApplication ()->Options ()->GetNumericValue
+    ("mu_init", muAfter, "");
+  BOOST_CHECK_EQUAL (muAfter, muBefore);
+  BOOST_CHECK (!resumed.startingIterate ());
+}
+
+BOOST_AUTO_TEST_CASE (resolve_writes_checkpoints)
+{
+  CheckpointFile file;
+
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  Solver solver (problem);
+  enableCheckpoints (solver);
+  solver.solve ();
+  checkMinimum (solver);
+
+  Checkpoint checkpoint;
+  BOOST_REQUIRE (loadCheckpoint (solver, checkpoint));
+
+  // Re-solves, which do not query the problem information again, reset
+  // the checkpoints of the previous solve as well.
+  std::remove (path.c_str ());
+  solver.resolve ();
+  checkMinimum (solver);
+  BOOST_REQUIRE (loadCheckpoint (solver, checkpoint));
+  BOOST_CHECK_GT (checkpoint.iteration, 0);
+}
+
+BOOST_AUTO_TEST_CASE (fingerprint_mismatch)
+{
+  CheckpointFile file;
+
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  Solver solver (problem);
+
+  Checkpoint checkpoint;
+  checkpoint.iteration = 3;
+  checkpoint.mu = 1e-3;
+  checkpoint.x = Eigen::VectorXd::Constant (4, 2.);
+  checkpoint.lambda = Eigen::VectorXd::Zero (2);
+  checkpoint.zL = Eigen::VectorXd::Ones (4);
+  checkpoint.zU = Eigen::VectorXd::Ones (4);
+  BOOST_REQUIRE (Checkpoint::save (path, solver.problemFingerprint () + 1,
+				   checkpoint));
+
+  enableCheckpoints (solver);
+  solver.parameters ()["ipopt.plugin.checkpoint_resume"].value = true;
+
+  std::size_t iterations = 0;
+  boost::optional<IpoptIterate> start;
+  double mu = 0.;
+  solver.setIterationCallback (Recorder (solver, iterations, start, mu));
+  solver.solve ();
+  checkMinimum (solver);
+
+  // The checkpoint of another problem is ignored.
+  BOOST_CHECK (!start);
+}
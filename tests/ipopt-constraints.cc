@@ -0,0 +1,239 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-constraints
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+#include <roboptim/core/numeric-linear-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// x₀² + x₁² + x₂²
+  struct Cost : public DifferentiableFunction
+  {
+    Cost ()
+      : DifferentiableFunction (3, 1, "x₀² + x₁² + x₂²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x.squaredNorm ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient = 2. * x;
+    }
+  };
+
+  /// (x₀ x₁, sin (x₂))
+  struct Pair : public DifferentiableFunction
+  {
+    Pair ()
+      : DifferentiableFunction (3, 2, "(x₀ x₁, sin (x₂))")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result << x[0] * x[1], std::sin (x[2]);
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type i) const
+    {
+      if (i == 0)
+	gradient << x[1], x[0], 0.;
+      else
+	gradient << 0., 0., std::cos (x[2]);
+    }
+  };
+
+  /// (x₀², x₁ x₂, x₀ + x₂³)
+  struct Triple : public DifferentiableFunction
+  {
+    Triple ()
+      : DifferentiableFunction (3, 3, "(x₀², x₁ x₂, x₀ + x₂³)")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result << x[0] * x[0], x[1] * x[2], x[0] + x[2] * x[2] * x[2];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type i) const
+    {
+      if (i == 0)
+	gradient << 2. * x[0], 0., 0.;
+      else if (i == 1)
+	gradient << 0., x[2], x[1];
+      else
+	gradient << 1., 0., 3. * x[2] * x[2];
+    }
+  };
+
+  /// \brief Problem whose constraints have different output sizes, with
+  /// a linear constraint between nonlinear ones.
+  struct Constraints
+  {
+    Constraints ()
+      : cost (),
+	pair (new Pair ()),
+	linear (),
+	triple (new Triple ()),
+	problem (cost)
+    {
+      Function::matrix_t a (1, 3);
+      a << 2., -1., 3.;
+      Function::vector_t b (1);
+      b << 1.;
+      linear.reset (new NumericLinearFunction (a, b));
+
+      typedef IpoptSolver::problem_t problem_t;
+      problem.addConstraint
+	(boost::shared_ptr<DifferentiableFunction> (pair),
+	 problem_t::intervals_t (2, Function::makeUpperInterval (10.)),
+	 problem_t::scales_t (2, 1.));
+      problem.addConstraint
+	(boost::shared_ptr<LinearFunction> (linear),
+	 Function::makeUpperInterval (10.));
+      problem.addConstraint
+	(boost::shared_ptr<DifferentiableFunction> (triple),
+	 problem_t::intervals_t (3, Function::makeUpperInterval (10.)),
+	 problem_t::scales_t (3, 1.));
+
+      problem_t::vector_t x (3);
+      x << .5, 1., 1.5;
+      problem.startingPoint () = x;
+    }
+
+    /// \brief Stacked constraints Jacobian.
+    Function::matrix_t
+    jacobian (const Function::vector_t& x) const
+    {
+      Function::matrix_t result (6, 3);
+      result << pair->jacobian (x), linear->jacobian (x),
+	triple->jacobian (x);
+      return result;
+    }
+
+    Cost cost;
+    boost::shared_ptr<Pair> pair;
+    boost::shared_ptr<NumericLinearFunction> linear;
+    boost::shared_ptr<Triple> triple;
+    IpoptSolver::problem_t problem;
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (dense_jacobian_layout)
+{
+  Constraints constraints;
+  IpoptSolver solver (constraints.problem);
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolver> > nlp =
+    new detail::Tnlp<IpoptSolver> (constraints.problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (m, 6);
+  BOOST_REQUIRE_EQUAL (nnz_jac_g, m * n);
+
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+				  &rows[0], &cols[0], 0));
+
+  // The blocks are written in place: the structure follows the storage
+  // order of the Jacobian type.
+  bool colMajor =
+    GenericFunctionTraits<Function::traits_t>::StorageOrder == Eigen::ColMajor;
+  for (Ipopt::Index k = 0; k < nnz_jac_g; ++k)
+    {
+      std::size_t k_ = static_cast<std::size_t> (k);
+      BOOST_CHECK_EQUAL (rows[k_], colMajor ? k % m : k / n);
+      BOOST_CHECK_EQUAL (cols[k_], colMajor ? k / m : k % n);
+    }
+
+  // Two points, so that the second one overwrites the blocks of the
+  // first.
+  for (int i = 0; i < 2; ++i)
+    {
+      Function::vector_t x (n);
+      x << 1.2 + i, -.4, .7 * (i + 1);
+
+      std::vector<Ipopt::Number> values (rows.size ());
+      BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), true, m, nnz_jac_g,
+				      0, 0, &values[0]));
+
+      Function::matrix_t expected = constraints.jacobian (x);
+      for (std::size_t k = 0; k < values.size (); ++k)
+	BOOST_CHECK_EQUAL (values[k], expected (rows[k], cols[k]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (constraints_offsets)
+{
+  Constraints constraints;
+  IpoptSolver solver (constraints.problem);
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolver> > nlp =
+    new detail::Tnlp<IpoptSolver> (constraints.problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (m, 6);
+
+  // Rows 0-1: pair, row 2: linear, rows 3-5: triple.
+  std::vector<Ipopt::TNLP::LinearityType> linearity
+    (static_cast<std::size_t> (m));
+  BOOST_REQUIRE (nlp->get_constraints_linearity (m, &linearity[0]));
+  for (std::size_t i = 0; i < linearity.size (); ++i)
+    BOOST_CHECK_EQUAL (linearity[i], i == 2
+		       ? Ipopt::TNLP::LINEAR : Ipopt::TNLP::NON_LINEAR);
+
+  Function::vector_t x (n);
+  x << 1.2, -.4, .7;
+  Function::vector_t g (m);
+  BOOST_REQUIRE (nlp->eval_g (n, x.data (), true, m, g.data ()));
+
+  Function::vector_t expected (m);
+  expected << (*constraints.pair) (x), (*constraints.linear) (x),
+    (*constraints.triple) (x);
+  for (Ipopt::Index i = 0; i < m; ++i)
+    BOOST_CHECK_CLOSE (g[i], expected[i], 1e-10);
+}
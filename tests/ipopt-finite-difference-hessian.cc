@@ -0,0 +1,223 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-finite-difference-hessian
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-td.hh>
+
+#include "coloring.hh"
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// Number of variables. The Hessians are tridiagonal.
+  const int size = 5;
+
+  /// Σ xᵢ² xᵢ₊₁ + xₙ₋₁³
+  struct Cost : public TwiceDifferentiableFunction
+  {
+    Cost ()
+      : TwiceDifferentiableFunction (size, 1, "Σ xᵢ² xᵢ₊₁ + xₙ₋₁³")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[size - 1] * x[size - 1] * x[size - 1];
+      for (int i = 0; i + 1 < size; ++i)
+	result[0] += x[i] * x[i] * x[i + 1];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      for (int i = 0; i + 1 < size; ++i)
+	{
+	  gradient[i] += 2. * x[i] * x[i + 1];
+	  gradient[i + 1] += x[i] * x[i];
+	}
+      gradient[size - 1] += 3. * x[size - 1] * x[size - 1];
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian.setZero ();
+      for (int i = 0; i + 1 < size; ++i)
+	{
+	  hessian (i, i) = 2. * x[i + 1];
+	  hessian (i, i + 1) = hessian (i + 1, i) = 2. * x[i];
+	}
+      hessian (size - 1, size - 1) = 6. * x[size - 1];
+    }
+  };
+
+  /// Σ xᵢ xᵢ₊₁ + sin (x₀)
+  struct Constraint : public TwiceDifferentiableFunction
+  {
+    Constraint ()
+      : TwiceDifferentiableFunction (size, 1, "Σ xᵢ xᵢ₊₁ + sin (x₀)")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = std::sin (x[0]);
+      for (int i = 0; i + 1 < size; ++i)
+	result[0] += x[i] * x[i + 1];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      for (int i = 0; i + 1 < size; ++i)
+	{
+	  gradient[i] += x[i + 1];
+	  gradient[i + 1] += x[i];
+	}
+      gradient[0] += std::cos (x[0]);
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian.setZero ();
+      for (int i = 0; i + 1 < size; ++i)
+	hessian (i, i + 1) = hessian (i + 1, i) = 1.;
+      hessian (0, 0) = -std::sin (x[0]);
+    }
+  };
+
+  IpoptSolverTd::problem_t::vector_t
+  point (double offset)
+  {
+    IpoptSolverTd::problem_t::vector_t x (size);
+    for (int i = 0; i < size; ++i)
+      x[i] = offset + .2 * i;
+    return x;
+  }
+
+  /// \brief Lagrangian Hessian structure and values of a solver.
+  struct Hessian
+  {
+    Hessian (IpoptSolverTd::problem_t& problem, bool finiteDifferences)
+      : solver (problem)
+    {
+      solver.parameters ()["ipopt.plugin.finite_difference_hessian"].value =
+	finiteDifferences;
+      nlp = new detail::Tnlp<IpoptSolverTd> (problem, solver);
+
+      BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+      rows.resize (static_cast<std::size_t> (nnz_h_lag));
+      cols.resize (static_cast<std::size_t> (nnz_h_lag));
+      values.resize (static_cast<std::size_t> (nnz_h_lag));
+      BOOST_REQUIRE (nlp->eval_h (n, 0, true, 0., m, 0, true, nnz_h_lag,
+				  &rows[0], &cols[0], 0));
+    }
+
+    void
+    evaluate (const IpoptSolverTd::problem_t::vector_t& x,
+	      double objFactor, double lambda)
+    {
+      BOOST_REQUIRE (nlp->eval_h (n, x.data (), true, objFactor, m, &lambda,
+				  true, nnz_h_lag, 0, 0, &values[0]));
+    }
+
+    IpoptSolverTd solver;
+    Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp;
+    Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum style;
+    std::vector<Ipopt::Index> rows;
+    std::vector<Ipopt::Index> cols;
+    std::vector<Ipopt::Number> values;
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (path_star_coloring)
+{
+  // Path 0 - 1 - ... - n - 1: the adjacency graph of a tridiagonal
+  // Hessian.
+  std::vector<int> offsets (1, 0);
+  std::vector<int> neighbors;
+  for (int i = 0; i < size; ++i)
+    {
+      if (i > 0)
+	neighbors.push_back (i - 1);
+      if (i + 1 < size)
+	neighbors.push_back (i + 1);
+      offsets.push_back (static_cast<int> (neighbors.size ()));
+    }
+
+  std::vector<int> colors;
+  BOOST_CHECK_EQUAL (detail::starColoring (size, offsets, neighbors, colors),
+		     3);
+  const int expected[] = {0, 1, 0, 2, 0};
+  BOOST_CHECK_EQUAL_COLLECTIONS (colors.begin (), colors.end (),
+				 expected, expected + size);
+
+  // Adjacent vertices have different colors, and no path on four
+  // vertices is two-colored.
+  for (int i = 0; i + 1 < size; ++i)
+    BOOST_CHECK_NE (colors[i], colors[i + 1]);
+  for (int i = 0; i + 3 < size; ++i)
+    BOOST_CHECK (colors[i] != colors[i + 2] || colors[i + 1] != colors[i + 3]);
+}
+
+BOOST_AUTO_TEST_CASE (finite_difference_hessian)
+{
+  Cost cost;
+  IpoptSolverTd::problem_t problem (cost);
+  boost::shared_ptr<TwiceDifferentiableFunction>
+    constraint (new Constraint ());
+  problem.addConstraint (constraint, Function::makeUpperInterval (10.));
+  problem.startingPoint () = point (1.);
+
+  Hessian exact (problem, false);
+  Hessian differences (problem, true);
+
+  // Tridiagonal, whatever the detection method.
+  BOOST_REQUIRE_EQUAL (exact.nnz_h_lag, 2 * size - 1);
+  BOOST_CHECK (exact.rows == differences.rows);
+  BOOST_CHECK (exact.cols == differences.cols);
+
+  // With the coloring above, (1, 0) is read at row 0 of the product
+  // of the color of 1, since 0 and 2, both neighbors of 1, share a
+  // color. The other entries are read at their own row.
+  IpoptSolverTd::problem_t::vector_t x = point (.7);
+  exact.evaluate (x, .7, 1.3);
+  differences.evaluate (x, .7, 1.3);
+  for (std::size_t k = 0; k < exact.values.size (); ++k)
+    BOOST_CHECK_SMALL (differences.values[k] - exact.values[k], 1e-5);
+}
@@ -0,0 +1,240 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-finite-difference-jacobians
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+
+#include "coloring.hh"
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+typedef Eigen::Triplet<double> triplet_t;
+
+namespace
+{
+  const int size = 10;
+
+  /// Σ (xᵢ - 1)²
+  struct Cost : public DifferentiableSparseFunction
+  {
+    Cost ()
+      : DifferentiableSparseFunction (size, 1, "Σ (xᵢ - 1)²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = (x.array () - 1.).square ().sum ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      for (size_type i = 0; i < size; ++i)
+	gradient.insert (i) = 2. * (x[i] - 1.);
+    }
+  };
+
+  /// gᵢ = sin (xᵢ₋₁) + xᵢ² + xᵢ xᵢ₊₁ (missing neighbors omitted)
+  ///
+  /// The Jacobian is tridiagonal. Evaluations are counted.
+  struct Band : public DifferentiableSparseFunction
+  {
+    Band ()
+      : DifferentiableSparseFunction (size, size,
+				      "sin (xᵢ₋₁) + xᵢ² + xᵢ xᵢ₊₁"),
+	evaluations (0)
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      ++evaluations;
+      for (size_type i = 0; i < size; ++i)
+	{
+	  result[i] = x[i] * x[i];
+	  if (i > 0)
+	    result[i] += std::sin (x[i - 1]);
+	  if (i + 1 < size)
+	    result[i] += x[i] * x[i + 1];
+	}
+    }
+
+    /// \brief Nonzeros of row i (in row 0).
+    void
+    entries (std::vector<triplet_t>& entries, const_argument_ref x,
+	     size_type i) const
+    {
+      int j = static_cast<int> (i);
+      if (i > 0)
+	entries.push_back (triplet_t (0, j - 1, std::cos (x[i - 1])));
+      entries.push_back
+	(triplet_t (0, j, 2. * x[i] + (i + 1 < size ? x[i + 1] : 0.)));
+      if (i + 1 < size)
+	entries.push_back (triplet_t (0, j + 1, x[i]));
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type i) const
+    {
+      std::vector<triplet_t> row;
+      entries (row, x, i);
+      gradient.setZero ();
+      for (std::size_t k = 0; k < row.size (); ++k)
+	gradient.insert (row[k].col ()) = row[k].value ();
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      std::vector<triplet_t> all;
+      for (size_type i = 0; i < size; ++i)
+	{
+	  std::vector<triplet_t> row;
+	  entries (row, x, i);
+	  for (std::size_t k = 0; k < row.size (); ++k)
+	    all.push_back (triplet_t (static_cast<int> (i), row[k].col (),
+				      row[k].value ()));
+	}
+      jacobian.setFromTriplets (all.begin (), all.end ());
+    }
+
+    mutable std::size_t evaluations;
+  };
+
+  IpoptSolverSparse::problem_t::vector_t
+  startingPoint ()
+  {
+    IpoptSolverSparse::problem_t::vector_t x (size);
+    for (int i = 0; i < size; ++i)
+      x[i] = 1. + .1 * i;
+    return x;
+  }
+
+  void
+  setup (IpoptSolverSparse::problem_t& problem,
+	 boost::shared_ptr<Band> band)
+  {
+    typedef IpoptSolverSparse::problem_t problem_t;
+    problem.addConstraint
+      (boost::shared_ptr<DifferentiableSparseFunction> (band),
+       problem_t::intervals_t (size, Function::makeUpperInterval (2.)),
+       problem_t::scales_t (size, 1.));
+    problem.startingPoint () = startingPoint ();
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (banded_coloring)
+{
+  // Tridiagonal structure, in compressed row storage.
+  std::vector<int> rowOffsets (1, 0);
+  std::vector<int> rowColumns;
+  for (int i = 0; i < size; ++i)
+    {
+      for (int j = std::max (i - 1, 0); j <= std::min (i + 1, size - 1); ++j)
+	rowColumns.push_back (j);
+      rowOffsets.push_back (static_cast<int> (rowColumns.size ()));
+    }
+
+  std::vector<int> colors;
+  BOOST_CHECK_EQUAL
+    (detail::columnColoring (size, rowOffsets, rowColumns, colors), 3);
+
+  // Columns sharing a row have different colors.
+  for (int i = 0; i < size; ++i)
+    for (int p = rowOffsets[i]; p < rowOffsets[i + 1]; ++p)
+      for (int q = p + 1; q < rowOffsets[i + 1]; ++q)
+	BOOST_CHECK_NE (colors[rowColumns[p]], colors[rowColumns[q]]);
+}
+
+BOOST_AUTO_TEST_CASE (banded_jacobian)
+{
+  Cost cost;
+  IpoptSolverSparse::problem_t problem (cost);
+  boost::shared_ptr<Band> band (new Band ());
+  setup (problem, band);
+
+  IpoptSolverSparse solver (problem);
+  solver.parameters ()["ipopt.plugin.finite_difference_jacobians"].value =
+    true;
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverSparse> > nlp =
+    new detail::Tnlp<IpoptSolverSparse> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (nnz_jac_g, 3 * size - 2);
+
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+				  &rows[0], &cols[0], 0));
+
+  // At a new point, the Jacobian costs one evaluation at the point and
+  // one per color.
+  IpoptSolverSparse::problem_t::vector_t x = startingPoint ();
+  x *= 1.5;
+  std::vector<Ipopt::Number> values (static_cast<std::size_t> (nnz_jac_g));
+  band->evaluations = 0;
+  BOOST_REQUIRE (nlp->eval_jac_g (n, x.data (), true, m, nnz_jac_g,
+				  0, 0, &values[0]));
+  BOOST_CHECK_EQUAL (band->evaluations, 1u + 3u);
+
+  Band::jacobian_t expected = band->jacobian (x);
+  for (std::size_t k = 0; k < values.size (); ++k)
+    BOOST_CHECK_SMALL (values[k] - expected.coeff (rows[k], cols[k]), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE (banded_solve)
+{
+  Cost cost;
+  IpoptSolverSparse::problem_t problem (cost);
+  setup (problem, boost::shared_ptr<Band> (new Band ()));
+
+  IpoptSolverSparse exact (problem);
+  exact.solve ();
+  BOOST_REQUIRE (exact.minimum ().which () == IpoptSolverSparse::SOLVER_VALUE);
+  const Result& expected = boost::get<Result> (exact.minimum ());
+
+  IpoptSolverSparse solver (problem);
+  solver.parameters ()["ipopt.plugin.finite_difference_jacobians"].value =
+    true;
+  solver.solve ();
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolverSparse::SOLVER_VALUE);
+  const Result& result = boost::get<Result> (solver.minimum ());
+
+  BOOST_CHECK_CLOSE (result.value[0], expected.value[0], 1e-4);
+  BOOST_CHECK_SMALL ((result.x - expected.x).lpNorm<Eigen::Infinity> (),
+		     1e-4);
+}
@@ -0,0 +1,245 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-hessian-cache
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-td.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// x₀² x₁ + x₂³
+  ///
+  /// Hessian evaluations are counted.
+  struct Cost : public TwiceDifferentiableFunction
+  {
+    Cost ()
+      : TwiceDifferentiableFunction (3, 1, "x₀² x₁ + x₂³"),
+	hessians (0)
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * x[0] * x[1] + x[2] * x[2] * x[2];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient << 2. * x[0] * x[1], x[0] * x[0], 3. * x[2] * x[2];
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      ++hessians;
+      hessian <<
+	2. * x[1], 2. * x[0], 0.,
+	2. * x[0], 0.,        0.,
+	0.,        0.,        6. * x[2];
+    }
+
+    mutable std::size_t hessians;
+  };
+
+  /// (x₀ x₂, x₁² + sin (x₂))
+  ///
+  /// Hessian evaluations are counted.
+  struct Constraint : public TwiceDifferentiableFunction
+  {
+    Constraint ()
+      : TwiceDifferentiableFunction (3, 2, "(x₀ x₂, x₁² + sin (x₂))"),
+	hessians (0)
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result << x[0] * x[2], x[1] * x[1] + std::sin (x[2]);
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type i) const
+    {
+      if (i == 0)
+	gradient << x[2], 0., x[0];
+      else
+	gradient << 0., 2. * x[1], std::cos (x[2]);
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type i) const
+    {
+      ++hessians;
+      hessian.setZero ();
+      if (i == 0)
+	hessian (0, 2) = hessian (2, 0) = 1.;
+      else
+	{
+	  hessian (1, 1) = 2.;
+	  hessian (2, 2) = -std::sin (x[2]);
+	}
+    }
+
+    mutable std::size_t hessians;
+  };
+
+  IpoptSolverTd::problem_t
+  makeProblem (const Cost& cost, boost::shared_ptr<Constraint> constraint)
+  {
+    IpoptSolverTd::problem_t problem (cost);
+    problem.addConstraint
+      (boost::shared_ptr<TwiceDifferentiableFunction> (constraint),
+       IpoptSolverTd::problem_t::intervals_t
+       (2, Function::makeUpperInterval (10.)),
+       IpoptSolverTd::problem_t::scales_t (2, 1.));
+
+    IpoptSolverTd::problem_t::vector_t x (3);
+    x << 1., 1.5, .5;
+    problem.startingPoint () = x;
+    return problem;
+  }
+
+  /// \brief Lagrangian Hessian of a solver, with its evaluations.
+  struct Lagrangian
+  {
+    explicit Lagrangian (bool cacheHessians)
+      : cost (),
+	constraint (new Constraint ()),
+	problem (makeProblem (cost, constraint)),
+	solver (problem)
+    {
+      if (!cacheHessians)
+	solver.parameters ()["ipopt.plugin.cache_hessians"].value = false;
+      nlp = new detail::Tnlp<IpoptSolverTd> (problem, solver);
+
+      BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+      rows.resize (static_cast<std::size_t> (nnz_h_lag));
+      cols.resize (static_cast<std::size_t> (nnz_h_lag));
+      BOOST_REQUIRE (nlp->eval_h (n, 0, true, 0., m, 0, true, nnz_h_lag,
+				  &rows[0], &cols[0], 0));
+
+      // Structure detection evaluates Hessians as well.
+      cost.hessians = 0;
+      constraint->hessians = 0;
+    }
+
+    /// \brief Evaluate the Hessian values and check them against the
+    /// functions Hessians.
+    void
+    evaluate (const Function::vector_t& x, bool newX,
+	      double objFactor, const Function::vector_t& lambda)
+    {
+      std::vector<Ipopt::Number> values (rows.size ());
+      BOOST_REQUIRE (nlp->eval_h (n, x.data (), newX, objFactor, m,
+				  lambda.data (), true, nnz_h_lag,
+				  0, 0, &values[0]));
+
+      // Reference values, not counted.
+      std::size_t costHessians = cost.hessians;
+      std::size_t constraintHessians = constraint->hessians;
+      Function::matrix_t expected = objFactor * cost.hessian (x, 0)
+	+ lambda[0] * constraint->hessian (x, 0)
+	+ lambda[1] * constraint->hessian (x, 1);
+      cost.hessians = costHessians;
+      constraint->hessians = constraintHessians;
+
+      for (std::size_t k = 0; k < values.size (); ++k)
+	BOOST_CHECK_CLOSE (values[k], expected (rows[k], cols[k]), 1e-10);
+    }
+
+    Cost cost;
+    boost::shared_ptr<Constraint> constraint;
+    IpoptSolverTd::problem_t problem;
+    IpoptSolverTd solver;
+    Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp;
+    Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum style;
+    std::vector<Ipopt::Index> rows;
+    std::vector<Ipopt::Index> cols;
+  };
+
+  Function::vector_t
+  multipliers (double l0, double l1)
+  {
+    Function::vector_t lambda (2);
+    lambda << l0, l1;
+    return lambda;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (multipliers_only)
+{
+  // Hessians are cached by default.
+  Lagrangian lagrangian (true);
+
+  Function::vector_t x (3);
+  x << 1.2, .8, .3;
+
+  lagrangian.evaluate (x, true, 1., multipliers (.5, 2.));
+  BOOST_CHECK_EQUAL (lagrangian.cost.hessians, 1u);
+  BOOST_CHECK_EQUAL (lagrangian.constraint->hessians, 2u);
+
+  // Same point, new multipliers and objective factor: the cached
+  // Hessians are re-weighted.
+  lagrangian.evaluate (x, false, 3., multipliers (-1., .25));
+  lagrangian.evaluate (x, true, .5, multipliers (4., 0.));
+  BOOST_CHECK_EQUAL (lagrangian.cost.hessians, 1u);
+  BOOST_CHECK_EQUAL (lagrangian.constraint->hessians, 2u);
+
+  const IpoptCacheStatistics& statistics =
+    lagrangian.solver.cacheStatistics ();
+  BOOST_CHECK_EQUAL (statistics.hits[IpoptCacheStatistics::HESSIANS], 2ul);
+  BOOST_CHECK_EQUAL (statistics.misses[IpoptCacheStatistics::HESSIANS], 1ul);
+
+  // A new point requires new Hessians.
+  x[1] += .1;
+  lagrangian.evaluate (x, true, 1., multipliers (.5, 2.));
+  BOOST_CHECK_EQUAL (lagrangian.cost.hessians, 2u);
+  BOOST_CHECK_EQUAL (lagrangian.constraint->hessians, 4u);
+}
+
+BOOST_AUTO_TEST_CASE (cache_disabled)
+{
+  Lagrangian lagrangian (false);
+
+  Function::vector_t x (3);
+  x << 1.2, .8, .3;
+
+  lagrangian.evaluate (x, true, 1., multipliers (.5, 2.));
+  lagrangian.evaluate (x, false, 3., multipliers (-1., .25));
+  BOOST_CHECK_EQUAL (lagrangian.cost.hessians, 2u);
+  BOOST_CHECK_EQUAL (lagrangian.constraint->hessians, 4u);
+}
@@ -0,0 +1,189 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-hessian-structure
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-td.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// (x₀ - 2)² + (x₁ - 1)²
+  struct Cost : public TwiceDifferentiableFunction
+  {
+    Cost ()
+      : TwiceDifferentiableFunction (2, 1, "(x₀ - 2)² + (x₁ - 1)²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = (x[0] - 2.) * (x[0] - 2.) + (x[1] - 1.) * (x[1] - 1.);
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient << 2. * (x[0] - 2.), 2. * (x[1] - 1.);
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref,
+		  size_type) const
+    {
+      hessian << 2., 0., 0., 2.;
+    }
+  };
+
+  /// x₀ + p³ x₁ with p = max (x₀ - 1, 0)
+  ///
+  /// The Hessian has a nonzero at (1, 0) for x₀ > 1 only.
+  struct Kink : public TwiceDifferentiableFunction
+  {
+    Kink ()
+      : TwiceDifferentiableFunction (2, 1, "x₀ + max (x₀ - 1, 0)³ x₁")
+    {}
+
+    static double
+    p (const_argument_ref x)
+    {
+      return std::max (x[0] - 1., 0.);
+    }
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] + p (x) * p (x) * p (x) * x[1];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient << 1. + 3. * p (x) * p (x) * x[1], p (x) * p (x) * p (x);
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian <<
+	6. * p (x) * x[1], 3. * p (x) * p (x),
+	3. * p (x) * p (x), 0.;
+    }
+  };
+
+  /// \brief Lagrangian Hessian evaluations of a solver whose sample
+  /// points all have x₀ < 1.
+  struct Lagrangian
+  {
+    Lagrangian (bool declared, bool check)
+      : cost (),
+	problem (cost)
+    {
+      problem.argumentBounds ()[0] = Function::makeInterval (0., .9);
+      problem.argumentBounds ()[1] = Function::makeInterval (0., 3.);
+      boost::shared_ptr<TwiceDifferentiableFunction> kink (new Kink ());
+      problem.addConstraint (kink, Function::makeUpperInterval (10.));
+
+      IpoptSolverTd::problem_t::vector_t x (2);
+      x << .5, .5;
+      problem.startingPoint () = x;
+
+      solver.reset (new IpoptSolverTd (problem));
+      if (declared)
+	{
+	  // The diagonal only, as detected.
+	  IpoptSolverTd::sparsityPattern_t pattern (2, 2);
+	  pattern.insert (0, 0) = 1.;
+	  pattern.insert (1, 1) = 1.;
+	  solver->setHessianSparsityPattern (pattern);
+	}
+      solver->parameters ()["ipopt.plugin.check_hessian_structure"].value =
+	check;
+      nlp = new detail::Tnlp<IpoptSolverTd> (problem, *solver);
+
+      BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+      BOOST_REQUIRE_EQUAL (nnz_h_lag, 2);
+
+      Ipopt::Index rows[2];
+      Ipopt::Index cols[2];
+      BOOST_REQUIRE (nlp->eval_h (n, 0, true, 0., m, 0, true, nnz_h_lag,
+				  rows, cols, 0));
+    }
+
+    /// \brief Evaluate the Hessian at (x₀, 1).
+    bool
+    evaluate (double x0)
+    {
+      IpoptSolverTd::problem_t::vector_t x (2);
+      x << x0, 1.;
+      Ipopt::Number lambda = 1.;
+      Ipopt::Number values[2];
+      return nlp->eval_h (n, x.data (), true, 1., m, &lambda, true,
+			  nnz_h_lag, 0, 0, values);
+    }
+
+    Cost cost;
+    IpoptSolverTd::problem_t problem;
+    boost::shared_ptr<IpoptSolverTd> solver;
+    Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp;
+    Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum style;
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (detected_structure_first_evaluation)
+{
+  // The first evaluation after the detection is checked.
+  Lagrangian lagrangian (false, false);
+  BOOST_CHECK (!lagrangian.evaluate (1.5));
+}
+
+BOOST_AUTO_TEST_CASE (detected_structure_later_evaluations)
+{
+  // Later ones are not.
+  Lagrangian lagrangian (false, false);
+  BOOST_CHECK (lagrangian.evaluate (.5));
+  BOOST_CHECK (lagrangian.evaluate (1.5));
+}
+
+BOOST_AUTO_TEST_CASE (declared_structure)
+{
+  // Declared patterns are not checked...
+  Lagrangian unchecked (true, false);
+  BOOST_CHECK (unchecked.evaluate (1.5));
+
+  // ... unless asked, as any evaluation then.
+  Lagrangian checked (true, true);
+  BOOST_CHECK (checked.evaluate (.5));
+  BOOST_CHECK (!checked.evaluate (1.5));
+}
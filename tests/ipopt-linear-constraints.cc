@@ -0,0 +1,205 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-linear-constraints
+
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+#include <roboptim/core/linear-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+typedef Eigen::Triplet<double> triplet_t;
+
+namespace
+{
+  const int size = 4;
+
+  /// Σ xᵢ²
+  struct Cost : public DifferentiableSparseFunction
+  {
+    Cost ()
+      : DifferentiableSparseFunction (size, 1, "Σ xᵢ²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x.squaredNorm ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      for (size_type i = 0; i < size; ++i)
+	gradient.insert (i) = 2. * x[i];
+    }
+  };
+
+  /// A x + b, with a sparse A.
+  ///
+  /// Evaluations are counted.
+  struct Linear : public LinearSparseFunction
+  {
+    Linear (const std::vector<triplet_t>& entries, const vector_t& b)
+      : LinearSparseFunction (size, b.size (), "A x + b"),
+	a_ (b.size (), size),
+	b_ (b),
+	evaluations (0)
+    {
+      a_.setFromTriplets (entries.begin (), entries.end ());
+      a_.makeCompressed ();
+    }
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      ++evaluations;
+      result = a_ * x + b_;
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref,
+		   size_type i) const
+    {
+      gradient = a_.row (i).transpose ();
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref) const
+    {
+      jacobian = a_;
+    }
+
+    jacobian_t a_;
+    vector_t b_;
+    mutable std::size_t evaluations;
+  };
+
+  /// x₀ x₃
+  struct Product : public DifferentiableSparseFunction
+  {
+    Product ()
+      : DifferentiableSparseFunction (size, 1, "x₀ x₃")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * x[3];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient.insert (0) = x[3];
+      gradient.insert (3) = x[0];
+    }
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (stacked_linear_constraints)
+{
+  typedef IpoptSolverSparse::problem_t problem_t;
+
+  // Rows 0-1: first linear constraint, row 2: product, row 3: second
+  // linear constraint.
+  std::vector<triplet_t> entries;
+  entries.push_back (triplet_t (0, 0, 1.));
+  entries.push_back (triplet_t (0, 2, -2.));
+  entries.push_back (triplet_t (1, 1, 3.));
+  entries.push_back (triplet_t (1, 3, .5));
+  Linear::vector_t b (2);
+  b << 1., -4.;
+  boost::shared_ptr<Linear> first (new Linear (entries, b));
+
+  entries.clear ();
+  entries.push_back (triplet_t (0, 1, -1.));
+  entries.push_back (triplet_t (0, 2, 2.5));
+  Linear::vector_t c (1);
+  c << 2.;
+  boost::shared_ptr<Linear> second (new Linear (entries, c));
+
+  boost::shared_ptr<Product> product (new Product ());
+
+  Cost cost;
+  problem_t problem (cost);
+  problem.addConstraint
+    (boost::shared_ptr<LinearSparseFunction> (first),
+     problem_t::intervals_t (2, Function::makeUpperInterval (10.)),
+     problem_t::scales_t (2, 1.));
+  problem.addConstraint
+    (boost::shared_ptr<DifferentiableSparseFunction> (product),
+     Function::makeUpperInterval (10.));
+  problem.addConstraint
+    (boost::shared_ptr<LinearSparseFunction> (second),
+     Function::makeUpperInterval (10.));
+
+  problem_t::vector_t start (size);
+  start << 1., 2., 3., 4.;
+  problem.startingPoint () = start;
+
+  IpoptSolverSparse solver (problem);
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverSparse> > nlp =
+    new detail::Tnlp<IpoptSolverSparse> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_REQUIRE_EQUAL (m, 4);
+
+  std::vector<Ipopt::TNLP::LinearityType> linearity
+    (static_cast<std::size_t> (m));
+  BOOST_REQUIRE (nlp->get_constraints_linearity (m, &linearity[0]));
+  for (std::size_t i = 0; i < linearity.size (); ++i)
+    BOOST_CHECK_EQUAL (linearity[i], i == 2
+		       ? Ipopt::TNLP::NON_LINEAR : Ipopt::TNLP::LINEAR);
+
+  // The linear rows are computed by a single product: the linear
+  // functions are not evaluated anymore.
+  first->evaluations = second->evaluations = 0;
+  for (int iteration = 0; iteration < 3; ++iteration)
+    {
+      Function::vector_t x (n);
+      x << .5 * iteration, -1., 2. + iteration, .25;
+
+      Function::vector_t g (m);
+      BOOST_REQUIRE (nlp->eval_g (n, x.data (), true, m, g.data ()));
+
+      Function::vector_t expected (m);
+      expected << first->a_ * x + first->b_, x[0] * x[3],
+	second->a_ * x + second->b_;
+      for (Ipopt::Index i = 0; i < m; ++i)
+	BOOST_CHECK_SMALL (g[i] - expected[i], 1e-12);
+    }
+  BOOST_CHECK_EQUAL (first->evaluations, 0u);
+  BOOST_CHECK_EQUAL (second->evaluations, 0u);
+}
@@ -0,0 +1,174 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-nonlinear-variables-sparse
+
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+#include <roboptim/core/linear-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+typedef IpoptSolverSparse::problem_t problem_t;
+
+namespace
+{
+  /// (x₀ - 1)² + (x₁ - 2)²
+  struct Cost : public DifferentiableSparseFunction
+  {
+    Cost ()
+      : DifferentiableSparseFunction (4, 1, "(x₀ - 1)² + (x₁ - 2)²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = (x[0] - 1.) * (x[0] - 1.) + (x[1] - 2.) * (x[1] - 2.);
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient.insert (0) = 2. * (x[0] - 1.);
+      gradient.insert (1) = 2. * (x[1] - 2.);
+    }
+  };
+
+  /// x₀ + x₁ - x₂
+  struct Slack : public LinearSparseFunction
+  {
+    Slack ()
+      : LinearSparseFunction (4, 1, "x₀ + x₁ - x₂")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] + x[1] - x[2];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient.insert (0) = 1.;
+      gradient.insert (1) = 1.;
+      gradient.insert (2) = -1.;
+    }
+  };
+
+  /// x₁² + x₃
+  struct Shift : public DifferentiableSparseFunction
+  {
+    Shift ()
+      : DifferentiableSparseFunction (4, 1, "x₁² + x₃")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[1] * x[1] + x[3];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient.insert (1) = 2. * x[1];
+      gradient.insert (3) = 1.;
+    }
+  };
+
+  /// \brief Nonlinear variables found by the Tnlp.
+  std::vector<Ipopt::Index>
+  nonlinearVariables (bool linearVariables, bool sample)
+  {
+    Cost cost;
+    problem_t problem (cost);
+    problem.argumentBounds ()[2] = Function::makeInterval (0., 1.);
+
+    boost::shared_ptr<LinearSparseFunction> slack (new Slack ());
+    boost::shared_ptr<DifferentiableSparseFunction> shift (new Shift ());
+    problem.addConstraint (slack, Function::makeInterval (0., 0.));
+    problem.addConstraint (shift, Function::makeUpperInterval (4.));
+
+    problem_t::vector_t x (4);
+    x << .5, .5, 1., .5;
+    problem.startingPoint () = x;
+
+    IpoptSolverSparse solver (problem);
+    solver.parameters ()["ipopt.plugin.linear_variables"].value =
+      linearVariables;
+    solver.parameters ()["ipopt.plugin.sample_linear_variables"].value =
+      sample;
+    Ipopt::SmartPtr<detail::Tnlp<IpoptSolverSparse> > nlp =
+      new detail::Tnlp<IpoptSolverSparse> (problem, solver);
+
+    Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum style;
+    BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+
+    // All the variables are nonlinear, which Ipopt is told with -1.
+    Ipopt::Index count = nlp->get_number_of_nonlinear_variables ();
+    if (count < 0)
+      return std::vector<Ipopt::Index> ();
+
+    std::vector<Ipopt::Index> variables (static_cast<std::size_t> (count));
+    BOOST_REQUIRE (count == 0
+		   || nlp->get_list_of_nonlinear_variables (count,
+							    &variables[0]));
+    return variables;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (structure_variables)
+{
+  // x₂ only appears in the linear constraint.
+  std::vector<Ipopt::Index> variables = nonlinearVariables (true, false);
+  BOOST_REQUIRE_EQUAL (variables.size (), 3u);
+  BOOST_CHECK_EQUAL (variables[0], 0);
+  BOOST_CHECK_EQUAL (variables[1], 1);
+  BOOST_CHECK_EQUAL (variables[2], 3);
+}
+
+BOOST_AUTO_TEST_CASE (sampled_variables)
+{
+  // The derivatives with respect to x₃ are constant.
+  std::vector<Ipopt::Index> variables = nonlinearVariables (true, true);
+  BOOST_REQUIRE_EQUAL (variables.size (), 2u);
+  BOOST_CHECK_EQUAL (variables[0], 0);
+  BOOST_CHECK_EQUAL (variables[1], 1);
+}
+
+BOOST_AUTO_TEST_CASE (linear_variables_disabled)
+{
+  BOOST_CHECK (nonlinearVariables (false, false).empty ());
+}
@@ -0,0 +1,262 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-nonlinear-variables
+
+#include <string>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/util.hh>
+#include <roboptim/core/linear-function.hh>
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-td.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+/// min (x₀ - 1)² + (x₁ - 2)²
+/// s.t. x₀ + x₁ - x₂ = 0
+///      0 ≤ x₂ ≤ 1
+///
+/// The slack x₂ only appears in the linear constraint. The minimum is 2
+/// at (0, 1, 1).
+struct Cost : public TwiceDifferentiableFunction
+{
+  Cost ()
+    : TwiceDifferentiableFunction (3, 1, "(x₀ - 1)² + (x₁ - 2)²")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 1.) * (x[0] - 1.) + (x[1] - 2.) * (x[1] - 2.);
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref x,
+		 size_type) const
+  {
+    gradient[0] = 2. * (x[0] - 1.);
+    gradient[1] = 2. * (x[1] - 2.);
+    gradient[2] = 0.;
+  }
+
+  void
+  impl_hessian (hessian_ref hessian, const_argument_ref,
+		size_type) const
+  {
+    hessian.setZero ();
+    hessian (0, 0) = 2.;
+    hessian (1, 1) = 2.;
+  }
+};
+
+struct Slack : public LinearFunction
+{
+  Slack ()
+    : LinearFunction (3, 1, "x₀ + x₁ - x₂")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = x[0] + x[1] - x[2];
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref,
+		 size_type) const
+  {
+    gradient << 1., 1., -1.;
+  }
+};
+
+static void
+setup (IpoptSolverTd::problem_t& problem)
+{
+  problem.argumentBounds ()[2] = Function::makeInterval (0., 1.);
+
+  boost::shared_ptr<LinearFunction> slack (new Slack ());
+  problem.addConstraint (slack, Function::makeInterval (0., 0.));
+
+  IpoptSolverTd::problem_t::vector_t x (3);
+  x << .5, .5, 1.;
+  problem.startingPoint () = x;
+}
+
+BOOST_AUTO_TEST_CASE (slack_variables_are_linear)
+{
+  Cost cost;
+  IpoptSolverTd::problem_t problem (cost);
+  setup (problem);
+
+  IpoptSolverTd solver (problem);
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp =
+    new detail::Tnlp<IpoptSolverTd> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+
+  // Only x₀ and x₁ appear in the Lagrangian Hessian.
+  BOOST_REQUIRE_EQUAL (nlp->get_number_of_nonlinear_variables (), 2);
+
+  Ipopt::Index variables[2];
+  BOOST_REQUIRE (nlp->get_list_of_nonlinear_variables (2, variables));
+  BOOST_CHECK_EQUAL (variables[0], 0);
+  BOOST_CHECK_EQUAL (variables[1], 1);
+}
+
+BOOST_AUTO_TEST_CASE (solve)
+{
+  Cost cost;
+  IpoptSolverTd::problem_t problem (cost);
+  setup (problem);
+
+  IpoptSolverTd solver (problem);
+  solver.solve ();
+
+  const IpoptSolverTd::result_t& result = solver.minimum ();
+  BOOST_REQUIRE (result.which () == IpoptSolverTd::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).value[0], 2., 1e-4);
+}
+
+/// min x₀ + x₁
+/// s.t. x₀ + 2 x₁ ≥ 2
+///      0 ≤ x₀, x₁ ≤ 10
+///
+/// No variable appears nonlinearly. The minimum is 1 at (0, 1).
+struct LinearCost : public TwiceDifferentiableFunction
+{
+  LinearCost ()
+    : TwiceDifferentiableFunction (2, 1, "x₀ + x₁")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = x[0] + x[1];
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref,
+		 size_type) const
+  {
+    gradient << 1., 1.;
+  }
+
+  void
+  impl_hessian (hessian_ref hessian, const_argument_ref,
+		size_type) const
+  {
+    hessian.setZero ();
+  }
+};
+
+struct WeightedSum : public LinearFunction
+{
+  WeightedSum ()
+    : LinearFunction (2, 1, "x₀ + 2 x₁")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = x[0] + 2. * x[1];
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref,
+		 size_type) const
+  {
+    gradient << 1., 2.;
+  }
+};
+
+static void
+setupLinear (IpoptSolverTd::problem_t& problem)
+{
+  problem.argumentBounds ()[0] = Function::makeInterval (0., 10.);
+  problem.argumentBounds ()[1] = Function::makeInterval (0., 10.);
+
+  boost::shared_ptr<LinearFunction> sum (new WeightedSum ());
+  problem.addConstraint (sum, Function::makeLowerInterval (2.));
+
+  IpoptSolverTd::problem_t::vector_t x (2);
+  x << 5., 5.;
+  problem.startingPoint () = x;
+}
+
+BOOST_AUTO_TEST_CASE (no_nonlinear_variables)
+{
+  LinearCost cost;
+  IpoptSolverTd::problem_t problem (cost);
+  setupLinear (problem);
+
+  IpoptSolverTd solver (problem);
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp =
+    new detail::Tnlp<IpoptSolverTd> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+  BOOST_CHECK_EQUAL (nnz_h_lag, 0);
+  BOOST_CHECK_EQUAL (nlp->get_number_of_nonlinear_variables (), 0);
+}
+
+BOOST_AUTO_TEST_CASE (solve_without_nonlinear_variables)
+{
+  LinearCost cost;
+  IpoptSolverTd::problem_t problem (cost);
+  setupLinear (problem);
+
+  // The quasi-Newton approximation has an empty space.
+  IpoptSolverTd solver (problem);
+  solver.parameters ()["ipopt.hessian_approximation"].value =
+    std::string ("limited-memory");
+  solver.solve ();
+
+  const IpoptSolverTd::result_t& result = solver.minimum ();
+  BOOST_REQUIRE (result.which () == IpoptSolverTd::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).value[0], 1., 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE (linear_variables_disabled)
+{
+  Cost cost;
+  IpoptSolverTd::problem_t problem (cost);
+  setup (problem);
+
+  IpoptSolverTd solver (problem);
+  solver.parameters ()["ipopt.plugin.linear_variables"].value = false;
+  Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp =
+    new detail::Tnlp<IpoptSolverTd> (problem, solver);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+
+  // All the variables are nonlinear, which Ipopt is told with -1.
+  BOOST_CHECK_EQUAL (nlp->get_number_of_nonlinear_variables (), -1);
+}
@@ -0,0 +1,178 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-options
+
+#include <string>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpIpoptApplication.hpp>
+
+#include <roboptim/core/linear-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "schittkowski-71.hh"
+
+using namespace roboptim;
+
+/// min (x₀ - 1)² + (x₁ - 2)²
+/// s.t. x₀ + x₁ = 1
+///
+/// The minimum is 2 at (0, 1).
+struct Cost : public DifferentiableFunction
+{
+  Cost ()
+    : DifferentiableFunction (2, 1, "(x₀ - 1)² + (x₁ - 2)²")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 1.) * (x[0] - 1.) + (x[1] - 2.) * (x[1] - 2.);
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref x,
+		 size_type) const
+  {
+    gradient[0] = 2. * (x[0] - 1.);
+    gradient[1] = 2. * (x[1] - 2.);
+  }
+};
+
+struct Sum : public LinearFunction
+{
+  Sum ()
+    : LinearFunction (2, 1, "x₀ + x₁")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = x[0] + x[1];
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref,
+		 size_type) const
+  {
+    gradient << 1., 1.;
+  }
+};
+
+static void
+setup (IpoptSolver::problem_t& problem)
+{
+  boost::shared_ptr<LinearFunction> sum (new Sum ());
+  problem.addConstraint (sum, Function::makeInterval (1., 1.));
+
+  IpoptSolver::problem_t::vector_t x (2);
+  x << 3., 3.;
+  problem.startingPoint () = x;
+}
+
+/// \brief Record the value of an Ipopt option during a solve.
+struct OptionRecorder
+{
+  OptionRecorder (IpoptSolver& solver, const std::string& name,
+		  std::string& value)
+    : solver_ (solver),
+      name_ (name),
+      value_ (value)
+  {}
+
+  void operator () (const IpoptSolver::problem_t&,
+		    IpoptSolver::solverState_t&)
+  {
+    solver_.getIpoptApplication ()->Options ()->GetStringValue
+      (name_, value_, "");
+  }
+
+  IpoptSolver& solver_;
+  std::string name_;
+  std::string& value_;
+};
+
+static std::string
+option (IpoptSolver& solver, const std::string& name)
+{
+  std::string value;
+  solver.getIpoptApplication ()->Options ()->GetStringValue (name, value, "");
+  return value;
+}
+
+BOOST_AUTO_TEST_CASE (linearity_options)
+{
+  Cost cost;
+  IpoptSolver::problem_t problem (cost);
+  setup (problem);
+
+  IpoptSolver solver (problem);
+  std::string during;
+  solver.setIterationCallback (OptionRecorder (solver, "jac_c_constant",
+					       during));
+  solver.solve ();
+
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (solver.minimum ()).value[0],
+		     2., 1e-4);
+
+  // The linear equality is flagged for the solve only.
+  BOOST_CHECK_EQUAL (during, "yes");
+  BOOST_CHECK_EQUAL (option (solver, "jac_c_constant"), "no");
+
+  solver.resolve ();
+  BOOST_CHECK_EQUAL (during, "yes");
+  BOOST_CHECK_EQUAL (option (solver, "jac_c_constant"), "no");
+}
+
+BOOST_AUTO_TEST_CASE (explicit_linearity_options)
+{
+  Cost cost;
+  IpoptSolver::problem_t problem (cost);
+  setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.parameters ()["ipopt.jac_c_constant"].value = std::string ("no");
+  std::string during;
+  solver.setIterationCallback (OptionRecorder (solver, "jac_c_constant",
+					       during));
+  solver.solve ();
+
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_EQUAL (during, "no");
+}
+
+BOOST_AUTO_TEST_CASE (nonlinear_constraints)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  std::string during;
+  solver.setIterationCallback (OptionRecorder (solver, "jac_c_constant",
+					       during));
+  solver.solve ();
+
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_EQUAL (during, "no");
+}
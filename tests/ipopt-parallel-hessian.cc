@@ -0,0 +1,266 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-parallel-hessian
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-td.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// Number of variables.
+  const int size = 4;
+
+  /// Number of scalar constraints.
+  const int products = 5;
+
+  /// Σ xᵢ³
+  struct Cost : public TwiceDifferentiableFunction
+  {
+    Cost ()
+      : TwiceDifferentiableFunction (size, 1, "Σ xᵢ³")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x.array ().cube ().sum ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient = 3. * x.array ().square ().matrix ();
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian.setZero ();
+      hessian.diagonal () = 6. * x;
+    }
+  };
+
+  /// c xᵢ xⱼ²
+  struct Product : public TwiceDifferentiableFunction
+  {
+    Product (int i, int j, double c)
+      : TwiceDifferentiableFunction (size, 1, "c xᵢ xⱼ²"),
+	i_ (i),
+	j_ (j),
+	c_ (c)
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = c_ * x[i_] * x[j_] * x[j_];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      gradient[i_] = c_ * x[j_] * x[j_];
+      gradient[j_] = 2. * c_ * x[i_] * x[j_];
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type) const
+    {
+      hessian.setZero ();
+      hessian (i_, j_) = hessian (j_, i_) = 2. * c_ * x[j_];
+      hessian (j_, j_) = 2. * c_ * x[i_];
+    }
+
+    int i_;
+    int j_;
+    double c_;
+  };
+
+  /// (x₀ x₃, x₁² x₂)
+  struct Pair : public TwiceDifferentiableFunction
+  {
+    Pair ()
+      : TwiceDifferentiableFunction (size, 2, "(x₀ x₃, x₁² x₂)")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result << x[0] * x[3], x[1] * x[1] * x[2];
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type i) const
+    {
+      if (i == 0)
+	gradient << x[3], 0., 0., x[0];
+      else
+	gradient << 0., 2. * x[1] * x[2], x[1] * x[1], 0.;
+    }
+
+    void
+    impl_hessian (hessian_ref hessian, const_argument_ref x,
+		  size_type i) const
+    {
+      hessian.setZero ();
+      if (i == 0)
+	hessian (0, 3) = hessian (3, 0) = 1.;
+      else
+	{
+	  hessian (1, 1) = 2. * x[2];
+	  hessian (1, 2) = hessian (2, 1) = 2. * x[1];
+	}
+    }
+  };
+
+  /// \brief Problem with several constraints, to be spread over the
+  /// workers.
+  struct Problem
+  {
+    Problem ()
+      : cost (),
+	problem (cost),
+	constraints ()
+    {
+      for (int k = 0; k < products; ++k)
+	{
+	  boost::shared_ptr<TwiceDifferentiableFunction> product
+	    (new Product (k % size, (k + 1) % size, 1. + k));
+	  constraints.push_back (product);
+	  problem.addConstraint (product, Function::makeUpperInterval (10.));
+	}
+
+      boost::shared_ptr<TwiceDifferentiableFunction> pair (new Pair ());
+      constraints.push_back (pair);
+      problem.addConstraint
+	(pair,
+	 IpoptSolverTd::problem_t::intervals_t
+	 (2, Function::makeUpperInterval (10.)),
+	 IpoptSolverTd::problem_t::scales_t (2, 1.));
+
+      IpoptSolverTd::problem_t::vector_t x (size);
+      x << 1., 1.5, .5, 2.;
+      problem.startingPoint () = x;
+    }
+
+    /// \brief Lagrangian Hessian, computed serially.
+    Function::matrix_t
+    lagrangian (const Function::vector_t& x, double objFactor,
+		const Function::vector_t& lambda) const
+    {
+      Function::matrix_t result = objFactor * cost.hessian (x, 0);
+      Function::size_type offset = 0;
+      for (std::size_t k = 0; k < constraints.size (); ++k)
+	for (Function::size_type r = 0; r < constraints[k]->outputSize (); ++r)
+	  result += lambda[offset++] * constraints[k]->hessian (x, r);
+      return result;
+    }
+
+    Cost cost;
+    IpoptSolverTd::problem_t problem;
+    std::vector<boost::shared_ptr<TwiceDifferentiableFunction> > constraints;
+  };
+
+  /// \brief Check the Lagrangian Hessian computed with a given number
+  /// of evaluation threads.
+  void
+  checkHessian (int threads, bool cacheHessians)
+  {
+    Problem problem;
+    IpoptSolverTd solver (problem.problem);
+    solver.parameters ()["ipopt.plugin.eval_threads"].value = threads;
+    solver.parameters ()["ipopt.plugin.cache_hessians"].value =
+      cacheHessians;
+    Ipopt::SmartPtr<detail::Tnlp<IpoptSolverTd> > nlp =
+      new detail::Tnlp<IpoptSolverTd> (problem.problem, solver);
+
+    Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum style;
+    BOOST_REQUIRE (nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag, style));
+    BOOST_REQUIRE_EQUAL (m, products + 2);
+
+    std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_h_lag));
+    std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_h_lag));
+    BOOST_REQUIRE (nlp->eval_h (n, 0, true, 0., m, 0, true, nnz_h_lag,
+				&rows[0], &cols[0], 0));
+
+    Function::vector_t x (n);
+    Function::vector_t lambda (m);
+    std::vector<Ipopt::Number> values (rows.size ());
+    x << 1.2, .8, -.3, 1.7;
+    for (Ipopt::Index i = 0; i < m; ++i)
+      lambda[i] = .5 - .25 * i;
+
+    // New points, then new multipliers at the same point: accumulators
+    // are reset and reduced on each evaluation.
+    for (int iteration = 0; iteration < 4; ++iteration)
+      {
+	if (iteration % 2 == 0)
+	  x[iteration % n] += .1;
+	lambda *= -1.5;
+	double objFactor = 1. + iteration;
+
+	BOOST_REQUIRE (nlp->eval_h (n, x.data (), iteration % 2 == 0,
+				    objFactor, m, lambda.data (), true,
+				    nnz_h_lag, 0, 0, &values[0]));
+
+	Function::matrix_t expected =
+	  problem.lagrangian (x, objFactor, lambda);
+	for (std::size_t k = 0; k < values.size (); ++k)
+	  BOOST_CHECK_SMALL (values[k] - expected (rows[k], cols[k]), 1e-10);
+      }
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (serial_hessian)
+{
+  checkHessian (1, true);
+}
+
+BOOST_AUTO_TEST_CASE (parallel_hessian)
+{
+  // Fewer, as many and more workers than constraints.
+  checkHessian (2, true);
+  checkHessian (products + 1, true);
+  checkHessian (products + 3, true);
+}
+
+BOOST_AUTO_TEST_CASE (parallel_hessian_without_cache)
+{
+  checkHessian (2, false);
+  checkHessian (3, false);
+}
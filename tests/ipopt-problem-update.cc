@@ -0,0 +1,329 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-problem-update
+
+#include <stdexcept>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/variant/get.hpp>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "schittkowski-71.hh"
+
+using namespace roboptim;
+
+typedef IpoptSolver::problem_t problem_t;
+typedef problem_t::intervals_t intervals_t;
+
+/// \brief Bounds of Schittkowski's problem 71.
+struct Bounds
+{
+  Bounds ()
+    : arguments (4, Function::makeInterval (1., 5.)),
+      g0 (1, Function::makeLowerInterval (25.)),
+      g1 (1, Function::makeInterval (40., 40.))
+  {}
+
+  intervals_t arguments;
+  intervals_t g0;
+  intervals_t g1;
+};
+
+/// \brief Solve problem 71 with other bounds, with a new solver.
+static Result
+solveFresh (const Bounds& bounds)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  for (std::size_t i = 0; i < 4; ++i)
+    problem.argumentBounds ()[i] = bounds.arguments[i];
+
+  boost::shared_ptr<DifferentiableFunction> g0 (new schittkowski71::G0 ());
+  boost::shared_ptr<DifferentiableFunction> g1 (new schittkowski71::G1 ());
+  problem.addConstraint (g0, bounds.g0[0]);
+  problem.addConstraint (g1, bounds.g1[0]);
+
+  problem_t::vector_t x (4);
+  x << 1., 5., 5., 1.;
+  problem.startingPoint () = x;
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  return boost::get<Result> (solver.minimum ());
+}
+
+/// \brief Check the result of an updated solver against a new one.
+static void
+checkResult (const IpoptSolver& solver, const Bounds& bounds)
+{
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  const Result& result = boost::get<Result> (solver.minimum ());
+  Result expected = solveFresh (bounds);
+
+  BOOST_CHECK_CLOSE (result.value[0], expected.value[0], 1e-4);
+  BOOST_CHECK_SMALL ((result.x - expected.x).lpNorm<Eigen::Infinity> (),
+		     1e-4);
+}
+
+/// \brief Check that a solver found the minimum of problem 71.
+static void
+checkMinimum (const IpoptSolver& solver)
+{
+  BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (solver.minimum ()).value[0],
+		     schittkowski71::minimum, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE (resolve_bounds_update)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+  checkMinimum (solver);
+
+  Bounds bounds;
+
+  // Same kind of bounds: the previous application is re-optimized.
+  bounds.g1[0] = Function::makeInterval (38., 38.);
+  solver.setConstraintBounds (1, bounds.g1);
+  solver.resolve ();
+  checkResult (solver, bounds);
+
+  // The equality becomes an inequality.
+  bounds.g1[0] = Function::makeInterval (30., 38.);
+  solver.setConstraintBounds (1, bounds.g1);
+  solver.resolve ();
+  checkResult (solver, bounds);
+
+  // A variable is fixed.
+  bounds.arguments[3] = Function::makeInterval (2., 2.);
+  solver.setArgumentBounds (bounds.arguments);
+  solver.resolve ();
+  checkResult (solver, bounds);
+
+  // An infinite side becomes finite.
+  bounds.g0[0] = Function::makeInterval (25., 1000.);
+  solver.setConstraintBounds (0, bounds.g0);
+  solver.resolve ();
+  checkResult (solver, bounds);
+
+  // Back to the same kind of bounds.
+  bounds.g0[0] = Function::makeInterval (26., 1000.);
+  solver.setConstraintBounds (0, bounds.g0);
+  solver.resolve ();
+  checkResult (solver, bounds);
+}
+
+BOOST_AUTO_TEST_CASE (solve_bounds_update)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+  checkMinimum (solver);
+
+  Bounds bounds;
+  bounds.g1[0] = Function::makeInterval (30., 38.);
+  bounds.arguments[3] = Function::makeInterval (2., 2.);
+  solver.setConstraintBounds (1, bounds.g1);
+  solver.setArgumentBounds (bounds.arguments);
+
+  BOOST_CHECK (solver.boundsVector ()[1] == bounds.g1);
+  BOOST_CHECK (solver.argumentBounds () == bounds.arguments);
+
+  // The problem itself is left untouched.
+  BOOST_CHECK (problem.boundsVector ()[1] != bounds.g1);
+
+  solver.solve ();
+  checkResult (solver, bounds);
+}
+
+BOOST_AUTO_TEST_CASE (scaling_and_starting_point_update)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+  checkMinimum (solver);
+
+  // Neither the scaling nor the starting point change the minimum.
+  problem_t::scales_t scaling (4, 2.);
+  solver.setArgumentScaling (scaling);
+  BOOST_CHECK (solver.argumentScaling () == scaling);
+  solver.resolve ();
+  checkMinimum (solver);
+
+  problem_t::scales_t constraintScaling (1, 10.);
+  solver.setConstraintScaling (0, constraintScaling);
+  BOOST_CHECK (solver.scalingVector ()[0] == constraintScaling);
+  solver.resolve ();
+  checkMinimum (solver);
+
+  problem_t::vector_t x (4);
+  x << 2., 4., 4., 2.;
+  solver.setStartingPoint (x);
+  BOOST_REQUIRE (solver.startingPoint ());
+  BOOST_CHECK_EQUAL (*solver.startingPoint (), x);
+  solver.resolve ();
+  checkMinimum (solver);
+
+  solver.solve ();
+  checkMinimum (solver);
+}
+
+BOOST_AUTO_TEST_CASE (reset_problem_updates)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+  checkMinimum (solver);
+
+  Bounds bounds;
+  bounds.g1[0] = Function::makeInterval (30., 38.);
+  solver.setConstraintBounds (1, bounds.g1);
+  solver.resolve ();
+  checkResult (solver, bounds);
+
+  solver.setArgumentScaling (problem_t::scales_t (4, 2.));
+  problem_t::vector_t x (4);
+  x << 2., 4., 4., 2.;
+  solver.setStartingPoint (x);
+
+  // Going back to the problem data changes the kind of a bound again.
+  solver.resetProblemUpdates ();
+  BOOST_CHECK (solver.boundsVector () == problem.boundsVector ());
+  BOOST_CHECK (solver.argumentScaling () == problem.argumentScaling ());
+  BOOST_REQUIRE (solver.startingPoint ());
+  BOOST_CHECK_EQUAL (*solver.startingPoint (), *problem.startingPoint ());
+  solver.resolve ();
+  checkMinimum (solver);
+}
+
+namespace
+{
+  /// \brief Constraint 0 of problem 71 recording whether it was
+  /// evaluated outside of the main thread.
+  struct ThreadG0 : public schittkowski71::G0
+  {
+    ThreadG0 ()
+      : mainThread (boost::this_thread::get_id ()),
+	otherThread (false)
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      schittkowski71::G0::impl_compute (result, x);
+
+      boost::mutex::scoped_lock lock (mutex);
+      if (boost::this_thread::get_id () != mainThread)
+	otherThread = true;
+    }
+
+    boost::thread::id mainThread;
+    mutable boost::mutex mutex;
+    mutable bool otherThread;
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (resolve_eval_threads_update)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  for (std::size_t i = 0; i < 4; ++i)
+    problem.argumentBounds ()[i] = Function::makeInterval (1., 5.);
+
+  boost::shared_ptr<ThreadG0> g0 (new ThreadG0 ());
+  boost::shared_ptr<DifferentiableFunction> g1 (new schittkowski71::G1 ());
+  problem.addConstraint
+    (boost::static_pointer_cast<DifferentiableFunction> (g0),
+     Function::makeLowerInterval (25.));
+  problem.addConstraint (g1, Function::makeInterval (40., 40.));
+
+  problem_t::vector_t x (4);
+  x << 1., 5., 5., 1.;
+  problem.startingPoint () = x;
+
+  IpoptSolver solver (problem);
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = 2;
+  solver.solve ();
+  checkMinimum (solver);
+
+  // The evaluation threads are set up by the problem analysis, which
+  // re-optimizations skip: the solver has to start over.
+  solver.parameters ()["ipopt.plugin.eval_threads"].value = 1;
+  g0->otherThread = false;
+  solver.resolve ();
+  checkMinimum (solver);
+  BOOST_CHECK (!g0->otherThread);
+
+  // Unchanged parameters keep the re-optimization.
+  solver.resolve ();
+  checkMinimum (solver);
+  BOOST_CHECK (!g0->otherThread);
+}
+
+BOOST_AUTO_TEST_CASE (invalid_updates)
+{
+  schittkowski71::F f;
+  problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+
+  const intervals_t arguments (3, Function::makeInterval (1., 5.));
+  const intervals_t constraint (2, Function::makeInterval (0., 1.));
+
+  BOOST_CHECK_THROW (solver.setArgumentBounds (arguments),
+		     std::runtime_error);
+  BOOST_CHECK_THROW
+    (solver.setConstraintBounds (2, problem.boundsVector ()[0]),
+     std::runtime_error);
+  BOOST_CHECK_THROW (solver.setConstraintBounds (0, constraint),
+		     std::runtime_error);
+  BOOST_CHECK_THROW (solver.setArgumentScaling (problem_t::scales_t (5, 1.)),
+		     std::runtime_error);
+  BOOST_CHECK_THROW
+    (solver.setConstraintScaling (2, problem_t::scales_t (1, 1.)),
+     std::runtime_error);
+  BOOST_CHECK_THROW
+    (solver.setStartingPoint (problem_t::vector_t::Zero (3)),
+     std::runtime_error);
+
+  // Failed updates leave the solver data untouched.
+  BOOST_CHECK (solver.argumentBounds () == problem.argumentBounds ());
+  BOOST_CHECK (solver.boundsVector () == problem.boundsVector ());
+
+  solver.solve ();
+  checkMinimum (solver);
+}
@@ -0,0 +1,304 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-sparse-jacobian
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <coin/IpTNLP.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-sparse.hh>
+
+#include "tnlp.hh"
+
+using namespace roboptim;
+
+typedef Eigen::Triplet<double> triplet_t;
+
+namespace
+{
+  const int size = 6;
+
+  /// Σ xᵢ²
+  struct Cost : public DifferentiableSparseFunction
+  {
+    Cost ()
+      : DifferentiableSparseFunction (size, 1, "Σ xᵢ²")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x.squaredNorm ();
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      gradient.setZero ();
+      for (size_type i = 0; i < size; ++i)
+	gradient.insert (i) = 2. * x[i];
+    }
+  };
+
+  /// gᵢ = xᵢ xᵢ₊₁ + sin (xᵢ₊₃), for i in [0, 3)
+  ///
+  /// Jacobian evaluations are counted.
+  struct Chain : public DifferentiableSparseFunction
+  {
+    Chain ()
+      : DifferentiableSparseFunction (size, 3, "xᵢ xᵢ₊₁ + sin (xᵢ₊₃)"),
+	jacobians (0)
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      for (size_type i = 0; i < 3; ++i)
+	result[i] = x[i] * x[i + 1] + std::sin (x[i + 3]);
+    }
+
+    /// \brief Nonzeros of row i (in row 0).
+    void
+    entries (std::vector<triplet_t>& entries, const_argument_ref x,
+	     size_type i) const
+    {
+      int j = static_cast<int> (i);
+      entries.push_back (triplet_t (0, j, x[i + 1]));
+      entries.push_back (triplet_t (0, j + 1, x[i]));
+      entries.push_back (triplet_t (0, j + 3, std::cos (x[i + 3])));
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type i) const
+    {
+      std::vector<triplet_t> row;
+      entries (row, x, i);
+      gradient.setZero ();
+      for (std::size_t k = 0; k < row.size (); ++k)
+	gradient.insert (row[k].col ()) = row[k].value ();
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      ++jacobians;
+      std::vector<triplet_t> all;
+      for (size_type i = 0; i < 3; ++i)
+	{
+	  std::vector<triplet_t> row;
+	  entries (row, x, i);
+	  for (std::size_t k = 0; k < row.size (); ++k)
+	    all.push_back (triplet_t (static_cast<int> (i), row[k].col (),
+				      row[k].value ()));
+	}
+      jacobian.setFromTriplets (all.begin (), all.end ());
+    }
+
+    mutable std::size_t jacobians;
+  };
+
+  /// x₀ (x₁ - 1)² + x₂
+  ///
+  /// The Jacobian only stores its nonzeros: its layout changes for
+  /// x₁ = 1.
+  struct Gap : public DifferentiableSparseFunction
+  {
+    Gap ()
+      : DifferentiableSparseFunction (size, 1, "x₀ (x₁ - 1)² + x₂")
+    {}
+
+    void
+    impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = x[0] * (x[1] - 1.) * (x[1] - 1.) + x[2];
+    }
+
+    void
+    entries (std::vector<triplet_t>& entries, const_argument_ref x) const
+    {
+      if (x[1] != 1.)
+	{
+	  entries.push_back (triplet_t (0, 0, (x[1] - 1.) * (x[1] - 1.)));
+	  entries.push_back (triplet_t (0, 1, 2. * x[0] * (x[1] - 1.)));
+	}
+      entries.push_back (triplet_t (0, 2, 1.));
+    }
+
+    void
+    impl_gradient (gradient_ref gradient, const_argument_ref x,
+		   size_type) const
+    {
+      std::vector<triplet_t> row;
+      entries (row, x);
+      gradient.setZero ();
+      for (std::size_t k = 0; k < row.size (); ++k)
+	gradient.insert (row[k].col ()) = row[k].value ();
+    }
+
+    void
+    impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+    {
+      std::vector<triplet_t> row;
+      entries (row, x);
+      jacobian.setFromTriplets (row.begin (), row.end ());
+    }
+  };
+
+  IpoptSolverSparse::problem_t::vector_t
+  point (double offset)
+  {
+    IpoptSolverSparse::problem_t::vector_t x (size);
+    for (int i = 0; i < size; ++i)
+      x[i] = offset + .3 * i;
+    return x;
+  }
+
+  /// \brief Solver and TNLP of a problem with two chains, and
+  /// optionally a gap in between.
+  struct Jacobian
+  {
+    explicit Jacobian (bool withGap = false)
+      : cost (),
+	first (new Chain ()),
+	gap (new Gap ()),
+	second (new Chain ()),
+	problem (cost)
+    {
+      typedef IpoptSolverSparse::problem_t problem_t;
+      problem.addConstraint
+	(boost::shared_ptr<DifferentiableSparseFunction> (first),
+	 problem_t::intervals_t (3, Function::makeUpperInterval (10.)),
+	 problem_t::scales_t (3, 1.));
+      if (withGap)
+	problem.addConstraint
+	  (boost::shared_ptr<DifferentiableSparseFunction> (gap),
+	   Function::makeUpperInterval (10.));
+      problem.addConstraint
+	(boost::shared_ptr<DifferentiableSparseFunction> (second),
+	 problem_t::intervals_t (3, Function::makeUpperInterval (10.)),
+	 problem_t::scales_t (3, 1.));
+      problem.startingPoint () = point (1.);
+
+      solver.reset (new IpoptSolverSparse (problem));
+      solver->parameters ()["ipopt.plugin.structure_samples"].value = 2;
+      solver->parameters ()["ipopt.plugin.linear_variables"].value = false;
+      nlp = new detail::Tnlp<IpoptSolverSparse> (problem, *solver);
+    }
+
+    Cost cost;
+    boost::shared_ptr<Chain> first;
+    boost::shared_ptr<Gap> gap;
+    boost::shared_ptr<Chain> second;
+    IpoptSolverSparse::problem_t problem;
+    boost::shared_ptr<IpoptSolverSparse> solver;
+    Ipopt::SmartPtr<detail::Tnlp<IpoptSolverSparse> > nlp;
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (single_structure_pass)
+{
+  Jacobian jacobian;
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (jacobian.nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag,
+					     style));
+  BOOST_REQUIRE_EQUAL (m, 6);
+  BOOST_REQUIRE_EQUAL (nnz_jac_g, 2 * 9);
+
+  // One Jacobian evaluation per sample point, for each constraint.
+  BOOST_CHECK_EQUAL (jacobian.first->jacobians, 2u);
+  BOOST_CHECK_EQUAL (jacobian.second->jacobians, 2u);
+
+  // The structure request reuses the structure pass.
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (jacobian.nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+					   &rows[0], &cols[0], 0));
+  BOOST_CHECK_EQUAL (jacobian.first->jacobians, 2u);
+  BOOST_CHECK_EQUAL (jacobian.second->jacobians, 2u);
+
+  // Each nonzero of the problem is listed once, at the row offset of
+  // its constraint.
+  Chain::jacobian_t pattern = jacobian.first->jacobian (point (1.));
+  std::vector<bool> listed (static_cast<std::size_t> (m * n), false);
+  for (std::size_t k = 0; k < rows.size (); ++k)
+    {
+      Ipopt::Index row = rows[k] % 3;
+      BOOST_CHECK (pattern.coeff (row, cols[k]) != 0.);
+
+      std::size_t entry = static_cast<std::size_t> (rows[k] * n + cols[k]);
+      BOOST_CHECK (!listed[entry]);
+      listed[entry] = true;
+    }
+
+  // Values only require one evaluation per constraint.
+  jacobian.first->jacobians = jacobian.second->jacobians = 0;
+  IpoptSolverSparse::problem_t::vector_t x = point (.5);
+  std::vector<Ipopt::Number> values (rows.size ());
+  BOOST_REQUIRE (jacobian.nlp->eval_jac_g (n, x.data (), true, m, nnz_jac_g,
+					   0, 0, &values[0]));
+  BOOST_CHECK_EQUAL (jacobian.first->jacobians, 1u);
+  BOOST_CHECK_EQUAL (jacobian.second->jacobians, 1u);
+}
+
+BOOST_AUTO_TEST_CASE (jacobian_scatter)
+{
+  Jacobian jacobian (true);
+
+  Ipopt::Index n, m, nnz_jac_g, nnz_h_lag;
+  Ipopt::TNLP::IndexStyleEnum style;
+  BOOST_REQUIRE (jacobian.nlp->get_nlp_info (n, m, nnz_jac_g, nnz_h_lag,
+					     style));
+  BOOST_REQUIRE_EQUAL (m, 7);
+  BOOST_REQUIRE_EQUAL (nnz_jac_g, 2 * 9 + 3);
+
+  std::vector<Ipopt::Index> rows (static_cast<std::size_t> (nnz_jac_g));
+  std::vector<Ipopt::Index> cols (static_cast<std::size_t> (nnz_jac_g));
+  BOOST_REQUIRE (jacobian.nlp->eval_jac_g (n, 0, true, m, nnz_jac_g,
+					   &rows[0], &cols[0], 0));
+
+  // The chains keep their layout: their values are copied. The gap
+  // drops two nonzeros at x₁ = 1, which are then set to 0 in Ipopt's
+  // values, before coming back.
+  const double x1[] = {1.7, 1., 1.4};
+  for (int i = 0; i < 3; ++i)
+    {
+      IpoptSolverSparse::problem_t::vector_t x = point (.5 + .1 * i);
+      x[1] = x1[i];
+
+      std::vector<Ipopt::Number> values (rows.size (), -1.);
+      BOOST_REQUIRE (jacobian.nlp->eval_jac_g (n, x.data (), true, m,
+					       nnz_jac_g, 0, 0, &values[0]));
+
+      Function::matrix_t expected (m, n);
+      expected.topRows (3) = jacobian.first->jacobian (x).toDense ();
+      expected.row (3) = jacobian.gap->jacobian (x).toDense ();
+      expected.bottomRows (3) = jacobian.second->jacobian (x).toDense ();
+      for (std::size_t k = 0; k < values.size (); ++k)
+	BOOST_CHECK_EQUAL (values[k], expected (rows[k], cols[k]));
+    }
+}
@@ -0,0 +1,233 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-structure-cache
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include "structure-cache.hh"
+
+using roboptim::detail::StructureCache;
+
+namespace
+{
+  typedef StructureCache::index_t index_t;
+
+  const StructureCache::fingerprint_t fingerprint = 0x1234abcdu;
+
+  /// \brief Two Jacobian layouts and a small Hessian structure.
+  struct Structure
+  {
+    Structure ()
+    {
+      // 2 x 3 column-major layout with nonzeros (0,0), (1,1), (0,2).
+      const index_t outer0[] = {0, 1, 2, 3};
+      const index_t inner0[] = {0, 1, 0};
+      // 1 x 3 layout with nonzeros (0,1), (0,2).
+      const index_t outer1[] = {0, 0, 1, 2};
+      const index_t inner1[] = {0, 0};
+
+      outer[0].assign (outer0, outer0 + 4);
+      inner[0].assign (inner0, inner0 + 3);
+      outer[1].assign (outer1, outer1 + 4);
+      inner[1].assign (inner1, inner1 + 2);
+
+      for (std::size_t i = 0; i < 2; ++i)
+	{
+	  StructureCache::Layout layout;
+	  layout.rows = i == 0 ? 2 : 1;
+	  layout.cols = 3;
+	  layout.outerSize = 3;
+	  layout.nonZeros = static_cast<index_t> (inner[i].size ());
+	  layout.outer = &outer[i][0];
+	  layout.inner = &inner[i][0];
+	  layouts.push_back (layout);
+	}
+
+      const index_t rows[] = {0, 1, 2, 2};
+      const index_t cols[] = {0, 1, 0, 2};
+      hessianRows.assign (rows, rows + 4);
+      hessianCols.assign (cols, cols + 4);
+    }
+
+    std::vector<index_t> outer[2];
+    std::vector<index_t> inner[2];
+    std::vector<StructureCache::Layout> layouts;
+    std::vector<index_t> hessianRows;
+    std::vector<index_t> hessianCols;
+  };
+
+  /// \brief Cache file of the test, removed at the end of each case.
+  struct CacheFile
+  {
+    CacheFile ()
+      : path (StructureCache::path (".", fingerprint))
+    {
+      std::remove (path.c_str ());
+    }
+
+    ~CacheFile ()
+    {
+      std::remove (path.c_str ());
+    }
+
+    std::string path;
+  };
+
+  std::size_t fileSize (const std::string& path)
+  {
+    std::ifstream file (path.c_str (), std::ios::binary | std::ios::ate);
+    return static_cast<std::size_t> (file.tellg ());
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (round_trip)
+{
+  Structure structure;
+  CacheFile file;
+
+  BOOST_REQUIRE (StructureCache::save (file.path, fingerprint,
+				       structure.layouts,
+				       structure.hessianRows,
+				       structure.hessianCols));
+
+  StructureCache cache;
+  BOOST_REQUIRE (cache.load (file.path, fingerprint));
+  BOOST_CHECK (cache.isLoaded ());
+  BOOST_REQUIRE_EQUAL (cache.numberOfLayouts (), 2u);
+
+  for (std::size_t i = 0; i < 2; ++i)
+    {
+      const StructureCache::Layout& expected = structure.layouts[i];
+      const StructureCache::Layout& layout = cache.layout (i);
+      BOOST_CHECK_EQUAL (layout.rows, expected.rows);
+      BOOST_CHECK_EQUAL (layout.cols, expected.cols);
+      BOOST_CHECK_EQUAL (layout.outerSize, expected.outerSize);
+      BOOST_REQUIRE_EQUAL (layout.nonZeros, expected.nonZeros);
+      BOOST_CHECK_EQUAL_COLLECTIONS
+	(layout.outer, layout.outer + layout.outerSize + 1,
+	 structure.outer[i].begin (), structure.outer[i].end ());
+      BOOST_CHECK_EQUAL_COLLECTIONS
+	(layout.inner, layout.inner + layout.nonZeros,
+	 structure.inner[i].begin (), structure.inner[i].end ());
+    }
+
+  BOOST_REQUIRE_EQUAL (cache.hessianNonZeros (), 4u);
+  BOOST_CHECK_EQUAL_COLLECTIONS
+    (cache.hessianRows (), cache.hessianRows () + 4,
+     structure.hessianRows.begin (), structure.hessianRows.end ());
+  BOOST_CHECK_EQUAL_COLLECTIONS
+    (cache.hessianCols (), cache.hessianCols () + 4,
+     structure.hessianCols.begin (), structure.hessianCols.end ());
+
+  cache.close ();
+  BOOST_CHECK (!cache.isLoaded ());
+  BOOST_CHECK_EQUAL (cache.numberOfLayouts (), 0u);
+}
+
+BOOST_AUTO_TEST_CASE (overwrite)
+{
+  Structure structure;
+  CacheFile file;
+
+  std::vector<StructureCache::Layout> first (1, structure.layouts[0]);
+  BOOST_REQUIRE (StructureCache::save (file.path, fingerprint, first,
+				       std::vector<index_t> (),
+				       std::vector<index_t> ()));
+  BOOST_REQUIRE (StructureCache::save (file.path, fingerprint,
+				       structure.layouts,
+				       structure.hessianRows,
+				       structure.hessianCols));
+
+  StructureCache cache;
+  BOOST_REQUIRE (cache.load (file.path, fingerprint));
+  BOOST_CHECK_EQUAL (cache.numberOfLayouts (), 2u);
+  BOOST_CHECK_EQUAL (cache.hessianNonZeros (), 4u);
+}
+
+BOOST_AUTO_TEST_CASE (missing_file)
+{
+  CacheFile file;
+
+  StructureCache cache;
+  BOOST_CHECK (!cache.load (file.path, fingerprint));
+  BOOST_CHECK (!cache.isLoaded ());
+}
+
+BOOST_AUTO_TEST_CASE (fingerprint_mismatch)
+{
+  Structure structure;
+  CacheFile file;
+
+  BOOST_REQUIRE (StructureCache::save (file.path, fingerprint,
+				       structure.layouts,
+				       structure.hessianRows,
+				       structure.hessianCols));
+
+  StructureCache cache;
+  BOOST_CHECK (!cache.load (file.path, fingerprint + 1));
+  BOOST_CHECK (!cache.isLoaded ());
+  BOOST_CHECK_EQUAL (cache.numberOfLayouts (), 0u);
+}
+
+BOOST_AUTO_TEST_CASE (corrupted_file)
+{
+  Structure structure;
+  CacheFile file;
+
+  BOOST_REQUIRE (StructureCache::save (file.path, fingerprint,
+				       structure.layouts,
+				       structure.hessianRows,
+				       structure.hessianCols));
+
+  std::vector<char> contents (fileSize (file.path));
+  {
+    std::ifstream in (file.path.c_str (), std::ios::binary);
+    in.read (&contents[0], static_cast<std::streamsize> (contents.size ()));
+  }
+
+  StructureCache cache;
+
+  // Truncated files, including files shorter than the header.
+  std::size_t lengths[] = {0, 4, contents.size () / 2, contents.size () - 1};
+  for (std::size_t i = 0; i < sizeof (lengths) / sizeof (lengths[0]); ++i)
+    {
+      {
+	std::ofstream out (file.path.c_str (),
+			   std::ios::binary | std::ios::trunc);
+	out.write (&contents[0], static_cast<std::streamsize> (lengths[i]));
+      }
+      BOOST_CHECK (!cache.load (file.path, fingerprint));
+      BOOST_CHECK (!cache.isLoaded ());
+    }
+
+  // Bad magic number.
+  {
+    std::vector<char> corrupted (contents);
+    corrupted[0] = 'X';
+    std::ofstream out (file.path.c_str (), std::ios::binary | std::ios::trunc);
+    out.write (&corrupted[0],
+	       static_cast<std::streamsize> (corrupted.size ()));
+  }
+  BOOST_CHECK (!cache.load (file.path, fingerprint));
+  BOOST_CHECK (!cache.isLoaded ());
+}
@@ -0,0 +1,200 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-structure-extension
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/variant/get.hpp>
+
+#include <roboptim/core/twice-differentiable-function.hh>
+
+#include <roboptim/core/plugin/ipopt/ipopt-sparse-td.hh>
+
+using namespace roboptim;
+
+typedef Eigen::Triplet<double> triplet_t;
+
+/// (x₀ - 2)² + (x₁ - 1)²
+struct Cost : public TwiceDifferentiableSparseFunction
+{
+  Cost ()
+    : TwiceDifferentiableSparseFunction (2, 1, "(x₀ - 2)² + (x₁ - 1)²")
+  {}
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 2.) * (x[0] - 2.) + (x[1] - 1.) * (x[1] - 1.);
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref x,
+		 size_type) const
+  {
+    gradient.setZero ();
+    gradient.insert (0) = 2. * (x[0] - 2.);
+    gradient.insert (1) = 2. * (x[1] - 1.);
+  }
+
+  void
+  impl_hessian (hessian_ref hessian, const_argument_ref,
+		size_type) const
+  {
+    const triplet_t entries[] = {triplet_t (0, 0, 2.), triplet_t (1, 1, 2.)};
+    hessian.setFromTriplets (entries, entries + 2);
+  }
+};
+
+/// x₀ + p³ x₁ with p = max (x₀ - 1, 0)
+///
+/// Only the nonzeros are stored: the derivatives with respect to x₁
+/// only appear for x₀ > 1.
+struct Kink : public TwiceDifferentiableSparseFunction
+{
+  Kink ()
+    : TwiceDifferentiableSparseFunction (2, 1, "x₀ + max (x₀ - 1, 0)³ x₁")
+  {}
+
+  static double
+  p (const_argument_ref x)
+  {
+    return std::max (x[0] - 1., 0.);
+  }
+
+  void
+  impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = x[0] + p (x) * p (x) * p (x) * x[1];
+  }
+
+  void
+  impl_gradient (gradient_ref gradient, const_argument_ref x,
+		 size_type) const
+  {
+    gradient.setZero ();
+    gradient.insert (0) = 1. + 3. * p (x) * p (x) * x[1];
+    if (p (x) > 0.)
+      gradient.insert (1) = p (x) * p (x) * p (x);
+  }
+
+  void
+  impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+  {
+    std::vector<triplet_t> entries;
+    entries.push_back (triplet_t (0, 0, 1. + 3. * p (x) * p (x) * x[1]));
+    if (p (x) > 0.)
+      entries.push_back (triplet_t (0, 1, p (x) * p (x) * p (x)));
+    jacobian.setFromTriplets (entries.begin (), entries.end ());
+  }
+
+  void
+  impl_hessian (hessian_ref hessian, const_argument_ref x,
+		size_type) const
+  {
+    std::vector<triplet_t> entries;
+    if (p (x) > 0.)
+      {
+	entries.push_back (triplet_t (0, 0, 6. * p (x) * x[1]));
+	entries.push_back (triplet_t (1, 0, 3. * p (x) * p (x)));
+	entries.push_back (triplet_t (0, 1, 3. * p (x) * p (x)));
+      }
+    hessian.setFromTriplets (entries.begin (), entries.end ());
+  }
+};
+
+/// \brief Solver exposing the number of optimizations it started.
+struct Solver : public IpoptSolverSparseTd
+{
+  explicit Solver (const problem_t& problem)
+    : IpoptSolverSparseTd (problem)
+  {}
+
+  using IpoptSolverSparseTd::optimizations_;
+};
+
+/// min (x₀ - 2)² + (x₁ - 1)²
+/// s.t. x₀ + max (x₀ - 1, 0)³ x₁ ≤ 10
+///      0 ≤ x₀, x₁ ≤ 3
+///
+/// The structure sample points, around the starting point (0.5, 0.5),
+/// all have x₀ < 1: they miss the x₁ entries of the constraint
+/// Jacobian and Hessian. The minimum is 0 at (2, 1).
+static void
+setup (Solver::problem_t& problem)
+{
+  problem.argumentBounds ()[0] = Function::makeInterval (0., 3.);
+  problem.argumentBounds ()[1] = Function::makeInterval (0., 3.);
+
+  boost::shared_ptr<TwiceDifferentiableSparseFunction> kink (new Kink ());
+  problem.addConstraint (kink, Function::makeUpperInterval (10.));
+
+  Solver::problem_t::vector_t x (2);
+  x << .5, .5;
+  problem.startingPoint () = x;
+}
+
+BOOST_AUTO_TEST_CASE (detected_structure_extended)
+{
+  Cost cost;
+  Solver::problem_t problem (cost);
+  setup (problem);
+
+  Solver solver (problem);
+  solver.solve ();
+
+  BOOST_REQUIRE (solver.minimum ().which () == Solver::SOLVER_VALUE);
+  const Result& result = boost::get<Result> (solver.minimum ());
+  BOOST_CHECK_SMALL (result.value[0], 1e-6);
+  BOOST_CHECK_CLOSE (result.x[0], 2., 1e-3);
+  BOOST_CHECK_CLOSE (result.x[1], 1., 1e-3);
+
+  // The solve was started again with the missing nonzeros.
+  BOOST_CHECK_GT (solver.optimizations_, 1u);
+
+  // Later solves keep the extended structure.
+  std::size_t optimizations = solver.optimizations_;
+  solver.solve ();
+  BOOST_REQUIRE (solver.minimum ().which () == Solver::SOLVER_VALUE);
+  BOOST_CHECK_EQUAL (solver.optimizations_, optimizations + 1);
+}
+
+BOOST_AUTO_TEST_CASE (declared_structure_error)
+{
+  Cost cost;
+  Solver::problem_t problem (cost);
+  setup (problem);
+
+  // Same patterns as the detected ones.
+  Solver::sparsityPattern_t jacobian (1, 2);
+  jacobian.insert (0, 0) = 1.;
+  Solver::sparsityPattern_t hessian (2, 2);
+  hessian.insert (0, 0) = 1.;
+  hessian.insert (1, 1) = 1.;
+
+  Solver solver (problem);
+  solver.setJacobianSparsityPattern (jacobian);
+  solver.setHessianSparsityPattern (hessian);
+  solver.solve ();
+
+  // Declared patterns are never extended.
+  BOOST_CHECK (solver.minimum ().which () == Solver::SOLVER_ERROR);
+  BOOST_CHECK_EQUAL (solver.optimizations_, 1u);
+}
@@ -0,0 +1,254 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-warm-start-store
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "schittkowski-71.hh"
+#include "warm-start-store.hh"
+
+using namespace roboptim;
+using detail::WarmStartStore;
+
+namespace
+{
+  const WarmStartStore::fingerprint_t fingerprint = 0x5678abcdu;
+  const WarmStartStore::fingerprint_t parameters = 42;
+
+  /// \brief Store file and its lock file, removed at the beginning
+  /// and end of each case.
+  struct StoreFile
+  {
+    explicit StoreFile (WarmStartStore::fingerprint_t f)
+      : path (WarmStartStore::path (".", f))
+    {
+      std::remove (path.c_str ());
+      std::remove (WarmStartStore::lockPath (path).c_str ());
+    }
+
+    ~StoreFile ()
+    {
+      std::remove (path.c_str ());
+      std::remove (WarmStartStore::lockPath (path).c_str ());
+    }
+
+    std::string path;
+  };
+
+  /// \brief Iterate of a 2-variable, 1-constraint problem whose values
+  /// all equal a tag, with a 2-element signature.
+  WarmStartStore::Entry
+  makeEntry (double s0, double s1, double tag)
+  {
+    WarmStartStore::Entry entry;
+    entry.signature.resize (2);
+    entry.signature << s0, s1;
+    entry.x = Eigen::VectorXd::Constant (2, tag);
+    entry.lambda = Eigen::VectorXd::Constant (1, tag);
+    entry.zL = Eigen::VectorXd::Constant (2, tag);
+    entry.zU = Eigen::VectorXd::Constant (2, tag);
+    return entry;
+  }
+
+  /// \brief Empty iterate with the sizes of makeEntry.
+  WarmStartStore::Entry
+  makeQuery (double s0, double s1)
+  {
+    WarmStartStore::Entry entry;
+    entry.signature.resize (2);
+    entry.signature << s0, s1;
+    entry.x.resize (2);
+    entry.lambda.resize (1);
+    return entry;
+  }
+
+  /// \brief Solver exposing the fingerprint of its store file.
+  struct Solver : public IpoptSolver
+  {
+    explicit Solver (const problem_t& problem)
+      : IpoptSolver (problem)
+    {}
+
+    using IpoptSolver::problemFingerprint;
+  };
+
+  /// \brief Record the iterates of a solve.
+  struct Recorder
+  {
+    explicit Recorder (std::vector<IpoptSolver::vector_t>& iterates)
+      : iterates_ (iterates)
+    {}
+
+    void operator () (const IpoptSolver::problem_t&,
+		      IpoptSolver::solverState_t& state)
+    {
+      iterates_.push_back (state.x ());
+    }
+
+    std::vector<IpoptSolver::vector_t>& iterates_;
+  };
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (closest_signature)
+{
+  StoreFile file (fingerprint);
+
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint, parameters,
+				       makeEntry (0., 0., 1.)));
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint, parameters,
+				       makeEntry (1., 0., 2.)));
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint, parameters,
+				       makeEntry (0., 5., 3.)));
+
+  WarmStartStore::Entry entry = makeQuery (0.9, 0.2);
+  BOOST_REQUIRE (WarmStartStore::lookup (file.path, fingerprint, parameters,
+					 entry));
+  BOOST_CHECK_EQUAL (entry.x, Eigen::VectorXd::Constant (2, 2.));
+  BOOST_CHECK_EQUAL (entry.lambda, Eigen::VectorXd::Constant (1, 2.));
+  BOOST_CHECK_EQUAL (entry.zL, Eigen::VectorXd::Constant (2, 2.));
+  BOOST_CHECK_EQUAL (entry.zU, Eigen::VectorXd::Constant (2, 2.));
+
+  entry = makeQuery (0., 4.);
+  BOOST_REQUIRE (WarmStartStore::lookup (file.path, fingerprint, parameters,
+					 entry));
+  BOOST_CHECK_EQUAL (entry.x, Eigen::VectorXd::Constant (2, 3.));
+
+  // Saving the same signature again replaces its iterate.
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint, parameters,
+				       makeEntry (0., 5., 4.)));
+  entry = makeQuery (0., 5.);
+  BOOST_REQUIRE (WarmStartStore::lookup (file.path, fingerprint, parameters,
+					 entry));
+  BOOST_CHECK_EQUAL (entry.x, Eigen::VectorXd::Constant (2, 4.));
+}
+
+BOOST_AUTO_TEST_CASE (mismatches)
+{
+  StoreFile file (fingerprint);
+
+  WarmStartStore::Entry entry = makeQuery (0., 0.);
+  BOOST_CHECK (!WarmStartStore::lookup (file.path, fingerprint, parameters,
+					entry));
+
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint, parameters,
+				       makeEntry (0., 0., 1.)));
+
+  // Other solver parameters.
+  BOOST_CHECK (!WarmStartStore::lookup (file.path, fingerprint,
+					parameters + 1, entry));
+
+  // Other problem.
+  BOOST_CHECK (!WarmStartStore::lookup (file.path, fingerprint + 1,
+					parameters, entry));
+
+  // Other problem sizes.
+  entry.x.resize (3);
+  BOOST_CHECK (!WarmStartStore::lookup (file.path, fingerprint, parameters,
+					entry));
+}
+
+BOOST_AUTO_TEST_CASE (invalid_store_replaced)
+{
+  StoreFile file (fingerprint);
+
+  // A store of another problem is replaced under the lock file, which
+  // is kept.
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint + 1,
+				       parameters, makeEntry (0., 0., 1.)));
+  std::ifstream lock (WarmStartStore::lockPath (file.path).c_str ());
+  BOOST_CHECK (lock);
+
+  BOOST_REQUIRE (WarmStartStore::save (file.path, fingerprint, parameters,
+				       makeEntry (0., 0., 2.)));
+  WarmStartStore::Entry entry = makeQuery (0., 0.);
+  BOOST_REQUIRE (WarmStartStore::lookup (file.path, fingerprint, parameters,
+					 entry));
+  BOOST_CHECK_EQUAL (entry.x, Eigen::VectorXd::Constant (2, 2.));
+  BOOST_CHECK (!WarmStartStore::lookup (file.path, fingerprint + 1,
+					parameters, entry));
+}
+
+BOOST_AUTO_TEST_CASE (oldest_replaced)
+{
+  StoreFile file (fingerprint);
+
+  // Fill the store, then add one more iterate: the first one is
+  // replaced, so the closest to its signature is now the second one.
+  const int slots = 16;
+  for (int i = 0; i <= slots; ++i)
+    BOOST_REQUIRE (WarmStartStore::save
+		   (file.path, fingerprint, parameters,
+		    makeEntry (static_cast<double> (i), 0.,
+			       static_cast<double> (i))));
+
+  WarmStartStore::Entry entry = makeQuery (0., 0.);
+  BOOST_REQUIRE (WarmStartStore::lookup (file.path, fingerprint, parameters,
+					 entry));
+  BOOST_CHECK_EQUAL (entry.x, Eigen::VectorXd::Constant (2, 1.));
+
+  entry = makeQuery (static_cast<double> (slots), 0.);
+  BOOST_REQUIRE (WarmStartStore::lookup (file.path, fingerprint, parameters,
+					 entry));
+  BOOST_CHECK_EQUAL (entry.x,
+		     Eigen::VectorXd::Constant (2, static_cast<double> (slots)));
+}
+
+BOOST_AUTO_TEST_CASE (solver_store)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  std::vector<IpoptSolver::vector_t> cold;
+  Solver first (problem);
+  StoreFile file (first.problemFingerprint ());
+  first.parameters ()["ipopt.plugin.warm_start_store"].value =
+    std::string (".");
+  first.setIterationCallback (Recorder (cold));
+  first.solve ();
+
+  BOOST_REQUIRE (first.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  const Result& result = boost::get<Result> (first.minimum ());
+  BOOST_CHECK_CLOSE (result.value[0], schittkowski71::minimum, 1e-4);
+  BOOST_CHECK (!first.startingIterate ());
+
+  // A new solver of the same problem starts from the stored iterate.
+  std::vector<IpoptSolver::vector_t> warm;
+  Solver second (problem);
+  second.parameters ()["ipopt.plugin.warm_start_store"].value =
+    std::string (".");
+  second.setIterationCallback (Recorder (warm));
+  second.solve ();
+
+  BOOST_REQUIRE (second.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (second.minimum ()).value[0],
+		     schittkowski71::minimum, 1e-4);
+
+  BOOST_REQUIRE (!warm.empty ());
+  BOOST_CHECK_LT (warm.size (), cold.size ());
+  BOOST_CHECK_SMALL ((warm.front () - result.x).lpNorm<Eigen::Infinity> (),
+		     1e-4);
+}
@@ -0,0 +1,180 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE ipopt-warm-start
+
+#include <string>
+
+#include <boost/optional.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/variant/get.hpp>
+
+#include <coin/IpIpoptApplication.hpp>
+
+#include <roboptim/core/plugin/ipopt/ipopt.hh>
+
+#include "schittkowski-71.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// \brief Warm start options of Ipopt.
+  struct WarmStartOptions
+  {
+    explicit WarmStartOptions (IpoptSolver& solver)
+    {
+      Ipopt::SmartPtr<Ipopt::OptionsList> options =
+	solver.getIpoptApplication ()->Options ();
+      options->GetStringValue ("warm_start_init_point", initPoint, "");
+      options->GetNumericValue ("warm_start_bound_push", boundPush, "");
+      options->GetNumericValue ("warm_start_mult_bound_push",
+				multBoundPush, "");
+    }
+
+    std::string initPoint;
+    double boundPush;
+    double multBoundPush;
+  };
+
+  /// \brief Record, at each iteration, the number of iterations, the
+  /// starting iterate and the warm start options of a solve.
+  struct Recorder
+  {
+    Recorder (IpoptSolver& solver, std::size_t& iterations,
+	      boost::optional<IpoptIterate>& start,
+	      boost::optional<WarmStartOptions>& options)
+      : solver_ (solver),
+	iterations_ (iterations),
+	start_ (start),
+	options_ (options)
+    {}
+
+    void operator () (const IpoptSolver::problem_t&,
+		      IpoptSolver::solverState_t&)
+    {
+      ++iterations_;
+      start_ = solver_.startingIterate ();
+      options_ = WarmStartOptions (solver_);
+    }
+
+    IpoptSolver& solver_;
+    std::size_t& iterations_;
+    boost::optional<IpoptIterate>& start_;
+    boost::optional<WarmStartOptions>& options_;
+  };
+
+  const Result&
+  checkMinimum (const IpoptSolver& solver)
+  {
+    BOOST_REQUIRE (solver.minimum ().which () == IpoptSolver::SOLVER_VALUE);
+    const Result& result = boost::get<Result> (solver.minimum ());
+    BOOST_CHECK_CLOSE (result.value[0], schittkowski71::minimum, 1e-4);
+    return result;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (warm_start_options)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  WarmStartOptions defaults (solver);
+  BOOST_CHECK_EQUAL (defaults.initPoint, "no");
+
+  // Cold solve: options are left untouched.
+  std::size_t coldIterations = 0;
+  boost::optional<IpoptIterate> start;
+  boost::optional<WarmStartOptions> options;
+  solver.setIterationCallback
+    (Recorder (solver, coldIterations, start, options));
+  solver.solve ();
+  Result cold = checkMinimum (solver);
+
+  BOOST_REQUIRE (options);
+  BOOST_CHECK (!start);
+  BOOST_CHECK_EQUAL (options->initPoint, "no");
+  BOOST_CHECK_EQUAL (options->boundPush, defaults.boundPush);
+
+  // Warm solve from the previous result: options are overridden during
+  // the solve only. The barrier parameter has to start low for the
+  // warm start to pay off.
+  solver.parameters ()["ipopt.mu_init"].value = 1e-6;
+  std::size_t warmIterations = 0;
+  options.reset ();
+  solver.setIterationCallback
+    (Recorder (solver, warmIterations, start, options));
+  solver.setWarmStart (cold);
+  solver.solve ();
+  checkMinimum (solver);
+
+  BOOST_REQUIRE (options);
+  BOOST_REQUIRE (start);
+  BOOST_CHECK_EQUAL (start->x, cold.x);
+  BOOST_CHECK_EQUAL (start->lambda, cold.lambda);
+  BOOST_CHECK_EQUAL (start->zL.size (), cold.x.size ());
+  BOOST_CHECK_EQUAL (options->initPoint, "yes");
+  BOOST_CHECK_EQUAL (options->boundPush, 1e-9);
+  BOOST_CHECK_EQUAL (options->multBoundPush, 1e-9);
+  BOOST_CHECK_LT (warmIterations, coldIterations);
+
+  WarmStartOptions restored (solver);
+  BOOST_CHECK_EQUAL (restored.initPoint, defaults.initPoint);
+  BOOST_CHECK_EQUAL (restored.boundPush, defaults.boundPush);
+  BOOST_CHECK_EQUAL (restored.multBoundPush, defaults.multBoundPush);
+
+  // Back to cold starts.
+  solver.resetWarmStart ();
+  options.reset ();
+  solver.solve ();
+  checkMinimum (solver);
+  BOOST_REQUIRE (options);
+  BOOST_CHECK_EQUAL (options->initPoint, "no");
+}
+
+BOOST_AUTO_TEST_CASE (explicit_warm_start_options)
+{
+  schittkowski71::F f;
+  IpoptSolver::problem_t problem (f);
+  schittkowski71::setup (problem);
+
+  IpoptSolver solver (problem);
+  solver.solve ();
+  Result cold = checkMinimum (solver);
+
+  // Options set by the user are kept, during and after the solve.
+  solver.parameters ()["ipopt.warm_start_bound_push"].value = 1e-5;
+
+  std::size_t iterations = 0;
+  boost::optional<IpoptIterate> start;
+  boost::optional<WarmStartOptions> options;
+  solver.setIterationCallback (Recorder (solver, iterations, start, options));
+  solver.setWarmStart (cold);
+  solver.solve ();
+  checkMinimum (solver);
+
+  BOOST_REQUIRE (options);
+  BOOST_CHECK_EQUAL (options->initPoint, "yes");
+  BOOST_CHECK_EQUAL (options->boundPush, 1e-5);
+  BOOST_CHECK_EQUAL (options->multBoundPush, 1e-9);
+
+  WarmStartOptions after (solver);
+  BOOST_CHECK_EQUAL (after.initPoint, "no");
+  BOOST_CHECK_EQUAL (after.boundPush, 1e-5);
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2026 by the RobOptim developers.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_IPOPT_TESTS_SCHITTKOWSKI_71_HH
+# define ROBOPTIM_CORE_IPOPT_TESTS_SCHITTKOWSKI_71_HH
+
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/core/differentiable-function.hh>
+
+namespace roboptim
+{
+  /// \brief Problem 71 of the Schittkowski test suite.
+  ///
+  /// min x₀ x₃ (x₀ + x₁ + x₂) + x₂
+  /// s.t. x₀ x₁ x₂ x₃ ≥ 25
+  ///      x₀² + x₁² + x₂² + x₃² = 40
+  ///      1 ≤ xᵢ ≤ 5
+  ///
+  /// The minimum is 17.0140173 from the starting point (1, 5, 5, 1).
+  namespace schittkowski71
+  {
+    struct F : public DifferentiableFunction
+    {
+      F ()
+	: DifferentiableFunction (4, 1, "x₀ x₃ (x₀ + x₁ + x₂) + x₂")
+      {}
+
+      void
+      impl_compute (result_ref result, const_argument_ref x) const
+      {
+	result[0] = x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+      }
+
+      void
+      impl_gradient (gradient_ref gradient, const_argument_ref x,
+		     size_type) const
+      {
+	gradient[0] = x[0] * x[3] + x[3] * (x[0] + x[1] + x[2]);
+	gradient[1] = x[0] * x[3];
+	gradient[2] = x[0] * x[3] + 1.;
+	gradient[3] = x[0] * (x[0] + x[1] + x[2]);
+      }
+    };
+
+    struct G0 : public DifferentiableFunction
+    {
+      G0 ()
+	: DifferentiableFunction (4, 1, "x₀ x₁ x₂ x₃")
+      {}
+
+      void
+      impl_compute (result_ref result, const_argument_ref x) const
+      {
+	result[0] = x[0] * x[1] * x[2] * x[3];
+      }
+
+      void
+      impl_gradient (gradient_ref gradient, const_argument_ref x,
+		     size_type) const
+      {
+	gradient[0] = x[1] * x[2] * x[3];
+	gradient[1] = x[0] * x[2] * x[3];
+	gradient[2] = x[0] * x[1] * x[3];
+	gradient[3] = x[0] * x[1] * x[2];
+      }
+
+      // The default Jacobian goes through gradient temporaries.
+      void
+      impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+      {
+	jacobian.row (0) <<
+	  x[1] * x[2] * x[3], x[0] * x[2] * x[3],
+	  x[0] * x[1] * x[3], x[0] * x[1] * x[2];
+      }
+    };
+
+    struct G1 : public DifferentiableFunction
+    {
+      G1 ()
+	: DifferentiableFunction (4, 1, "x₀² + x₁² + x₂² + x₃²")
+      {}
+
+      void
+      impl_compute (result_ref result, const_argument_ref x) const
+      {
+	result[0] = x.squaredNorm ();
+      }
+
+      void
+      impl_gradient (gradient_ref gradient, const_argument_ref x,
+		     size_type) const
+      {
+	gradient = 2. * x;
+      }
+
+      void
+      impl_jacobian (jacobian_ref jacobian, const_argument_ref x) const
+      {
+	jacobian.row (0) = 2. * x.transpose ();
+      }
+    };
+
+    /// \brief Fill a problem built on F with the bounds, constraints
+    /// and starting point of problem 71.
+    template <typename P>
+    void setup (P& problem)
+    {
+      for (typename P::size_type i = 0; i < 4; ++i)
+	problem.argumentBounds ()[static_cast<std::size_t> (i)] =
+	  Function::makeInterval (1., 5.);
+
+      boost::shared_ptr<DifferentiableFunction> g0 (new G0 ());
+      boost::shared_ptr<DifferentiableFunction> g1 (new G1 ());
+      problem.addConstraint (g0, Function::makeLowerInterval (25.));
+      problem.addConstraint (g1, Function::makeInterval (40., 40.));
+
+      typename P::vector_t x (4);
+      x << 1., 5., 5., 1.;
+      problem.startingPoint () = x;
+    }
+
+    /// \brief Optimal cost.
+    const double minimum = 17.0140173;
+  } // end of namespace schittkowski71.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CORE_IPOPT_TESTS_SCHITTKOWSKI_71_HH